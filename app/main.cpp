@@ -9,11 +9,123 @@ Revision History:
 --*/
 
 #include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstring>
 
 #include "../source/TextClassifierFactory.h"
+#include "../source/HyperparameterSearch.h"
+#include "../source/ThreadPool.h"
 
 using namespace std;
 
+#define STRESS_DEFAULT_ROUNDS	20	/**< Passes over the features file per thread in stress mode. */
+
+/**
+ * @brief Score a features file from several threads sharing one model.
+ *
+ * Each thread goes over the whole file, starting at a different batch, with
+ * predictBatch and predict. Every result must match the one computed on a
+ * single thread beforehand, bit for bit.
+ *
+ * @param model Loaded model, shared by all threads.
+ * @param features_path Features file, one text per line.
+ * @param num_threads Number of scoring threads.
+ * @param rounds Passes over the file per thread.
+ * @return Number of predictions that differ from the single threaded ones.
+ */
+static size_t stressTest(const BaseClassifier& model, const string& features_path, int num_threads, int rounds)
+{
+	LineReader in(features_path);
+	if (!in)
+	{
+		cerr << "ERROR: Cannot open features file.\n";
+		return 1;
+	}
+	vector<string> lines = in.readAll();
+	vector<string_view> views(lines.begin(), lines.end());
+	size_t n = lines.size();
+	size_t num_batches = (n + PREDICT_BATCH_SIZE - 1) / PREDICT_BATCH_SIZE;
+	if (n == 0)
+	{
+		cerr << "ERROR: Features file is empty.\n";
+		return 1;
+	}
+
+	// Reference results of both entry points, computed on this thread alone.
+	vector<Prediction> batch_ref(n);
+	vector<Prediction> single_ref(n);
+	for (size_t b = 0; b < num_batches; ++b)
+	{
+		size_t start = b * PREDICT_BATCH_SIZE;
+		size_t count = min<size_t>(PREDICT_BATCH_SIZE, n - start);
+		model.predictBatch(span<const string_view>(views.data() + start, count), span<Prediction>(batch_ref.data() + start, count), false);
+	}
+	for (size_t i = 0; i < n; ++i)
+	{
+		single_ref[i] = model.predict(lines[i], false);
+	}
+
+	atomic<size_t> mismatches(0);
+	auto same = [](const Prediction& a, const Prediction& b)
+	{
+		return a.label == b.label && memcmp(&a.probability, &b.probability, sizeof(double)) == 0;
+	};
+	auto worker = [&](int t)
+	{
+		vector<Prediction> results(PREDICT_BATCH_SIZE);
+		size_t wrong = 0;
+		for (int r = 0; r < rounds; ++r)
+		{
+			for (size_t k = 0; k < num_batches; ++k)
+			{
+				size_t b = (k + t) % num_batches;
+				size_t start = b * PREDICT_BATCH_SIZE;
+				size_t count = min<size_t>(PREDICT_BATCH_SIZE, n - start);
+				model.predictBatch(span<const string_view>(views.data() + start, count), results, false);
+				for (size_t i = 0; i < count; ++i)
+				{
+					wrong += !same(results[i], batch_ref[start + i]);
+				}
+				// One sentence per batch also goes through the single sentence path.
+				size_t i = start + (r + t) % count;
+				wrong += !same(model.predict(lines[i], false), single_ref[i]);
+			}
+		}
+		mismatches += wrong;
+	};
+
+	auto begin = chrono::steady_clock::now();
+	vector<thread> threads;
+	for (int t = 0; t < num_threads; ++t)
+	{
+		threads.emplace_back(worker, t);
+	}
+	for (auto& th : threads)
+	{
+		th.join();
+	}
+	chrono::duration<double> seconds = chrono::steady_clock::now() - begin;
+
+	double texts = static_cast<double>(num_threads) * rounds * (n + num_batches);
+	cout << num_threads << " threads scored " << texts << " texts in " << seconds.count() << " s ("
+		 << texts / seconds.count() << " texts/s), " << mismatches << " mismatches" << endl;
+	return mismatches;
+}
+
+/**
+ * @brief Stream buffer that drops everything written to it.
+ *
+ * Keeps no state, so any number of threads may write to it at once.
+ */
+class NullBuffer : public streambuf
+{
+protected:
+	int overflow(int c) override { return c; }
+};
+
 int main(int argc, char **argv)
 {
 	int vectorizer_id, classifier_id;
@@ -21,14 +133,45 @@ int main(int argc, char **argv)
 	TextClassifierFactory clsfrFactoryObj;
 	TextClassifierFactory::Product pclsfr;
 
+	// --threads=N and --pin-threads may appear anywhere, they size the shared thread pool.
+	unsigned int num_threads = 0;
+	bool pin_threads = false;
+	bool configure_threads = false;
+	int kept = 1;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strncmp(argv[i], "--threads=", 10) == 0) {
+			num_threads = static_cast<unsigned int>(atoi(argv[i] + 10));
+			configure_threads = true;
+		} else if (strcmp(argv[i], "--pin-threads") == 0) {
+			pin_threads = true;
+			configure_threads = true;
+		} else {
+			argv[kept++] = argv[i];
+		}
+	}
+	argc = kept;
+	if (configure_threads) {
+		ThreadPool::configureShared(num_threads, pin_threads);
+	}
+
 	if (argc < 6)
 	{
 		cout << "Usage: " << endl
 			 << "  " << argv[0] << " f (vectorizer id) (classifier id) my_model.bin features.txt labels.txt (model version string) \"hyperparam1=val1,hyperparam2=val2,...\"" << endl
-			 << "  " << argv[0] << " p (vectorizer id) (classifier id) my_model.bin features.txt labels_pred.txt" << endl
+			 << "  " << argv[0] << " u (vectorizer id) (classifier id) my_model.bin new_features.txt new_labels.txt [\"hyperparam1=val1,...\"]" << endl
+			 << "  " << argv[0] << " p (vectorizer id) (classifier id) my_model.bin features.txt labels_pred.txt [cache size]" << endl
 		     << "  " << argv[0] << " 1 (vectorizer id) (classifier id) my_model.bin \"This is string to classify\" " << endl
+			 << "  " << argv[0] << " c (vectorizer id) (classifier id) my_model.bin pruned_model.bin (weight threshold) [top k features]" << endl
+			 << "  " << argv[0] << " s (vectorizer id) (classifier id) my_model.bin features.txt (threads) [rounds]" << endl
+			 << "  " << argv[0] << " evaluate (vectorizer id) (classifier id) my_model.bin test_features.txt test_labels.txt" << endl
+			 << "  " << argv[0] << " evaluate (vectorizer id) (classifier id) features.txt labels.txt (folds) \"hyperparam1=val1,...\"" << endl
+			 << "  " << argv[0] << " vectorize (vectorizer id) (classifier id) corpus.bin features.txt labels.txt [\"hyperparam1=val1,...\"]" << endl
+			 << "  " << argv[0] << " search (vectorizer id) (classifier id) features.txt labels.txt (folds) \"shared hyperparams\" \"candidate grid\" [\"candidate grid\" ...]" << endl
+			 << "\nf accepts a corpus.bin written by vectorize in place of features.txt, labels.txt is then ignored." << endl
+			 << "\nEvery mode accepts --threads=N (threads of the shared pool, 0 for one per core) and --pin-threads (pin them to CPUs)." << endl
 			 << "\nwhere vectorizer id = " << endl
-			 << "  1 CounterVectorizer\n  2 TfidfVectorizer" << endl
+			 << "  1 CounterVectorizer\n  2 TfidfVectorizer\n  3 HashingVectorizer" << endl
 		     << "\nwhere classifier id = " << endl
 			 << "  1 NaiveBayesClassifier\n  2 LogisticRegressionClassifier\n  3 SVCClassifier\n  4 KNNClassifier\n  5 RandomForestClassifier\n  6 GradientBoostingClassifier" << endl;
 		return 1;
@@ -44,8 +187,76 @@ int main(int argc, char **argv)
 		return 1;
 	}
 	
+	// txtclsfr search 2 2 features.txt labels.txt 5 "ngram_max=2" "epochs=5|15,learning_rate=0.01|0.1"
+	if(strcmp(argv[1], "search") == 0) {
+		if (argc < 9) {
+			cerr << "ERROR: search needs a number of folds, shared hyperparameters and at least one candidate." << endl;
+			return 1;
+		}
+		HyperparameterSearch search(vectorizer_id, classifier_id);
+		if (!search.fitCorpus(argv[4], argv[5], argv[7])) {
+			return 1;
+		}
+		vector<string> candidates;
+		for (int i = 8; i < argc; ++i) {
+			vector<string> grid = HyperparameterSearch::expandGrid(argv[i]);
+			candidates.insert(candidates.end(), grid.begin(), grid.end());
+		}
+		int folds = atoi(argv[6]) > 0 ? atoi(argv[6]) : SEARCH_DEFAULT_FOLDS;
+		cout << "Searching " << candidates.size() << " candidates with " << folds << "-fold cross-validation on " << search.size() << " sentences" << endl;
+		// The runs train at the same time, their progress output would only interleave.
+		NullBuffer null_buffer;
+		streambuf* console = cout.rdbuf(&null_buffer);
+		vector<SearchResult> results = search.run(candidates, folds);
+		cout.rdbuf(console);
+		HyperparameterSearch::printLeaderboard(results, cout);
+
+	// txtclsfr evaluate 2 2 my_model.bin test_features.txt test_labels.txt
+	// txtclsfr evaluate 2 2 features.txt labels.txt 5 "ngram_max=2,epochs=15"
+	} else if(strcmp(argv[1], "evaluate") == 0 && argc >= 7) {
+		if (argc == 7) {
+			pclsfr->load(argv[4]);
+			if (!pclsfr->isLoaded()) {
+				return 1;
+			}
+			cout << "Model Loaded" << endl;
+			Evaluation evaluation = pclsfr->evaluate(argv[5], argv[6], false);
+			if (evaluation.count() == 0) {
+				return 1;
+			}
+			evaluation.print(cout, pclsfr->pVec->getClassLabels());
+		} else {
+			HyperparameterSearch search(vectorizer_id, classifier_id);
+			if (!search.fitCorpus(argv[4], argv[5], argv[7])) {
+				return 1;
+			}
+			int folds = atoi(argv[6]) > 0 ? atoi(argv[6]) : SEARCH_DEFAULT_FOLDS;
+			NullBuffer null_buffer;
+			streambuf* console = cout.rdbuf(&null_buffer);
+			Evaluation evaluation = search.crossValidate("", folds);
+			cout.rdbuf(console);
+			if (evaluation.count() == 0) {
+				return 1;
+			}
+			cout << folds << "-fold cross-validation" << endl;
+			evaluation.print(cout, search.getClassLabels());
+		}
+
+	// txtclsfr vectorize 2 2 corpus.bin features.txt labels.txt "ngram_max=2"
+	} else if(strcmp(argv[1], "vectorize") == 0 && argc >= 7) {
+		cout << "Vectorizing\n";
+		if (argc >= 8) {
+			pclsfr->setHyperparameters(string(argv[7]));
+		}
+		pclsfr->pVec->fit(argv[5], argv[6]);
+		if (pclsfr->pVec->getSentenceCount() == 0 || !pclsfr->pVec->saveCorpus(argv[4])) {
+			return 1;
+		}
+		pclsfr->shape();
+		cout << "Corpus Saved" << endl;
+
 	// txtclsfr f 2 my_model.bin features.txt labels.txt
-	if(argv[1][0] == 'f') {
+	} else if(argv[1][0] == 'f') {
 		cout << "Training\n";
 		pclsfr->setVersionInfo(argv[7]);
 		if (argc == 9) {
@@ -56,12 +267,29 @@ int main(int argc, char **argv)
 		pclsfr->save(argv[4]);
 		cout << "Model Saved" << endl;
 
+	// txtclsfr u 2 my_model.bin new_features.txt new_labels.txt
+	} else if(argv[1][0] == 'u') {
+		cout << "Updating\n";
+		pclsfr->setHyperparameters(argc == 8 ? string(argv[7]) : string());
+		pclsfr->load(argv[4]);
+		cout << "Model Loaded" << endl;
+		pclsfr->partial_fit(argv[5], argv[6]);
+		pclsfr->shape();
+		pclsfr->save(argv[4]);
+		cout << "Model Saved" << endl;
+
 	// txtclsfr p 2 my_model.bin features.txt labels_pred.txt
 	} else if(argv[1][0] == 'p') {
 		cout << "Predicting\n";
 		pclsfr->load(argv[4]);
 		cout << "Model Loaded" << endl;
+		if (argc >= 8) {
+			pclsfr->enableCache(atol(argv[7]));
+		}
 		pclsfr->predict(argv[5], argv[6], false);
+		if (pclsfr->getCache() != nullptr) {
+			cout << "Cache hits = " << pclsfr->getCache()->hits() << ", misses = " << pclsfr->getCache()->misses() << endl;
+		}
 
 	// txtclsfr 1 2 my_model.bin "This is string to classify" 
 	} else if(argv[1][0] == '1') {
@@ -69,7 +297,34 @@ int main(int argc, char **argv)
 		pclsfr->load(argv[4]);
 		cout << "Model Loaded" << endl;
 		result = pclsfr->predict(argv[5], false);
-		cout << result.label << "    " << result.probability << endl;
+		cout << pclsfr->labelName(result.label) << "    " << result.probability << endl;
+
+	// txtclsfr c 2 my_model.bin pruned_model.bin 0.001 5000
+	} else if(argv[1][0] == 'c' && argc >= 7) {
+		cout << "Pruning\n";
+		pclsfr->load(argv[4]);
+		if (!pclsfr->isLoaded()) {
+			return 1;
+		}
+		cout << "Model Loaded" << endl;
+		pclsfr->shape();
+		pclsfr->prune(atof(argv[6]), argc >= 8 ? atoi(argv[7]) : 0);
+		pclsfr->shape();
+		pclsfr->save(argv[5]);
+		cout << "Model Saved" << endl;
+
+	// txtclsfr s 2 my_model.bin features.txt 8
+	} else if(argv[1][0] == 's' && argc >= 7) {
+		pclsfr->load(argv[4]);
+		if (!pclsfr->isLoaded()) {
+			return 1;
+		}
+		cout << "Model Loaded" << endl;
+		int rounds = argc >= 8 ? atoi(argv[7]) : STRESS_DEFAULT_ROUNDS;
+		if (stressTest(*pclsfr, argv[5], max(atoi(argv[6]), 1), max(rounds, 1)) != 0) {
+			cerr << "Stress test failed!" << endl;
+			return 1;
+		}
 	}
 
 	cout << "Done\n";
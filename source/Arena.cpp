@@ -0,0 +1,107 @@
+/**
+ * @file Arena.cpp
+ * @brief Implementation of the Arena class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "Arena.h"
+
+#include <cstdint>
+#include <new>
+
+Arena::Arena(size_t initial_block_size)
+{
+    head = nullptr;
+    cursor = nullptr;
+    limit = nullptr;
+    next_block_size = initial_block_size;
+    used_bytes = 0;
+    capacity_bytes = 0;
+    block_allocations = 0;
+}
+
+Arena::~Arena()
+{
+    releaseBlocks();
+}
+
+void Arena::releaseBlocks()
+{
+    while (head)
+    {
+        Block* next = head->next;
+        ::operator delete(head);
+        head = next;
+    }
+    cursor = nullptr;
+    limit = nullptr;
+    capacity_bytes = 0;
+}
+
+void Arena::grow(size_t min_size)
+{
+    size_t size = next_block_size;
+    while (size < min_size)
+    {
+        size *= 2;
+    }
+
+    Block* block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+    block->next = head;
+    block->size = size;
+    head = block;
+    cursor = reinterpret_cast<char*>(block + 1);
+    limit = cursor + size;
+    capacity_bytes += size;
+    next_block_size = size * 2;
+    block_allocations++;
+}
+
+void Arena::reset()
+{
+    // Several blocks mean the last request did not fit, merge them so it will.
+    if (head && head->next)
+    {
+        size_t total = capacity_bytes;
+        releaseBlocks();
+        next_block_size = total;
+        grow(total);
+    }
+    if (head)
+    {
+        cursor = reinterpret_cast<char*>(head + 1);
+    }
+    used_bytes = 0;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment)
+{
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (!head || aligned + bytes > reinterpret_cast<uintptr_t>(limit))
+    {
+        grow(bytes + alignment);
+        aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+
+    char* p = reinterpret_cast<char*>(aligned);
+    used_bytes += (p + bytes) - cursor;
+    cursor = p + bytes;
+    return p;
+}
+
+void Arena::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+    // Memory is only given back by reset().
+}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file Arena.h
+ * @brief Monotonic memory resource for short-lived scratch allocations.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef ARENA_H__
+#define ARENA_H__
+
+#include <cstddef>
+#include <memory_resource>
+
+#define ARENA_DEFAULT_BLOCK_SIZE    (64 * 1024)
+
+/**
+ * @class Arena
+ * @brief Bump allocator usable by every std::pmr container.
+ *
+ * Allocation moves a cursor through the current block, deallocation does
+ * nothing and reset() makes the whole arena free again in O(1). Blocks are
+ * taken from operator new only when the arena runs out of space; reset()
+ * merges them into a single block as large as all of them together, so after
+ * the first few requests an arena that is reset between requests never
+ * allocates again.
+ *
+ * An Arena is not thread safe, use one per thread.
+ */
+class Arena : public std::pmr::memory_resource
+{
+public:
+    /**
+     * @brief Constructor, no memory is taken until the first allocation.
+     *
+     * @param initial_block_size Size in bytes of the first block.
+     */
+    explicit Arena(size_t initial_block_size = ARENA_DEFAULT_BLOCK_SIZE);
+
+    /**
+     * @brief Destructor, returns every block.
+     */
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief Release everything allocated so far.
+     *
+     * Memory handed out before the reset must not be used afterwards.
+     */
+    void reset();
+
+    /**
+     * @brief Bytes handed out since the last reset.
+     */
+    size_t used() const { return used_bytes; }
+
+    /**
+     * @brief Bytes owned by the arena.
+     */
+    size_t capacity() const { return capacity_bytes; }
+
+    /**
+     * @brief Number of blocks taken from operator new so far.
+     */
+    size_t blockAllocations() const { return block_allocations; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    /**
+     * @brief Header in front of every block.
+     */
+    struct Block
+    {
+        Block* next; /**< Previously allocated block. */
+        size_t size; /**< Usable bytes after the header. */
+    };
+
+    /**
+     * @brief Take a new block of at least min_size usable bytes.
+     *
+     * @param min_size Minimum number of usable bytes.
+     */
+    void grow(size_t min_size);
+
+    /**
+     * @brief Return every block to operator delete.
+     */
+    void releaseBlocks();
+
+    Block* head; /**< Current block, the others are chained behind it. */
+    char* cursor; /**< Next free byte of the current block. */
+    char* limit; /**< End of the current block. */
+    size_t next_block_size; /**< Usable size of the next block to allocate. */
+    size_t used_bytes; /**< Bytes handed out since the last reset. */
+    size_t capacity_bytes; /**< Usable bytes of all blocks. */
+    size_t block_allocations; /**< Number of blocks allocated. */
+};
+
+#endif // ARENA_H__
@@ -14,6 +14,12 @@ Revision History:
 
 #include "BaseClassifier.h"
 
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+
+#include "PredictionWriter.h"
+
 /**
  * @brief Constructor for BaseClassifier.
  */
@@ -44,6 +50,418 @@ void BaseClassifier::head()
     pVec->head();
 }
 
+/**
+ * @brief Classifiers that cannot be updated in place have to be fitted again.
+ */
+void BaseClassifier::partial_fit(string abs_filepath_to_features, string abs_filepath_to_labels)
+{
+    std::cerr << "ERROR: This classifier does not support partial_fit, fit it again on the full data.\n";
+}
+
+/**
+ * @brief Classifiers without a feature by class weight matrix cannot be pruned.
+ */
+void BaseClassifier::prune(double threshold, int top_k)
+{
+    std::cerr << "ERROR: This classifier does not support pruning.\n";
+}
+
+/**
+ * @brief Predict the label for a given sentence.
+ */
+Prediction BaseClassifier::predict(const string& sentence, bool preprocess) const
+{
+    const BaseVectorizer& vec = *pVec;
+    PredictContext& ctx = PredictContext::local();
+    PredictScope scope(ctx);
+    TokenList tokens(ctx.resource());
+    FeatureVector features(ctx.resource());
+
+    // Same as BaseVectorizer::tokenize, with a cache lookup between normalising and splitting.
+    char* text = static_cast<char*>(ctx.arena.allocate(sentence.size() + 1, 1));
+    std::memcpy(text, sentence.data(), sentence.size());
+    std::string_view normalized(text, vec.normalize(std::span<char>(text, sentence.size()), preprocess));
+
+    Prediction result;
+    uint64_t key = 0;
+    if (cache)
+    {
+        key = PredictionCache::key(normalized, PredictionCache::modelTag(vec.getVersionInfo()));
+        if (cache->find(key, result))
+        {
+            return result;
+        }
+    }
+
+    vec.splitTokens(normalized, tokens);
+    vec.getSentenceFeatures(tokens, ctx, features);
+    result = predictFeatures(features, ctx);
+    if (cache)
+    {
+        cache->insert(key, result);
+    }
+    return result;
+}
+
+/**
+ * @brief Predict the labels of many sentences at once.
+ */
+void BaseClassifier::predictBatch(std::span<const std::string_view> sentences, std::span<Prediction> results, bool preprocess) const
+{
+    // pVec is a shared_ptr, which does not pass our constness on.
+    const BaseVectorizer& vec = *pVec;
+    if (results.size() < sentences.size())
+    {
+        std::cerr << "ERROR: Not enough room for the predictions of the batch.\n";
+        return;
+    }
+
+    PredictContext& ctx = PredictContext::local();
+    PredictScope scope(ctx);
+    SparseBatch batch(ctx.resource());
+
+    // Copy the batch into the arena. Large batches are normalised in one pass
+    // that can be split across threads, small ones sentence by sentence right
+    // before their features are hashed, while the text is still in cache.
+    size_t bytes = 0;
+    for (const auto& sentence : sentences)
+    {
+        bytes += sentence.size();
+    }
+    char* text = static_cast<char*>(ctx.arena.allocate(bytes + 1, 1));
+    std::pmr::vector<std::span<char>> texts(ctx.resource());
+    texts.reserve(sentences.size());
+    for (const auto& sentence : sentences)
+    {
+        std::memcpy(text, sentence.data(), sentence.size());
+        texts.emplace_back(text, sentence.size());
+        text += sentence.size();
+    }
+    const bool normalized = bytes >= NORMALIZE_PARALLEL_MIN_BYTES;
+    if (normalized)
+    {
+        vec.normalizeBatch(texts, preprocess);
+    }
+
+    if (!cache)
+    {
+        for (auto& sentence : texts)
+        {
+            size_t len = normalized ? sentence.size() : vec.normalize(sentence, preprocess);
+            vec.appendSparseFeatures(std::string_view(sentence.data(), len), ctx, batch);
+        }
+        predictSparseBatch(batch, results.first(sentences.size()), ctx);
+        return;
+    }
+
+    // Answer what the cache knows and score only the rest as one batch.
+    uint64_t tag = PredictionCache::modelTag(vec.getVersionInfo());
+    std::pmr::vector<uint64_t> keys(ctx.resource());
+    std::pmr::vector<size_t> missed(ctx.resource());
+    for (size_t i = 0; i < texts.size(); ++i)
+    {
+        size_t len = normalized ? texts[i].size() : vec.normalize(texts[i], preprocess);
+        std::string_view view(texts[i].data(), len);
+        uint64_t key = PredictionCache::key(view, tag);
+        if (cache->find(key, results[i]))
+        {
+            continue;
+        }
+        keys.push_back(key);
+        missed.push_back(i);
+        vec.appendSparseFeatures(view, ctx, batch);
+    }
+    if (missed.empty())
+    {
+        return;
+    }
+
+    std::pmr::vector<Prediction> scored(missed.size(), ctx.resource());
+    predictSparseBatch(batch, scored, ctx);
+    for (size_t j = 0; j < missed.size(); ++j)
+    {
+        results[missed[j]] = scored[j];
+        cache->insert(keys[j], scored[j]);
+    }
+}
+
+/**
+ * @brief Score every row of a sparse batch through predictFeatures.
+ */
+void BaseClassifier::predictSparseBatch(const SparseBatch& batch, std::span<Prediction> results, PredictContext& ctx) const
+{
+    FeatureVector features(pVec->getFeatureCount(), 0.0, ctx.resource());
+    for (size_t r = 0; r < batch.rows(); ++r)
+    {
+        SparseRow row = batch.row(r);
+        for (size_t i = 0; i < row.nnz; ++i)
+        {
+            features[row.idx[i]] = row.val[i];
+        }
+        results[r] = predictFeatures(features, ctx);
+        for (size_t i = 0; i < row.nnz; ++i)
+        {
+            features[row.idx[i]] = 0.0;
+        }
+    }
+}
+
+/**
+ * @brief Predict labels for every line of a features file, a block of batches at a time.
+ */
+void BaseClassifier::predict(const string& abs_filepath_to_features, const string& abs_filepath_to_labels, bool preprocess) const
+{
+    LineReader in(abs_filepath_to_features);
+    PredictionWriter out(pVec->getClassLabels(), PredictionWriter::formatFromPath(abs_filepath_to_labels));
+
+    if (!in)
+    {
+        std::cerr << "ERROR: Cannot open features file.\n";
+        return;
+    }
+
+    if (!out.open(abs_filepath_to_labels))
+    {
+        std::cerr << "ERROR: Cannot open labels file.\n";
+        return;
+    }
+
+    const size_t block_size = static_cast<size_t>(PREDICT_BATCH_SIZE) * PREDICT_BLOCK_BATCHES;
+    std::vector<std::string> lines(block_size);
+    std::vector<std::string_view> views(block_size);
+    std::vector<Prediction> results(block_size);
+
+    #ifdef BENCHMARK
+    double sumduration = 0.0;
+    double sumstrlen = 0.0;
+    size_t num_rows = 0;
+    #endif
+
+    // A mapped file is scored in place, lines read from a pipe are copied
+    // because the next read may overwrite them.
+    std::string_view line;
+    for (;;)
+    {
+        size_t n = 0;
+        while (n < block_size && in.next(line))
+        {
+            views[n] = in.isMapped() ? line : std::string_view(lines[n].assign(line));
+            n++;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+
+        #ifdef BENCHMARK
+        auto start = std::chrono::high_resolution_clock::now();
+        #endif
+
+        size_t num_batches = (n + PREDICT_BATCH_SIZE - 1) / PREDICT_BATCH_SIZE;
+        ThreadPool::shared().parallelFor(num_batches, 1, [&](size_t begin, size_t end)
+        {
+            for (size_t b = begin; b < end; ++b)
+            {
+                size_t first = b * PREDICT_BATCH_SIZE;
+                size_t count = std::min<size_t>(PREDICT_BATCH_SIZE, n - first);
+                predictBatch(std::span<const std::string_view>(views.data() + first, count), std::span<Prediction>(results.data() + first, count), preprocess);
+            }
+        });
+
+        #ifdef BENCHMARK
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> duration = end - start;
+        double milliseconds = duration.count();
+        sumduration += milliseconds;
+        for (size_t i = 0; i < n; ++i)
+        {
+            sumstrlen += views[i].length();
+        }
+        num_rows += n;
+        #endif
+
+        out.write(std::span<const Prediction>(results.data(), n));
+    }
+
+    #ifdef BENCHMARK
+    double avgduration = sumduration / num_rows;
+    cout << "Average Time per Text = " << avgduration << " ms" << endl;
+    double avgstrlen = sumstrlen / num_rows;
+    cout << "Average Length of Text (chars) = " << avgstrlen << endl;
+    #endif
+
+    in.close();
+    if (!out.close())
+    {
+        std::cerr << "ERROR: Cannot write labels file.\n";
+    }
+}
+
+/**
+ * @brief Score a labelled data set block by block and count the results.
+ */
+Evaluation BaseClassifier::evaluate(const string& abs_filepath_to_features, const string& abs_filepath_to_labels, bool preprocess) const
+{
+    const LabelDictionary& class_labels = pVec->getClassLabels();
+    Evaluation evaluation(class_labels.size());
+    LineReader in(abs_filepath_to_features);
+    LineReader labels_in(abs_filepath_to_labels);
+    if (!in)
+    {
+        std::cerr << "ERROR: Cannot open features file.\n";
+        return Evaluation(class_labels.size());
+    }
+    if (!labels_in)
+    {
+        std::cerr << "ERROR: Cannot open labels file.\n";
+        return Evaluation(class_labels.size());
+    }
+
+    const size_t block_size = static_cast<size_t>(PREDICT_BATCH_SIZE) * PREDICT_BLOCK_BATCHES;
+    std::vector<std::string> lines(block_size);
+    std::vector<std::string_view> views(block_size);
+    std::vector<int> truths(block_size);
+    std::vector<Prediction> results(block_size);
+    std::string_view line;
+    std::string_view label;
+
+    for (;;)
+    {
+        size_t n = 0;
+        while (n < block_size && in.next(line))
+        {
+            if (!labels_in.next(label))
+            {
+                std::cerr << "ERROR: Feature dimension is different from label dimension\n";
+                return Evaluation(class_labels.size());
+            }
+            views[n] = in.isMapped() ? line : std::string_view(lines[n].assign(line));
+            truths[n] = class_labels.find(label);
+            n++;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+
+        size_t num_batches = (n + PREDICT_BATCH_SIZE - 1) / PREDICT_BATCH_SIZE;
+        ThreadPool::shared().parallelFor(num_batches, 1, [&](size_t begin, size_t end)
+        {
+            for (size_t b = begin; b < end; ++b)
+            {
+                size_t start = b * PREDICT_BATCH_SIZE;
+                size_t count = std::min<size_t>(PREDICT_BATCH_SIZE, n - start);
+                predictBatch(std::span<const std::string_view>(views.data() + start, count), std::span<Prediction>(results.data() + start, count), preprocess);
+            }
+        });
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            evaluation.add(truths[i], results[i].label, results[i].probability);
+        }
+    }
+
+    if (labels_in.next(label))
+    {
+        std::cerr << "ERROR: Feature dimension is different from label dimension\n";
+        return Evaluation(class_labels.size());
+    }
+    return evaluation;
+}
+
+/**
+ * @brief Highest score and its share of the exponentiated scores.
+ */
+Prediction BaseClassifier::softmax(const double* scores, int num_classes)
+{
+    Prediction result = { 0, 1.0 };
+    if (num_classes <= 0)
+    {
+        return result;
+    }
+
+    for (int c = 1; c < num_classes; ++c)
+    {
+        if (scores[c] > scores[result.label])
+        {
+            result.label = c;
+        }
+    }
+
+    double max_score = scores[result.label];
+    double sum = 0.0;
+    for (int c = 0; c < num_classes; ++c)
+    {
+        sum += std::exp(scores[c] - max_score);
+    }
+    result.probability = 1.0 / sum;
+    return result;
+}
+
+/**
+ * @brief Keep the rows whose largest |w| passes the threshold and the top_k cut.
+ */
+std::vector<int> BaseClassifier::selectFeatures(const std::vector<double>& weights, size_t rows, size_t cols, double threshold, int top_k)
+{
+    std::vector<double> magnitude(rows, 0.0);
+    std::vector<int> candidates;
+    for (size_t r = 0; r < rows; ++r)
+    {
+        for (size_t c = 0; c < cols; ++c)
+        {
+            magnitude[r] = std::max(magnitude[r], std::fabs(weights[r * cols + c]));
+        }
+        if (magnitude[r] > threshold)
+        {
+            candidates.push_back(static_cast<int>(r));
+        }
+    }
+
+    if (top_k > 0 && candidates.size() > static_cast<size_t>(top_k))
+    {
+        // Ties go to the lower index, so pruning is deterministic.
+        std::nth_element(candidates.begin(), candidates.begin() + top_k, candidates.end(), [&](int a, int b)
+        {
+            return magnitude[a] != magnitude[b] ? magnitude[a] > magnitude[b] : a < b;
+        });
+        candidates.resize(top_k);
+        std::sort(candidates.begin(), candidates.end());
+    }
+
+    std::vector<int> old_to_new(rows, -1);
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        old_to_new[candidates[i]] = static_cast<int>(i);
+    }
+    return old_to_new;
+}
+
+/**
+ * @brief Rows only move towards the front, so the copy can be done in place.
+ */
+void BaseClassifier::compactRows(std::vector<double>& weights, size_t cols, const std::vector<int>& old_to_new)
+{
+    size_t kept = 0;
+    for (size_t r = 0; r < old_to_new.size(); ++r)
+    {
+        if (old_to_new[r] >= 0)
+        {
+            std::copy_n(weights.begin() + r * cols, cols, weights.begin() + old_to_new[r] * cols);
+            kept++;
+        }
+    }
+    weights.resize(kept * cols);
+    weights.shrink_to_fit();
+}
+
+/**
+ * @brief Replace the prediction cache by an empty one, or remove it.
+ */
+void BaseClassifier::enableCache(size_t capacity)
+{
+    cache = capacity > 0 ? std::make_shared<PredictionCache>(capacity) : nullptr;
+}
+
 /**
  * @brief Set Model Version.
  */
@@ -21,12 +21,18 @@ Revision History:
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <span>
 #ifdef BENCHMARK
 #include <chrono>
 #endif
 
 #include "CountVectorizer.h"
 #include "TfidfVectorizer.h"
+#include "HashingVectorizer.h"
+#include "PredictionCache.h"
+#include "Evaluation.h"
+#include "ThreadPool.h"
 
 using namespace std;
 
@@ -37,19 +43,36 @@ using namespace std;
 #define ID_CLASSIFIER_RANDOMFORESTCLASSIFIER            5
 #define ID_CLASSIFIER_GRADIENTBOOSTINGCLASSIFIER        6
 
+#define PREDICT_BATCH_SIZE                              256     /**< Lines per batch when predicting a file. */
+#define TREE_BLOCK_ROWS                                 64      /**< Rows sent down each tree at a time. */
+#define PREDICT_BLOCK_BATCHES                           64      /**< Batches read and scored in parallel at a time by predict and evaluate. */
+#define TRAIN_PARALLEL_MIN_WEIGHTS                      (1 << 18)   /**< Weights a per-sample update must touch before it is split over threads. */
+#define TRAIN_PARALLEL_GRAIN                            4096    /**< Features per chunk of a parallel weight update. */
+
 /**
  * @struct Prediction
  * @brief Structure to store prediction results.
  */
 struct Prediction
 {
-    int label;              /**< Predicted label. */
+    int label;              /**< Class index of the predicted label, see BaseClassifier::labelName. */
     double probability;     /**< Probability of the predicted label. */
 };
 
 /**
  * @class BaseClassifier
  * @brief Abstract base class for classifiers.
+ *
+ * Inference is const and reentrant: predict, predictBatch, labelName and
+ * everything they call only read the model and the vectorizer, and keep
+ * their scratch memory in the PredictContext of the calling thread. One
+ * loaded model can therefore serve any number of threads at once, as long
+ * as no thread calls a non-const member (fit, partial_fit, load,
+ * setHyperparameters, setVersionInfo) meanwhile. Derived classes keep this
+ * contract by implementing predictFeatures and predictSparseBatch without
+ * mutable members or static state. Hold a model as
+ * std::shared_ptr<const BaseClassifier> to have the compiler check it,
+ * as ModelRegistry does.
  */
 class BaseClassifier
 {
@@ -62,9 +85,15 @@ public:
     /**
      * @brief Destructor for BaseClassifier.
      */
-    ~BaseClassifier();
+    virtual ~BaseClassifier();
+
+    std::shared_ptr<BaseVectorizer> pVec;   /**< Vectorizer, shared with the factory that created it. */
 
-    BaseVectorizer* pVec;   /**< Pointer to the vectorizer. */
+protected:
+    bool loaded = false;    /**< Set by load, see isLoaded. */
+    std::shared_ptr<PredictionCache> cache;     /**< Optional cache of predictions, internally synchronised. */
+
+public:
 
     /**
      * @brief Display the shape of the vectorizer.
@@ -89,19 +118,93 @@ public:
      */
     virtual void fit(string abs_filepath_to_features, string abs_filepath_to_labels) = 0;
 
+    /**
+     * @brief Train on sentences that pVec has already turned into features.
+     *
+     * fit calls this with every sentence of pVec once the vectorizer is
+     * fitted. pVec is only read, so classifiers sharing one fitted vectorizer
+     * can train on different subsets of its sentences at the same time, see
+     * HyperparameterSearch.
+     *
+     * @param sentences Training sentences, vectorised by pVec.
+     */
+    virtual void fitSentences(const std::vector<std::shared_ptr<Sentence>>& sentences) = 0;
+
+    /**
+     * @brief Update a fitted or loaded model with more labelled data.
+     *
+     * The vocabulary grows to take in new features and training continues
+     * from the current model, so only the new sentences are processed. The
+     * default reports that the classifier has to be fitted again.
+     *
+     * @param abs_filepath_to_features Absolute file path to the new features file.
+     * @param abs_filepath_to_labels Absolute file path to the new labels file.
+     */
+    virtual void partial_fit(string abs_filepath_to_features, string abs_filepath_to_labels);
+
+    /**
+     * @brief Drop features whose weights hardly matter and shrink the model.
+     *
+     * A feature is kept if the largest |w| of its weight row is above
+     * threshold and, with top_k > 0, among the top_k largest. Dropped
+     * features are removed from the vocabulary, the remaining ones are
+     * renumbered and the weight matrix is compacted, so the saved model and
+     * the work per sentence both shrink. The default reports that the
+     * classifier cannot be pruned.
+     *
+     * @param threshold Largest |w| a feature must exceed to be kept.
+     * @param top_k Maximum number of features kept, 0 for no limit.
+     */
+    virtual void prune(double threshold, int top_k);
+
     /**
      * @brief Predict labels for the given features.
+     *
+     * The file is read PREDICT_BLOCK_BATCHES batches at a time, the batches
+     * of a block are scored in parallel on ThreadPool::shared() and written
+     * in the order of their lines.
+     *
      * @param abs_filepath_to_features Absolute file path to the features file.
      * @param abs_filepath_to_labels Absolute file path to save the predicted labels.
      */
-    virtual void predict(string abs_filepath_to_features, string abs_filepath_to_labels, bool preprocess = true) = 0;
+    void predict(const string& abs_filepath_to_features, const string& abs_filepath_to_labels, bool preprocess = true) const;
+
+    /**
+     * @brief Score a labelled data set and compute the metrics of Evaluation.
+     *
+     * The files are read PREDICT_BLOCK_BATCHES batches at a time. The
+     * batches of a block are scored in parallel on ThreadPool::shared() and
+     * then counted, so memory does not grow with the files.
+     *
+     * @param abs_filepath_to_features Absolute file path to the features file.
+     * @param abs_filepath_to_labels Absolute file path to the true labels, one per line.
+     * @param preprocess Lower case the text and blank out unexpected bytes first.
+     * @return The metrics, with a count of 0 if the files could not be read or differ in length.
+     */
+    Evaluation evaluate(const string& abs_filepath_to_features, const string& abs_filepath_to_labels, bool preprocess = true) const;
 
     /**
      * @brief Predict the label for a given sentence.
+     *
+     * Tokens, features and every other temporary live in the arena of the
+     * thread's PredictContext, which is reset before returning.
+     *
      * @param sentence The input sentence for prediction.
      * @return Prediction containing the label and probability.
      */
-    virtual Prediction predict(string sentence, bool preprocess = true) = 0;
+    Prediction predict(const string& sentence, bool preprocess = true) const;
+
+    /**
+     * @brief Predict the labels of many sentences at once.
+     *
+     * The whole batch is tokenised into one CSR block in the arena and scored
+     * in one call, so per-sentence fixed costs are paid once per batch.
+     *
+     * @param sentences The input sentences.
+     * @param results Receives one Prediction per sentence, at least as long as sentences.
+     * @param preprocess Lower case the text and blank out unexpected bytes first.
+     */
+    void predictBatch(std::span<const std::string_view> sentences, std::span<Prediction> results, bool preprocess = true) const;
 
     /**
      * @brief Save the classifier to a file.
@@ -115,9 +218,113 @@ public:
      */
     virtual void load(const std::string& filename) = 0;
 
+    /**
+     * @brief Whether the last call to load read a complete model.
+     * @return False if the file could not be opened or ended early.
+     */
+    bool isLoaded() const { return loaded; }
+
     void setVersionInfo(char* vers_info_in);
 
-    int minfrequency = 0;
+    /**
+     * @brief Put a PredictionCache in front of predict and predictBatch.
+     *
+     * Texts are looked up by the hash of their normalised form, so duplicates
+     * skip tokenising, vectorising and scoring. The cache starts empty, call
+     * this again after fit, partial_fit or load to drop stale entries.
+     *
+     * @param capacity Number of predictions to keep, 0 removes the cache.
+     */
+    void enableCache(size_t capacity);
+
+    /**
+     * @brief The prediction cache, for its hit and miss counters.
+     * @return The cache, null if none is enabled.
+     */
+    const PredictionCache* getCache() const { return cache.get(); }
+
+    /**
+     * @brief Name of a predicted class, as it appeared in the training labels.
+     * @param label Class index, e.g. Prediction::label.
+     * @return Label of the class, empty for an unknown index.
+     */
+    const std::string& labelName(int label) const { return pVec->getClassLabels().name(label); }
+
+protected:
+    /**
+     * @brief Score the feature vector of one sentence.
+     * @param features Feature vector produced by the vectorizer.
+     * @param ctx Context to take further scratch memory from.
+     * @return Prediction containing the label and probability.
+     */
+    virtual Prediction predictFeatures(const FeatureVector& features, PredictContext& ctx) const = 0;
+
+    /**
+     * @brief Score every row of a sparse batch.
+     *
+     * The default expands each row to a dense vector and calls predictFeatures.
+     *
+     * @param batch Feature vectors of the batch.
+     * @param results Receives one Prediction per row.
+     * @param ctx Context to take further scratch memory from.
+     */
+    virtual void predictSparseBatch(const SparseBatch& batch, std::span<Prediction> results, PredictContext& ctx) const;
+
+    /**
+     * @brief Pick the class with the highest score and its softmax probability.
+     *
+     * Ties go to the lower class index.
+     *
+     * @param scores Score of every class.
+     * @param num_classes Number of classes.
+     * @return Prediction with the class index and its probability.
+     */
+    static Prediction softmax(const double* scores, int num_classes);
+
+    /**
+     * @brief Choose the rows of a features x cols weight matrix that prune keeps.
+     *
+     * @param weights Weight matrix, row major.
+     * @param rows Number of features.
+     * @param cols Number of columns.
+     * @param threshold Largest |w| a row must exceed to be kept.
+     * @param top_k Maximum number of rows kept, 0 for no limit.
+     * @return New index of every row in the original order, -1 for dropped rows.
+     */
+    static std::vector<int> selectFeatures(const std::vector<double>& weights, size_t rows, size_t cols, double threshold, int top_k);
+
+    /**
+     * @brief Move the kept rows of a weight matrix to their new indices.
+     *
+     * @param weights Weight matrix, row major, compacted in place.
+     * @param cols Number of columns.
+     * @param old_to_new Result of selectFeatures.
+     */
+    static void compactRows(std::vector<double>& weights, size_t cols, const std::vector<int>& old_to_new);
+
+    /**
+     * @brief Run the weight update of one training sample over ranges of features.
+     *
+     * Every feature row of the weight matrix is updated independently, so
+     * from TRAIN_PARALLEL_MIN_WEIGHTS weights on the rows are split over
+     * ThreadPool::shared() and the result is the same as on one thread.
+     *
+     * @param num_features Number of feature rows.
+     * @param cols Number of columns.
+     * @param update Callable updating the rows [begin, end).
+     */
+    template <typename Update>
+    static void updateFeatureRows(size_t num_features, size_t cols, const Update& update)
+    {
+        if (num_features * cols >= TRAIN_PARALLEL_MIN_WEIGHTS)
+        {
+            ThreadPool::shared().parallelFor(num_features, TRAIN_PARALLEL_GRAIN, update);
+        }
+        else
+        {
+            update(0, num_features);
+        }
+    }
 };
 
 #endif // BASECLASSIFIER_H__
@@ -11,137 +11,704 @@ Revision History:
 #include <iostream>
 #include <string>
 #include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <limits>
 
 #include "BaseVectorizer.h"
 
-std::string preprocess_text(const std::string& text) {
-    
-    std::string processed = text; //.substr(0, MAX_TEXT_LEN);
+/**
+ * @brief Split a sentence into a vector of words.
+ *
+ * @param sentence_ The sentence to split.
+ * @return Vector of words.
+ */
+vector<string> BaseVectorizer::buildSentenceVector(std::string_view sentence_, bool preprocess)
+{
+    PredictContext& ctx = PredictContext::local();
+    PredictScope scope(ctx);
+    TokenList tokens(ctx.resource());
 
-    std::replace(processed.begin(), processed.end(), '\n', ' ');
+    tokenize(sentence_, preprocess, ctx, tokens);
+    return vector<string>(tokens.begin(), tokens.end());
+}
 
-    std::string filtered = "";
-    for (char c : processed) {
-        if (std::isalnum(c) || std::isspace(c) || std::ispunct(c)) {
-            filtered += std::tolower(c);
+/**
+ * @brief Split sentences into vectors of words in parallel.
+ *
+ * Every thread tokenises in the arena of its own PredictContext.
+ */
+vector<vector<string>> BaseVectorizer::buildSentenceVectors(std::span<const std::string_view> sentences_)
+{
+    vector<vector<string>> result(sentences_.size());
+    ThreadPool::shared().parallelFor(sentences_.size(), NORMALIZE_PARALLEL_GRAIN, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            result[i] = buildSentenceVector(sentences_[i]);
         }
-        else
+    });
+    return result;
+}
+
+/**
+ * @brief Split a sentence into tokens pointing into an arena copy of it.
+ */
+void BaseVectorizer::tokenize(std::string_view sentence_, bool preprocess, PredictContext& ctx, TokenList& tokens) const
+{
+    size_t len = sentence_.size();
+    char* text = static_cast<char*>(ctx.arena.allocate(len + 1, 1));
+    std::memcpy(text, sentence_.data(), len);
+
+    len = normalize(std::span<char>(text, len), preprocess);
+    splitTokens(std::string_view(text, len), tokens);
+}
+
+/**
+ * @brief Normalise a text in place.
+ *
+ * Preprocessing replaces bytes that are neither alphanumeric, space nor
+ * punctuation by a space and lower cases the rest. Without it only case
+ * folding is applied, when the vectorizer is case insensitive.
+ */
+size_t BaseVectorizer::normalize(std::span<char> text, bool preprocess) const
+{
+    if (!preprocess && case_sensitive)
+    {
+        return text.size();
+    }
+    if (unicode)
+    {
+        return Utf8::normalize(text.data(), text.size(), preprocess);
+    }
+
+    // Single bytes: anything >= 0x80 is blanked by preprocessing and kept otherwise.
+    char* data = text.data();
+    size_t len = text.size();
+    size_t i = 0;
+    while (i < len)
+    {
+        i += preprocess ? SimdKernels::normalizeAscii(data + i, len - i)
+                        : SimdKernels::lowerAscii(data + i, len - i);
+        if (i < len)
+        {
+            if (preprocess)
+            {
+                data[i] = ' ';
+            }
+            ++i;
+        }
+    }
+    return len;
+}
+
+/**
+ * @brief Normalise many texts in place, in parallel for large batches.
+ */
+void BaseVectorizer::normalizeBatch(std::span<std::span<char>> texts, bool preprocess) const
+{
+    if (!preprocess && case_sensitive)
+    {
+        return;
+    }
+
+    size_t bytes = 0;
+    for (const auto& text : texts)
+    {
+        bytes += text.size();
+    }
+
+    auto body = [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
         {
-            filtered += ' ';
+            texts[i] = texts[i].first(normalize(texts[i], preprocess));
         }
+    };
+    if (bytes < NORMALIZE_PARALLEL_MIN_BYTES)
+    {
+        body(0, texts.size());
     }
+    else
+    {
+        ThreadPool::shared().parallelFor(texts.size(), NORMALIZE_PARALLEL_GRAIN, body);
+    }
+}
 
-    return filtered;
+/**
+ * @brief Split a normalised text into tokens, see forEachToken.
+ */
+void BaseVectorizer::splitTokens(std::string_view text, TokenList& tokens) const
+{
+    forEachToken(text, [&](std::string_view word) { tokens.push_back(word); });
 }
 
 /**
- * @brief Split a sentence into a vector of words.
+ * @brief Add the sentences of a features and labels file to the vectorizer.
  *
- * @param sentence_ The sentence to split.
- * @return Vector of words.
+ * @param abs_filepath_to_features Absolute file path to the new features data.
+ * @param abs_filepath_to_labels Absolute file path to the new labels data.
+ */
+void BaseVectorizer::partial_fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels)
+{
+    LineReader features_in(abs_filepath_to_features);
+    LineReader labels_in(abs_filepath_to_labels);
+    std::string_view feature_output;
+    std::string_view label_output;
+
+    if (!features_in)
+    {
+        std::cout << "ERROR: Cannot open features file.\n";
+        return;
+    }
+    if (!labels_in)
+    {
+        std::cout << "ERROR: Cannot open labels file.\n";
+        return;
+    }
+
+    size_t added = 0;
+    while (features_in.next(feature_output))
+    {
+        if (!labels_in.next(label_output))
+        {
+            std::cout << "ERROR: Feature dimension is different from label dimension\n";
+            break;
+        }
+        addSentence(std::string(feature_output), class_labels.add(label_output));
+        added++;
+    }
+    std::cout << "Added " << added << " sentences, vocabulary is now " << getFeatureCount() << " features." << std::endl;
+}
+
+/**
+ * @brief Drop features and renumber the rest in the vocabulary and the sentences.
+ *
+ * @param old_to_new New index of every feature, -1 to drop it.
+ * @return False if old_to_new does not match the vocabulary.
  */
-vector<string> BaseVectorizer::buildSentenceVector(string sentence_, bool preprocess)
+bool BaseVectorizer::remapFeatures(const std::vector<int>& old_to_new)
 {
-    GlobalData vars;
-    string new_word = "";
-    vector<string> ret;
+    if (old_to_new.size() != word_array.size())
+    {
+        std::cerr << "ERROR: Feature map does not match the vocabulary.\n";
+        return false;
+    }
 
-    if (true == preprocess)
+    size_t kept = 0;
+    for (int idx : old_to_new)
+    {
+        kept += idx >= 0;
+    }
+    std::vector<std::string> kept_words(kept);
+    for (size_t i = 0; i < old_to_new.size(); ++i)
     {
-        sentence_ = preprocess_text(sentence_);
+        if (old_to_new[i] >= 0)
+        {
+            kept_words[old_to_new[i]] = std::move(word_array[i]);
+        }
     }
+    word_array.swap(kept_words);
 
-    for (char x : sentence_)
+    for (auto it = hash_to_idx.begin(); it != hash_to_idx.end();)
     {
-        if (isupper(x) && !case_sensitive)
+        int idx = old_to_new[it->second];
+        if (idx < 0)
         {
-            x = tolower(x);
+            it = hash_to_idx.erase(it);
         }
-        if (x == ' ')
+        else
         {
-            if (!include_stopwords && vars.stopWords.count(new_word))
-            {
-                new_word = "";
-            }
-            else
+            it->second = idx;
+            ++it;
+        }
+    }
+    hash_to_idx.rehash(0);
+
+    for (auto& sentence : sentences)
+    {
+        std::unordered_map<int, double> remapped;
+        for (const auto& entry : sentence->sentence_map)
+        {
+            if (old_to_new[entry.first] >= 0)
             {
-                ret.push_back(new_word);
-                new_word = "";
+                remapped[old_to_new[entry.first]] = entry.second;
             }
         }
-        else if (vars.punctuation.count(x))
+        sentence->sentence_map.swap(remapped);
+    }
+    return true;
+}
+
+void BaseVectorizer::setVersionInfo(char* vers_info_in)
+{
+    memset(vers_info, 0, sizeof(vers_info));
+    strcpy(vers_info, vers_info_in);
+}
+
+void BaseVectorizer::setHyperparameter(const std::string& key, double value)
+{
+    int n = static_cast<int>(value);
+
+    if (key == "ngram_min") {
+        ngram_min = std::min(std::max(n, 1), MAX_WORD_NGRAM);
+    }
+    else if (key == "ngram_max") {
+        ngram_max = std::min(std::max(n, 1), MAX_WORD_NGRAM);
+    }
+    else if (key == "char_ngram_min") {
+        char_ngram_min = std::min(std::max(n, 1), MAX_CHAR_NGRAM);
+    }
+    else if (key == "char_ngram_max") {
+        char_ngram_max = std::min(std::max(n, 0), MAX_CHAR_NGRAM);
+    }
+    else if (key == "unicode") {
+        unicode = (value != 0.0);
+    }
+    else if (key == "min_df" || key == "minfrequency") {
+        min_df = std::max(value, 0.0);
+    }
+    else if (key == "max_df") {
+        max_df = std::max(value, 0.0);
+    }
+    else if (key == "max_features") {
+        max_features = std::max(n, 0);
+    }
+}
+
+/**
+ * @brief Reset the vocabulary filter for the limits that are set.
+ */
+void BaseVectorizer::beginVocabularyCount()
+{
+    bool use_sketch = min_df >= 2.0 || (min_df > 0.0 && min_df < 1.0);
+    vocab_filter.reset(use_sketch, max_features);
+}
+
+/**
+ * @brief Hash the distinct features of a line into the vocabulary filter.
+ */
+void BaseVectorizer::countDocument(std::string_view sentence_)
+{
+    if (!vocab_filter.active())
+    {
+        return;
+    }
+
+    PredictContext& ctx = PredictContext::local();
+    PredictScope scope(ctx);
+    std::pmr::vector<uint64_t> hashes(ctx.resource());
+
+    // Normalised as addSentence does, so both see the same features.
+    char* text = static_cast<char*>(ctx.arena.allocate(sentence_.size() + 1, 1));
+    std::memcpy(text, sentence_.data(), sentence_.size());
+    size_t len = normalize(std::span<char>(text, sentence_.size()), false);
+    forEachTextFeature(std::string_view(text, len), [&](uint64_t hash, const FeatureSpan& span)
+    {
+        hashes.push_back(hash);
+    });
+
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    vocab_filter.addDocument(hashes.data(), hashes.size());
+}
+
+/**
+ * @brief Turn a share of the corpus into a document count.
+ *
+ * @param df min_df or max_df.
+ * @param num_docs Number of documents in the corpus.
+ * @param share_limit Largest value that is read as a share.
+ * @return Number of documents.
+ */
+static size_t documentCount(double df, size_t num_docs, double share_limit)
+{
+    if (df <= share_limit)
+    {
+        return static_cast<size_t>(std::ceil(df * num_docs));
+    }
+    return static_cast<size_t>(df);
+}
+
+/**
+ * @brief Set the count min_df stands for, proportions refer to the documents counted.
+ */
+void BaseVectorizer::endVocabularyCount()
+{
+    size_t min_count = documentCount(min_df, vocab_filter.documents(), std::nextafter(1.0, 0.0));
+    vocab_filter.finish(static_cast<uint32_t>(std::min<size_t>(min_count, std::numeric_limits<uint16_t>::max())));
+}
+
+/**
+ * @brief Remap the vocabulary to the features whose exact document frequency is within the limits.
+ */
+void BaseVectorizer::applyVocabularyLimits()
+{
+    bool limited = vocab_filter.active() || max_df < 1.0 || max_df > 1.0;
+    vocab_filter.release();
+    if (!limited)
+    {
+        return;
+    }
+
+    std::vector<size_t> doc_freqs(word_array.size(), 0);
+    for (const auto& sentence : sentences)
+    {
+        for (const auto& entry : sentence->sentence_map)
+        {
+            doc_freqs[entry.first]++;
+        }
+    }
+
+    size_t min_count = documentCount(min_df, sentences.size(), std::nextafter(1.0, 0.0));
+    size_t max_count = documentCount(max_df, sentences.size(), 1.0);
+    std::vector<int> candidates;
+    for (size_t i = 0; i < doc_freqs.size(); ++i)
+    {
+        if (doc_freqs[i] >= min_count && doc_freqs[i] <= max_count)
         {
-            ret.push_back(new_word);
-            new_word = x;
-            ret.push_back(new_word);
-            new_word = "";
+            candidates.push_back(static_cast<int>(i));
         }
-        else
+    }
+    if (max_features > 0 && candidates.size() > static_cast<size_t>(max_features))
+    {
+        // Most frequent first, ties go to the feature seen first.
+        std::nth_element(candidates.begin(), candidates.begin() + max_features, candidates.end(), [&](int a, int b)
         {
-            new_word += x;
+            return doc_freqs[a] != doc_freqs[b] ? doc_freqs[a] > doc_freqs[b] : a < b;
+        });
+        candidates.resize(max_features);
+        std::sort(candidates.begin(), candidates.end());
+    }
+
+    std::vector<int> old_to_new(word_array.size(), -1);
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        old_to_new[candidates[i]] = static_cast<int>(i);
+    }
+    std::cout << "Features removed by min_df, max_df and max_features = " << word_array.size() - candidates.size() << std::endl;
+    if (candidates.size() < word_array.size())
+    {
+        remapFeatures(old_to_new);
+    }
+}
+
+/**
+ * @brief Set an option whose value is text, e.g. "stopwords_file=stop.txt".
+ */
+bool BaseVectorizer::setOption(const std::string& key_value)
+{
+    size_t eq = key_value.find('=');
+    if (eq == std::string::npos)
+    {
+        return false;
+    }
+    std::string key = key_value.substr(0, eq);
+    std::string value = key_value.substr(eq + 1);
+
+    if (key == "stopwords_file") {
+        cout << key << " = " << value << endl;
+        if (token_filter.loadStopWords(value)) {
+            cout << token_filter.stopWordCount() << " stop words loaded" << endl;
         }
+        return true;
+    }
+    else if (key == "punctuation_file") {
+        cout << key << " = " << value << endl;
+        token_filter.loadPunctuation(value);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Human readable name of a feature, only used when a feature is first seen.
+ */
+std::string BaseVectorizer::featureName(const std::vector<std::string>& sentence_words, const FeatureSpan& span)
+{
+    if (span.ngram == 0)
+    {
+        std::string wrapped = "<" + sentence_words[span.token] + ">";
+        return wrapped.substr(span.offset, span.length);
+    }
+
+    std::string name = sentence_words[span.token];
+    for (int i = 1; i < span.ngram; ++i)
+    {
+        name += " " + sentence_words[span.token + i];
     }
+    return name;
+}
+
+void BaseVectorizer::saveFeatureConfig(std::ofstream& outFile) const
+{
+    outFile.write(reinterpret_cast<const char*>(&ngram_min), sizeof(ngram_min));
+    outFile.write(reinterpret_cast<const char*>(&ngram_max), sizeof(ngram_max));
+    outFile.write(reinterpret_cast<const char*>(&char_ngram_min), sizeof(char_ngram_min));
+    outFile.write(reinterpret_cast<const char*>(&char_ngram_max), sizeof(char_ngram_max));
+    outFile.write(reinterpret_cast<const char*>(&unicode), sizeof(unicode));
+    token_filter.save(outFile);
+    class_labels.save(outFile);
+}
+
+void BaseVectorizer::loadFeatureConfig(std::ifstream& inFile)
+{
+    inFile.read(reinterpret_cast<char*>(&ngram_min), sizeof(ngram_min));
+    inFile.read(reinterpret_cast<char*>(&ngram_max), sizeof(ngram_max));
+    inFile.read(reinterpret_cast<char*>(&char_ngram_min), sizeof(char_ngram_min));
+    inFile.read(reinterpret_cast<char*>(&char_ngram_max), sizeof(char_ngram_max));
+    inFile.read(reinterpret_cast<char*>(&unicode), sizeof(unicode));
+    token_filter.load(inFile);
+    class_labels.load(inFile);
+}
 
-    if (new_word != "")
+/**
+ * @brief Fixed size start of a corpus file, see saveCorpus.
+ */
+struct CorpusHeader
+{
+    char magic[8];              /**< CORPUS_MAGIC. */
+    uint32_t vectorizer_id;     /**< ID_VECTORIZER_* that wrote the file. */
+    uint32_t reserved;          /**< Zero. */
+    uint64_t num_rows;          /**< Number of sentences. */
+    uint64_t nnz;               /**< Number of stored entries over all sentences. */
+    uint64_t data_offset;       /**< Offset of the row offsets, the arrays follow each other from there. */
+};
+
+/**
+ * @brief Size of a corpus array padded to 8 bytes.
+ */
+static uint64_t corpusArrayBytes(uint64_t count, size_t element_size)
+{
+    return (count * element_size + 7) & ~static_cast<uint64_t>(7);
+}
+
+/**
+ * @brief Write an array and pad it to 8 bytes.
+ */
+static void writeCorpusArray(std::ofstream& outFile, const void* data, size_t count, size_t element_size)
+{
+    static const char padding[8] = {};
+    outFile.write(static_cast<const char*>(data), count * element_size);
+    outFile.write(padding, corpusArrayBytes(count, element_size) - count * element_size);
+}
+
+bool BaseVectorizer::saveCorpus(const std::string& abs_filepath) const
+{
+    std::ofstream outFile(abs_filepath, std::ios::binary);
+    if (!outFile)
     {
-        ret.push_back(new_word);
+        std::cerr << "ERROR: Cannot open corpus file.\n";
+        return false;
     }
 
-    vector<string> fixed_ret;
-    for (const auto& s : ret)
+    // Rows are stored sorted by feature index, whatever the order of the maps.
+    std::vector<uint64_t> row_ptr(1, 0);
+    std::vector<int32_t> labels;
+    std::vector<std::pair<int, double>> entries;
+    std::vector<int32_t> indices;
+    std::vector<double> values;
+    row_ptr.reserve(sentences.size() + 1);
+    labels.reserve(sentences.size());
+    for (const auto& sentence : sentences)
     {
-        if (!s.empty())
+        entries.assign(sentence->sentence_map.begin(), sentence->sentence_map.end());
+        std::sort(entries.begin(), entries.end());
+        for (const auto& entry : entries)
         {
-            fixed_ret.push_back(s);
+            indices.push_back(entry.first);
+            values.push_back(entry.second);
         }
+        row_ptr.push_back(indices.size());
+        labels.push_back(sentence->label);
+    }
+
+    CorpusHeader header = {};
+    std::memcpy(header.magic, CORPUS_MAGIC, sizeof(header.magic));
+    header.vectorizer_id = static_cast<uint32_t>(this_vectorizer_id);
+    header.num_rows = sentences.size();
+    header.nnz = indices.size();
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    save(outFile);
+
+    static const char padding[8] = {};
+    uint64_t vectorizer_end = static_cast<uint64_t>(outFile.tellp());
+    header.data_offset = corpusArrayBytes(vectorizer_end, 1);
+    outFile.write(padding, header.data_offset - vectorizer_end);
+    writeCorpusArray(outFile, row_ptr.data(), row_ptr.size(), sizeof(uint64_t));
+    writeCorpusArray(outFile, labels.data(), labels.size(), sizeof(int32_t));
+    writeCorpusArray(outFile, indices.data(), indices.size(), sizeof(int32_t));
+    writeCorpusArray(outFile, values.data(), values.size(), sizeof(double));
+
+    outFile.seekp(0);
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outFile.close();
+    if (outFile.fail())
+    {
+        std::cerr << "ERROR: Cannot write corpus file.\n";
+        return false;
     }
-    return fixed_ret;
+    return true;
 }
 
-void BaseVectorizer::scanForSparseHistogram(std::string abs_filepath_to_features, int minfrequency)
+bool BaseVectorizer::loadCorpus(const std::string& abs_filepath)
 {
-    ifstream in;
-    string feature;
-    vector<string> features;
+    // The whole file is mapped, its lines are of no interest.
+    LineReader file(abs_filepath);
+    std::string_view bytes = file.data();
+    CorpusHeader header;
+    if (!file.isMapped() || bytes.size() < sizeof(header) || std::memcmp(bytes.data(), CORPUS_MAGIC, sizeof(header.magic)) != 0)
+    {
+        std::cerr << "ERROR: " << abs_filepath << " is not a corpus file.\n";
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (header.vectorizer_id != static_cast<uint32_t>(this_vectorizer_id))
+    {
+        std::cerr << "ERROR: The corpus file was written by another vectorizer.\n";
+        return false;
+    }
+    // Every count is bounded by the file size first, so the offsets below cannot overflow.
+    const uint64_t file_size = bytes.size();
+    if (header.data_offset < sizeof(header) || header.data_offset > file_size || header.data_offset % 8 != 0
+        || header.num_rows > file_size / (sizeof(uint64_t) + sizeof(int32_t)) || header.nnz > file_size / (sizeof(int32_t) + sizeof(double)))
+    {
+        std::cerr << "ERROR: The corpus file is truncated.\n";
+        return false;
+    }
+    const uint64_t rows_at = header.data_offset;
+    const uint64_t labels_at = rows_at + corpusArrayBytes(header.num_rows + 1, sizeof(uint64_t));
+    const uint64_t indices_at = labels_at + corpusArrayBytes(header.num_rows, sizeof(int32_t));
+    const uint64_t values_at = indices_at + corpusArrayBytes(header.nnz, sizeof(int32_t));
+    if (values_at + corpusArrayBytes(header.nnz, sizeof(double)) > file_size)
+    {
+        std::cerr << "ERROR: The corpus file is truncated.\n";
+        return false;
+    }
 
-    in.open(abs_filepath_to_features);
+    const uint64_t* row_ptr = reinterpret_cast<const uint64_t*>(bytes.data() + rows_at);
+    const int32_t* labels = reinterpret_cast<const int32_t*>(bytes.data() + labels_at);
+    const int32_t* indices = reinterpret_cast<const int32_t*>(bytes.data() + indices_at);
+    const double* values = reinterpret_cast<const double*>(bytes.data() + values_at);
+    bool valid_rows = row_ptr[0] == 0 && row_ptr[header.num_rows] == header.nnz;
+    for (uint64_t r = 0; r < header.num_rows && valid_rows; ++r)
+    {
+        valid_rows = row_ptr[r] <= row_ptr[r + 1];
+    }
+    if (!valid_rows)
+    {
+        std::cerr << "ERROR: The rows of the corpus file are corrupt.\n";
+        return false;
+    }
 
-    if (!in)
+    char caller_vers_info[VERSION_INFO_SIZE];
+    std::memcpy(caller_vers_info, vers_info, sizeof(vers_info));
+    std::ifstream inFile(abs_filepath, std::ios::binary);
+    inFile.seekg(sizeof(header));
+    load(inFile);
+    std::memcpy(vers_info, caller_vers_info, sizeof(vers_info));
+    if (!inFile)
     {
-        cout << "ERROR: Cannot open features file.\n";
-        return;
+        std::cerr << "ERROR: Cannot read the vectorizer of the corpus file.\n";
+        return false;
     }
 
-    while (getline(in, feature))
+    // Classifiers index their arrays with these, nothing out of range may get through.
+    sentences.clear();
+    const int64_t num_features = getFeatureCount();
+    const int32_t num_labels = class_labels.size();
+    for (uint64_t r = 0; r < header.num_rows; ++r)
     {
-        features = buildSentenceVector(feature);
-        for (const auto& x : features)
+        if (labels[r] < 0 || labels[r] >= num_labels)
         {
-            if (histogram.count(x) || x.length() == 1)
-            {
-                histogram[x]++;
-            }
-            else
-            {
-                histogram[x] = 1;
-            }
+            std::cerr << "ERROR: The corpus file has a label that its vectorizer does not know.\n";
+            return false;
+        }
+    }
+    for (uint64_t i = 0; i < header.nnz; ++i)
+    {
+        if (indices[i] < 0 || indices[i] >= num_features)
+        {
+            std::cerr << "ERROR: The corpus file has a feature index beyond its vectorizer.\n";
+            return false;
         }
     }
-    in.close();
 
-    for (const auto& entry : histogram)
+    sentences.reserve(header.num_rows);
+    for (uint64_t r = 0; r < header.num_rows; ++r)
     {
-        if (entry.second >= minfrequency)
+        uint64_t begin = row_ptr[r];
+        uint64_t end = row_ptr[r + 1];
+        auto sentence = std::make_shared<Sentence>();
+        sentence->label = labels[r];
+        sentence->sentence_map.reserve(end - begin);
+        for (uint64_t i = begin; i < end; ++i)
         {
-            histogram.erase(entry.first);
+            sentence->sentence_map.emplace(indices[i], values[i]);
         }
+        sentences.push_back(sentence);
     }
+    return true;
+}
 
-    std::cout << "No of Rare Words = " << histogram.size() << std::endl;
+bool BaseVectorizer::isCorpusFile(const std::string& abs_filepath)
+{
+    // A pipe must not be read here, its first bytes would be lost to fit.
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(abs_filepath, error))
+    {
+        return false;
+    }
+    char magic[8] = {};
+    std::ifstream inFile(abs_filepath, std::ios::binary);
+    inFile.read(magic, sizeof(magic));
+    return inFile && std::memcmp(magic, CORPUS_MAGIC, sizeof(magic)) == 0;
 }
 
-void BaseVectorizer::setVersionInfo(char* vers_info_in)
+/**
+ * @brief Sort the class labels and renumber the sentences, see LabelDictionary::sort.
+ */
+void BaseVectorizer::sortLabels()
 {
-    memset(vers_info, 0, sizeof(vers_info));
-    strcpy(vers_info, vers_info_in);
+    std::vector<int> remap = class_labels.sort();
+    for (auto& sentence : sentences)
+    {
+        sentence->label = remap[sentence->label];
+    }
+}
+
+void BaseVectorizer::closeSparseRow(SparseBatch& batch, PredictContext& ctx) const
+{
+    size_t begin = batch.row_ptr.back();
+    size_t end = batch.col_idx.size();
+    std::pmr::vector<std::pair<int, double>> entries(ctx.resource());
+    entries.reserve(end - begin);
+    for (size_t i = begin; i < end; ++i)
+    {
+        entries.emplace_back(batch.col_idx[i], batch.values[i]);
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const std::pair<int, double>& a, const std::pair<int, double>& b) { return a.first < b.first; });
+
+    // Rewrite the row in place, merged entries never outnumber the appended ones.
+    size_t out = begin;
+    for (size_t i = 0; i < entries.size();)
+    {
+        int idx = entries[i].first;
+        double sum = 0.0;
+        for (; i < entries.size() && entries[i].first == idx; ++i)
+        {
+            sum += entries[i].second;
+        }
+        if (sum != 0.0)
+        {
+            batch.col_idx[out] = idx;
+            batch.values[out] = sum;
+            out++;
+        }
+    }
+    batch.col_idx.resize(out);
+    batch.values.resize(out);
+    batch.row_ptr.push_back(out);
 }
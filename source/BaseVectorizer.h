@@ -22,21 +22,60 @@ Revision History:
 #include <memory>
 #include <fstream>
 #include <cstring>
-
-#include "GlobalData.h"
+#include <cstdint>
+#include <algorithm>
+#include <span>
+#include <set>
+#include <functional>
+
+#include "FeatureHash.h"
+#include "PredictContext.h"
+#include "SimdKernels.h"
+#include "ThreadPool.h"
+#include "Utf8.h"
+#include "TokenFilter.h"
+#include "LabelDictionary.h"
+#include "VocabularyFilter.h"
+#include "LineReader.h"
+
+using namespace std;
 
 #define ID_VECTORIZER_COUNT     1
 #define ID_VECTORIZER_TFIDF     2
+#define ID_VECTORIZER_HASHING   3
 
 #define VERSION_INFO_SIZE		32
 
+#define MAX_WORD_NGRAM          3
+#define MAX_CHAR_NGRAM          5
+
+#define NORMALIZE_PARALLEL_MIN_BYTES    (1 << 20)   /**< Smaller batches are normalised on the calling thread. */
+#define NORMALIZE_PARALLEL_GRAIN        16          /**< Texts per chunk when normalising in parallel. */
+#define FIT_BLOCK_SENTENCES             4096        /**< Sentences tokenised in parallel at a time by fit, on average. */
+
+#define CORPUS_MAGIC                    "TCCORP01"  /**< First 8 bytes of a corpus file, see BaseVectorizer::saveCorpus. */
+
 /**
  * @brief Structure representing a sentence with its corresponding label.
  */
 struct Sentence
 {
     std::unordered_map<int, double> sentence_map; /**< Map representing the sentence. */
-    bool label; /**< Label indicating the classification of the sentence. */
+    int label; /**< Class index of the sentence, see LabelDictionary. */
+};
+
+/**
+ * @brief Location of a feature inside a tokenised sentence.
+ *
+ * Only needed to name a feature, e.g. when it enters a vocabulary; the
+ * feature itself is identified by its hash.
+ */
+struct FeatureSpan
+{
+    int token;  /**< Index of the first token. */
+    int ngram;  /**< Number of tokens of a word n-gram, 0 for a character n-gram. */
+    int offset; /**< Offset of a character n-gram inside "<token>". */
+    int length; /**< Length in bytes of a character n-gram. */
 };
 
 /**
@@ -49,13 +88,40 @@ public:
 
     /**
      * @brief Fits the vectorizer on the provided features and labels data.
+     *
+     * A corpus file written by saveCorpus may be given instead of the
+     * features file, it is loaded with loadCorpus and the labels file is not
+     * read.
      * 
-     * @param abs_filepath_to_features Absolute file path to the features data.
+     * @param abs_filepath_to_features Absolute file path to the features data or a corpus file.
      * @param abs_filepath_to_labels Absolute file path to the labels data.
      */
     virtual void fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels) = 0;
 
-    void scanForSparseHistogram(std::string abs_filepath_to_features, int minfrequency);
+    /**
+     * @brief Adds more labelled sentences to a fitted or loaded vectorizer.
+     *
+     * New features are appended to the vocabulary, so the indices of known
+     * features, and with them the weights of a trained model, stay valid.
+     * The sentences are appended to those already held; a loaded vectorizer
+     * holds none, so afterwards sentences only holds the new data.
+     *
+     * @param abs_filepath_to_features Absolute file path to the new features data.
+     * @param abs_filepath_to_labels Absolute file path to the new labels data.
+     */
+    virtual void partial_fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels);
+
+    /**
+     * @brief Drops features from the vocabulary and renumbers the rest.
+     *
+     * The feature names, the hash lookup table and the sentences held are
+     * rewritten, so dropped features are no longer produced at all.
+     *
+     * @param old_to_new New index of every feature, -1 to drop it. Kept
+     *                   features must be numbered 0..n-1.
+     * @return False if the vectorizer has no vocabulary to remap.
+     */
+    virtual bool remapFeatures(const std::vector<int>& old_to_new);
 
     /**
      * @brief Returns the shape of the vectorized data.
@@ -88,13 +154,52 @@ public:
      */
     void setIncludeStopWords(bool bool_) { include_stopwords = bool_; }
 
+    /**
+     * @brief Sets an option whose value is text rather than a number.
+     *
+     * Handles stopwords_file and punctuation_file, which replace the stop
+     * words and punctuation characters from a file, see TokenFilter.
+     * Classifiers offer every "key=value" pair of their hyperparameter string
+     * here first.
+     *
+     * @param key_value One "key=value" pair.
+     * @return True if the key is a text option, false otherwise.
+     */
+    bool setOption(const std::string& key_value);
+
+    /**
+     * @brief Stop words and punctuation used when splitting tokens.
+     *
+     * @return The token filter.
+     */
+    const TokenFilter& getTokenFilter() const { return token_filter; }
+
+    /**
+     * @brief Names of the classes the training labels were mapped to.
+     *
+     * @return The label dictionary.
+     */
+    const LabelDictionary& getClassLabels() const { return class_labels; }
+
+    /**
+     * @brief Sets a vectorizer hyperparameter.
+     *
+     * Classifiers forward every key of their hyperparameter string here, so
+     * unknown keys must be ignored. The base class handles the n-gram ranges
+     * ngram_min, ngram_max, char_ngram_min and char_ngram_max, and unicode.
+     *
+     * @param key Name of the hyperparameter.
+     * @param value Value of the hyperparameter.
+     */
+    virtual void setHyperparameter(const std::string& key, double value);
+
     /**
      * @brief Adds a new sentence to the vectorizer.
      * 
      * @param new_sentence The new sentence to be added.
-     * @param label_ The label associated with the new sentence.
+     * @param label_ Class index of the new sentence, see getClassLabels.
      */
-    virtual void addSentence(std::string new_sentence, bool label_) = 0;
+    virtual void addSentence(std::string new_sentence, int label_) = 0;
 
     /**
      * @brief Checks if a word is present in the vectorizer.
@@ -110,20 +215,135 @@ public:
      * @param sentence_ The sentence to be vectorized.
      * @return Vector representation of the sentence.
      */
-    std::vector<std::string> buildSentenceVector(std::string sentence_, bool preprocess=false);
+    std::vector<std::string> buildSentenceVector(std::string_view sentence_, bool preprocess=false);
+
+    /**
+     * @brief Splits a sentence into tokens without allocating from the heap.
+     *
+     * The sentence is copied into the arena of the context, normalised there
+     * and the tokens point into that copy.
+     *
+     * @param sentence_ The sentence to be tokenised.
+     * @param preprocess Lower case the text and blank out unexpected bytes first.
+     * @param ctx Context providing the scratch memory.
+     * @param tokens Receives the tokens.
+     */
+    void tokenize(std::string_view sentence_, bool preprocess, PredictContext& ctx, TokenList& tokens) const;
+
+    /**
+     * @brief Normalises a text in place the way tokenize does before splitting.
+     *
+     * With unicode set the text is treated as UTF-8 and case folded code
+     * point by code point, see Utf8::normalize; otherwise only ASCII letters
+     * are folded and preprocessing blanks out every byte >= 0x80.
+     *
+     * @param text Text to normalise.
+     * @param preprocess Lower case the text and blank out unexpected bytes.
+     * @return New length of the text, case folding may shorten UTF-8 text.
+     */
+    size_t normalize(std::span<char> text, bool preprocess) const;
+
+    /**
+     * @brief Normalises many texts in place, in parallel for large batches.
+     *
+     * Batches of at least NORMALIZE_PARALLEL_MIN_BYTES are split between the
+     * threads of ThreadPool::shared().
+     *
+     * @param texts Texts to normalise, shortened to their new length.
+     * @param preprocess Lower case the texts and blank out unexpected bytes.
+     */
+    void normalizeBatch(std::span<std::span<char>> texts, bool preprocess) const;
+
+    /**
+     * @brief Splits a normalised text into tokens pointing into it.
+     *
+     * @param text Text returned by normalize.
+     * @param tokens Receives the tokens.
+     */
+    void splitTokens(std::string_view text, TokenList& tokens) const;
+
+    /**
+     * @brief Calls on_token(token) for every token of a normalised text.
+     *
+     * Tokens are separated by spaces, punctuation characters become tokens of
+     * their own and stop words are dropped when they are followed by a space.
+     *
+     * @param text Text returned by normalize.
+     * @param on_token Callable taking a std::string_view into text.
+     */
+    template <typename OnToken>
+    void forEachToken(std::string_view text, OnToken on_token) const;
 
     /**
      * @brief Retrieves the feature vector of a sentence.
      * 
-     * @param sentence_words Vector representation of the sentence.
-     * @return Feature vector of the sentence.
+     * @param sentence_words Tokens of the sentence.
+     * @param ctx Context providing the scratch memory.
+     * @param sentence_features Receives the feature vector, getFeatureCount() long.
+     */
+    virtual void getSentenceFeatures(const TokenList& sentence_words, PredictContext& ctx, FeatureVector& sentence_features) const = 0;
+
+    /**
+     * @brief Appends the features of a sentence as a new row of a sparse batch.
+     *
+     * The text is scanned once: every token is hashed where it lies, looked
+     * up and its (index, value) pair appended to the batch, no token list is
+     * built. The row holds the same values as getSentenceFeatures, minus the
+     * zeros, sorted by feature index.
+     *
+     * @param text Sentence returned by normalize.
+     * @param ctx Context providing the scratch memory.
+     * @param batch Batch to append the row to.
      */
-    virtual std::vector<double> getSentenceFeatures(std::vector<std::string> sentence_words) const = 0;
+    virtual void appendSparseFeatures(std::string_view text, PredictContext& ctx, SparseBatch& batch) const = 0;
 
     virtual std::vector<double> getFrequencies(std::unordered_map<int, double> term_freqs) const = 0;
 
+    /**
+     * @brief Calls emit(hash, span) for every feature of a tokenised sentence.
+     *
+     * Word n-grams are hashed with a polynomial rolling hash over the token
+     * hashes and character n-grams of "<token>" with a Rabin-Karp rolling hash
+     * over its bytes, so no n-gram string is ever built. Unigrams hash to
+     * hashString(word).
+     *
+     * @param sentence_words Tokens of the sentence, strings or string_views.
+     * @param emit Callable taking (uint64_t hash, const FeatureSpan& span).
+     */
+    template <typename Words, typename Emit>
+    void forEachFeature(const Words& sentence_words, Emit emit) const;
+
+    /**
+     * @brief Calls emit(hash, span) for every feature of a normalised text.
+     *
+     * Fuses forEachToken and forEachFeature: tokens are hashed as they are
+     * found, so the text is read once and no token list is built. Emits the
+     * same hashes in the same order as forEachFeature on splitTokens(text).
+     *
+     * @param text Text returned by normalize.
+     * @param emit Callable taking (uint64_t hash, const FeatureSpan& span).
+     */
+    template <typename Emit>
+    void forEachTextFeature(std::string_view text, Emit emit) const;
+
+    /**
+     * @brief Human readable name of a feature, e.g. "not good" or "<go".
+     *
+     * @param sentence_words Vector representation of the sentence.
+     * @param span Location of the feature.
+     * @return Name of the feature.
+     */
+    static std::string featureName(const std::vector<std::string>& sentence_words, const FeatureSpan& span);
+
     void setVersionInfo(char* vers_info_in);
 
+    /**
+     * @brief Version string of the model, as given when it was fitted.
+     *
+     * @return NUL terminated version string.
+     */
+    const char* getVersionInfo() const { return vers_info; }
+
     /**
      * @brief Retrieves the word at the specified index.
      * 
@@ -147,6 +367,13 @@ public:
      */
     unsigned int getWordArraySize() { return word_array.size(); }
 
+    /**
+     * @brief Retrieves the dimension of the feature vectors produced.
+     *
+     * @return Number of features, which is the vocabulary size by default.
+     */
+    virtual unsigned int getFeatureCount() const { return word_array.size(); }
+
     /**
      * @brief Retrieves the count of sentences.
      * 
@@ -168,6 +395,41 @@ public:
      */
     virtual void load(std::ifstream& inFile) = 0;
 
+    /**
+     * @brief Writes the fitted vectorizer and its sentences to a corpus file.
+     *
+     * The file holds a header, the vectorizer as save writes it (vocabulary,
+     * settings and class labels), and the sentences as a CSR matrix: row
+     * offsets (uint64, rows + 1), labels (int32), feature indices (int32,
+     * ascending within a row) and values (double), each array starting 8 byte
+     * aligned so the file can be used in place once mapped. fit accepts the
+     * file instead of a features file and skips reading text altogether.
+     *
+     * @param abs_filepath Absolute file path to write to.
+     * @return False if the file could not be written.
+     */
+    bool saveCorpus(const std::string& abs_filepath) const;
+
+    /**
+     * @brief Restores a vectorizer and its sentences from a corpus file, see saveCorpus.
+     *
+     * The file is memory mapped. The version info set before is kept, every
+     * other setting comes from the file. Sizes, row offsets, labels and
+     * feature indices are all checked, a file failing any check leaves no
+     * sentences.
+     *
+     * @param abs_filepath Absolute file path to the corpus file.
+     * @return False if the file is not a valid corpus file of this kind of vectorizer.
+     */
+    bool loadCorpus(const std::string& abs_filepath);
+
+    /**
+     * @brief Whether a regular file starts with CORPUS_MAGIC.
+     *
+     * @param abs_filepath Absolute file path.
+     */
+    static bool isCorpusFile(const std::string& abs_filepath);
+
     friend class NaiveBayesClassifier;
     friend class LogisticRegressionClassifier;
     friend class SVCClassifier;
@@ -176,15 +438,248 @@ public:
     friend class GradientBoostingClassifier;
 
 protected:
-    std::vector<std::string> word_array; /**< Array storing words. */
-    std::unordered_map<std::string, int> word_to_idx; /**< Map of words to their indices. */
+    /**
+     * @brief Tokenises sentences on ThreadPool::shared(), each as buildSentenceVector does.
+     *
+     * @param sentences_ Sentences to tokenise, for example lines of a mapped file.
+     * @return Tokens of every sentence, in order.
+     */
+    std::vector<std::vector<std::string>> buildSentenceVectors(std::span<const std::string_view> sentences_);
+
+    /**
+     * @brief Writes the n-gram, text, token filter and label settings, shared by all vectorizers.
+     *
+     * @param outFile Output file stream.
+     */
+    void saveFeatureConfig(std::ofstream& outFile) const;
+
+    /**
+     * @brief Reads the settings written by saveFeatureConfig.
+     *
+     * @param inFile Input file stream.
+     */
+    void loadFeatureConfig(std::ifstream& inFile);
+
+    /**
+     * @brief Ends the row being appended to a sparse batch.
+     *
+     * Sorts the entries appended since the previous row by index, sums
+     * duplicate indices and drops entries that sum to zero.
+     *
+     * @param batch Batch the entries were appended to.
+     * @param ctx Context providing the scratch memory.
+     */
+    void closeSparseRow(SparseBatch& batch, PredictContext& ctx) const;
+
+    /**
+     * @brief Sorts the class labels at the end of fit and renumbers the sentences to match.
+     */
+    void sortLabels();
+
+    std::vector<std::string> word_array; /**< Array storing feature names. */
+    std::unordered_map<uint64_t, int> hash_to_idx; /**< Map of feature hashes to their indices. */
     std::vector<std::shared_ptr<Sentence>> sentences; /**< Vector storing sentences. */
-    std::unordered_map<std::string, int> histogram;
     int this_vectorizer_id;
     bool binary; /**< Flag indicating binary encoding. */
     bool case_sensitive; /**< Flag indicating case sensitivity. */
+    bool unicode = true; /**< Treat text as UTF-8 rather than single bytes. */
+    TokenFilter token_filter; /**< Stop words and punctuation characters. */
+    LabelDictionary class_labels; /**< Names of the classes. */
     bool include_stopwords; /**< Flag indicating inclusion of stop words. */
     char vers_info[VERSION_INFO_SIZE];
+    int ngram_min = 1; /**< Smallest word n-gram. */
+    int ngram_max = 1; /**< Largest word n-gram. */
+    int char_ngram_min = 3; /**< Smallest character n-gram. */
+    int char_ngram_max = 0; /**< Largest character n-gram, 0 disables them. */
+    double min_df = 1.0; /**< Documents a feature must appear in, a share of the corpus below 1. */
+    double max_df = 1.0; /**< Documents a feature may appear in, a share of the corpus up to 1. */
+    int max_features = 0; /**< Features kept by document frequency, 0 for no limit. */
+    VocabularyFilter vocab_filter; /**< Decides which features fit admits, see beginVocabularyCount. */
+
+    /**
+     * @brief Start counting document frequencies for min_df and max_features.
+     *
+     * Fit calls countDocument for every line as it reads the features file,
+     * endVocabularyCount before it builds the vocabulary and
+     * applyVocabularyLimits once the sentences are built. Nothing is counted
+     * when no limit is set.
+     */
+    void beginVocabularyCount();
+
+    /**
+     * @brief Count the distinct features of one document.
+     *
+     * @param sentence_ Line of the features file.
+     */
+    void countDocument(std::string_view sentence_);
+
+    /**
+     * @brief Fix the document frequency min_df stands for, now that the corpus size is known.
+     */
+    void endVocabularyCount();
+
+    /**
+     * @brief Drop features outside min_df, max_df and max_features by their exact document frequencies.
+     *
+     * Only features the filter admitted are in the vocabulary, so this
+     * corrects the few that the sketches let through and applies max_df.
+     */
+    void applyVocabularyLimits();
 };
 
+/**
+ * @class FeatureStream
+ * @brief State of forEachFeature between two tokens, so tokens can be fed one at a time.
+ */
+class FeatureStream
+{
+public:
+    /**
+     * @brief Start a sentence with the n-gram settings of a vectorizer.
+     */
+    FeatureStream(int ngram_min, int ngram_max, int char_ngram_min, int char_ngram_max)
+        : word_lo(std::max(ngram_min, 1)), word_hi(std::min(ngram_max, MAX_WORD_NGRAM)),
+          char_lo(std::max(char_ngram_min, 1)), char_hi(std::min(char_ngram_max, MAX_CHAR_NGRAM)), token(0)
+    {
+        for (int n = 0; n <= MAX_WORD_NGRAM; ++n)
+        {
+            token_ring[n] = 0;
+            word_roll[n] = 0;
+            word_lead[n] = rollingPower(FEATUREHASH_ROLL_TOKEN, n);
+        }
+        for (int n = 0; n <= MAX_CHAR_NGRAM; ++n)
+        {
+            char_lead[n] = rollingPower(FEATUREHASH_ROLL_CHAR, n);
+        }
+    }
+
+    /**
+     * @brief Emit the features ending at the next token of the sentence.
+     *
+     * @param word Next token.
+     * @param emit Callable taking (uint64_t hash, const FeatureSpan& span).
+     */
+    template <typename Emit>
+    void push(std::string_view word, Emit& emit)
+    {
+        const size_t i = static_cast<size_t>(token);
+        uint64_t token_hash = hashBytes(word.data(), word.size());
+
+        if (word_lo <= 1 && word_hi >= 1)
+        {
+            emit(token_hash, FeatureSpan{ token, 1, 0, 0 });
+        }
+
+        // Slide every n-gram window one token to the right.
+        for (int n = std::max(word_lo, 2); n <= word_hi; ++n)
+        {
+            word_roll[n] = word_roll[n] * FEATUREHASH_ROLL_TOKEN + token_hash;
+            if (token >= n)
+            {
+                word_roll[n] -= token_ring[(i - n) % (MAX_WORD_NGRAM + 1)] * word_lead[n];
+            }
+            if (token + 1 >= n)
+            {
+                emit(wordNgramHash(word_roll[n], n), FeatureSpan{ token + 1 - n, n, 0, 0 });
+            }
+        }
+        token_ring[i % (MAX_WORD_NGRAM + 1)] = token_hash;
+
+        if (char_hi >= char_lo)
+        {
+            pushChars(word, emit);
+        }
+        token++;
+    }
+
+private:
+    const int word_lo, word_hi, char_lo, char_hi;
+    int token;                                      /**< Index of the next token. */
+    uint64_t token_ring[MAX_WORD_NGRAM + 1];        /**< Hashes of the last tokens. */
+    uint64_t word_roll[MAX_WORD_NGRAM + 1];         /**< Rolling hash of every word n-gram window. */
+    uint64_t word_lead[MAX_WORD_NGRAM + 1];         /**< Weight of the token leaving a window. */
+    uint64_t char_lead[MAX_CHAR_NGRAM + 1];         /**< Weight of the byte leaving a window. */
+
+    /**
+     * @brief Character n-grams of the word wrapped in boundary markers.
+     */
+    template <typename Emit>
+    void pushChars(std::string_view word, Emit& emit)
+    {
+        uint64_t char_roll[MAX_CHAR_NGRAM + 1] = {0};
+        const int wrapped_len = static_cast<int>(word.size()) + 2;
+        for (int k = 0; k < wrapped_len; ++k)
+        {
+            unsigned char c_in = k == 0 ? '<' : (k == wrapped_len - 1 ? '>' : word[k - 1]);
+            for (int n = char_lo; n <= char_hi; ++n)
+            {
+                char_roll[n] = char_roll[n] * FEATUREHASH_ROLL_CHAR + c_in;
+                if (k >= n)
+                {
+                    int out = k - n;
+                    unsigned char c_out = out == 0 ? '<' : word[out - 1];
+                    char_roll[n] -= c_out * char_lead[n];
+                }
+                if (k + 1 >= n)
+                {
+                    emit(charNgramHash(char_roll[n], n), FeatureSpan{ token, 0, k + 1 - n, n });
+                }
+            }
+        }
+    }
+};
+
+template <typename Words, typename Emit>
+void BaseVectorizer::forEachFeature(const Words& sentence_words, Emit emit) const
+{
+    FeatureStream stream(ngram_min, ngram_max, char_ngram_min, char_ngram_max);
+    for (const auto& word : sentence_words)
+    {
+        stream.push(std::string_view(word.data(), word.size()), emit);
+    }
+}
+
+template <typename OnToken>
+void BaseVectorizer::forEachToken(std::string_view text, OnToken on_token) const
+{
+    const char* data = text.data();
+    size_t len = text.size();
+
+    size_t start = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+        char x = data[i];
+        if (x == ' ')
+        {
+            std::string_view word(data + start, i - start);
+            if (!word.empty() && (include_stopwords || !token_filter.isStopWord(word)))
+            {
+                on_token(word);
+            }
+            start = i + 1;
+        }
+        else if (token_filter.isPunctuation(x))
+        {
+            if (i > start)
+            {
+                on_token(std::string_view(data + start, i - start));
+            }
+            on_token(std::string_view(data + i, 1));
+            start = i + 1;
+        }
+    }
+
+    if (len > start)
+    {
+        on_token(std::string_view(data + start, len - start));
+    }
+}
+
+template <typename Emit>
+void BaseVectorizer::forEachTextFeature(std::string_view text, Emit emit) const
+{
+    FeatureStream stream(ngram_min, ngram_max, char_ngram_min, char_ngram_max);
+    forEachToken(text, [&](std::string_view word) { stream.push(word, emit); });
+}
+
 #endif // BASEVECTORIZER_H__
@@ -58,41 +58,59 @@ CountVectorizer::~CountVectorizer()
  */
 void CountVectorizer::fit(string abs_filepath_to_features, string abs_filepath_to_labels)
 {
-    ifstream in;
-    string feature_output;
-    string label_output;
-    vector<string> features;
-    vector<bool> labels;
+    if (isCorpusFile(abs_filepath_to_features))
+    {
+        loadCorpus(abs_filepath_to_features);
+        return;
+    }
 
-    in.open(abs_filepath_to_features);
+    LineReader in;
+    LineReader labels_in;
+    string pipe_text;
+    string_view feature_output;
+    string_view label_output;
+    vector<string_view> lines;
+    vector<int> labels;
 
-    if (!in)
+    if (!in.open(abs_filepath_to_features))
     {
         cout << "ERROR: Cannot open features file.\n";
         return;
     }
 
-    while (getline(in, feature_output))
+    // The features are read twice, a pipe is kept in memory to be read again.
+    if (!in.isMapped())
     {
-        features.push_back(feature_output);
+        while (in.next(feature_output))
+        {
+            pipe_text.append(feature_output);
+            pipe_text.push_back('\n');
+        }
+        in.assign(pipe_text);
     }
-    in.close();
 
-    in.open(abs_filepath_to_labels);
+    // Document frequencies for min_df and max_features are counted in a first pass.
+    unsigned int feature_size = 0;
+    beginVocabularyCount();
+    while (in.next(feature_output))
+    {
+        countDocument(feature_output);
+        feature_size++;
+    }
+    endVocabularyCount();
 
-    if (!in)
+    if (!labels_in.open(abs_filepath_to_labels))
     {
         cout << "ERROR: Cannot open labels file.\n";
         return;
     }
 
-    while (getline(in, label_output))
+    while (labels_in.next(label_output))
     {
-        labels.push_back((bool)std::stoi(label_output));
+        labels.push_back(class_labels.add(label_output));
     }
-    in.close();
+    labels_in.close();
 
-    unsigned int feature_size = features.size();
     if (feature_size != labels.size())
     {
         cout << "ERROR: Feature dimension is different from label dimension\n";
@@ -100,20 +118,39 @@ void CountVectorizer::fit(string abs_filepath_to_features, string abs_filepath_t
     }
 
     cout << "Fitting CountVectorizer..." << endl;
-    int perc, prevperc;
+    int perc = -1, prevperc;
+    unsigned int i = 0;
 
-    for (unsigned int i = 0; i < feature_size; i++)
+    // The text is cut at line ends into blocks that are tokenised in parallel
+    // straight from the mapping, the vocabulary grows in order.
+    for (string_view block : LineReader::split(in.data(), (feature_size + FIT_BLOCK_SENTENCES - 1) / FIT_BLOCK_SENTENCES))
     {
-        addSentence(features[i], labels[i]);
+        LineReader block_in;
+        block_in.assign(block);
+        lines.clear();
+        while (block_in.next(feature_output))
+        {
+            lines.push_back(feature_output);
+        }
 
-        prevperc = perc;
-        perc = int(float(i) / feature_size * 100);
-        if (prevperc != perc)
+        vector<vector<string>> tokens = buildSentenceVectors(lines);
+        for (size_t j = 0; j < tokens.size(); j++, i++)
         {
-            cout << perc << " % done" << endl;
+            addSentenceTokens(std::move(tokens[j]), labels[i]);
+
+            prevperc = perc;
+            perc = int(float(i) / feature_size * 100);
+            if (prevperc != perc)
+            {
+                cout << perc << " % done" << endl;
+            }
         }
     }
+    in.close();
     cout << endl;
+
+    applyVocabularyLimits();
+    sortLabels();
 }
 
 /**
@@ -181,34 +218,38 @@ int CountVectorizer::is_wordInSentence(Sentence sentence_, unsigned int idx)
  */
 void CountVectorizer::pushSentenceToWordArray(vector<string> new_sentence_vector)
 {
-    for (const string& word : new_sentence_vector)
+    forEachFeature(new_sentence_vector, [&](uint64_t hash, const FeatureSpan& span)
     {
-        if (!ContainsWord(word) && !histogram.count(word))
+        if (!vocab_filter.admits(hash))
         {
-            word_array.push_back(word);
-            word_to_idx[word] = word_array.size() - 1;
+            return;
         }
-    }
+        if (!hash_to_idx.count(hash))
+        {
+            word_array.push_back(featureName(new_sentence_vector, span));
+            hash_to_idx[hash] = word_array.size() - 1;
+        }
+    });
 }
 
 /**
  * @brief Create a Sentence object from a vector of words.
  *
  * @param new_sentence_vector The vector of words forming the sentence.
- * @param label_ Boolean label for the sentence.
+ * @param label_ Class index of the sentence.
  * @return Shared pointer to the created Sentence object.
  */
-shared_ptr<Sentence> CountVectorizer::createSentenceObject(vector<string> new_sentence_vector, bool label_)
+shared_ptr<Sentence> CountVectorizer::createSentenceObject(vector<string> new_sentence_vector, int label_)
 {
     shared_ptr<Sentence> new_sentence(new Sentence);
-    for (const auto& word : new_sentence_vector)
+    forEachFeature(new_sentence_vector, [&](uint64_t hash, const FeatureSpan& span)
     {
-        if (histogram.count(word))
+        auto it = hash_to_idx.find(hash);
+        if (it == hash_to_idx.end())
         {
-            continue;
+            return;
         }
-
-        int idx = word_to_idx[word];
+        int idx = it->second;
         if (new_sentence->sentence_map.count(idx))
         {
             new_sentence->sentence_map[idx]++;
@@ -217,7 +258,7 @@ shared_ptr<Sentence> CountVectorizer::createSentenceObject(vector<string> new_se
         {
             new_sentence->sentence_map[idx] = 1.0;
         }
-    }
+    });
     if (binary)
     {
         for (auto& entry : new_sentence->sentence_map)
@@ -233,12 +274,21 @@ shared_ptr<Sentence> CountVectorizer::createSentenceObject(vector<string> new_se
  * @brief Add a sentence to the CountVectorizer.
  *
  * @param new_sentence The new sentence to add.
- * @param label_ Boolean label for the sentence.
+ * @param label_ Class index of the sentence.
+ */
+void CountVectorizer::addSentence(string new_sentence, int label_)
+{
+    addSentenceTokens(buildSentenceVector(new_sentence), label_);
+}
+
+/**
+ * @brief Add a tokenised sentence to the vocabulary and the corpus.
+ *
+ * @param processedString Tokens of the sentence, see buildSentenceVector.
+ * @param label_ Class index of the sentence.
  */
-void CountVectorizer::addSentence(string new_sentence, bool label_)
+void CountVectorizer::addSentenceTokens(vector<string> processedString, int label_)
 {
-    vector<string> processedString;
-    processedString = buildSentenceVector(new_sentence);
     pushSentenceToWordArray(processedString);
     shared_ptr<Sentence> sentObj = createSentenceObject(processedString, label_);
     sentences.push_back(sentObj);
@@ -252,7 +302,7 @@ void CountVectorizer::addSentence(string new_sentence, bool label_)
  */
 bool CountVectorizer::ContainsWord(const string& word_to_check)
 {
-    return word_to_idx.count(word_to_check) > 0;
+    return hash_to_idx.count(hashString(word_to_check)) > 0;
 }
 
 /**
@@ -261,18 +311,31 @@ bool CountVectorizer::ContainsWord(const string& word_to_check)
  * @param sentence_words The words of the sentence.
  * @return Vector of feature values.
  */
-std::vector<double> CountVectorizer::getSentenceFeatures(std::vector<std::string> sentence_words) const
+void CountVectorizer::getSentenceFeatures(const TokenList& sentence_words, PredictContext& ctx, FeatureVector& sentence_features) const
 {
-    std::vector<double> sentence_features(word_array.size(), 0.0);
-    for (const std::string& word : sentence_words)
+    sentence_features.assign(word_array.size(), 0.0);
+    forEachFeature(sentence_words, [&](uint64_t hash, const FeatureSpan& span)
     {
-        if (word_to_idx.count(word) > 0)
+        auto it = hash_to_idx.find(hash);
+        if (it != hash_to_idx.end())
         {
-            int idx = word_to_idx.at(word);
-            sentence_features[idx]++;
+            sentence_features[it->second]++;
         }
-    }
-    return sentence_features;
+    });
+}
+
+void CountVectorizer::appendSparseFeatures(std::string_view text, PredictContext& ctx, SparseBatch& batch) const
+{
+    forEachTextFeature(text, [&](uint64_t hash, const FeatureSpan& span)
+    {
+        auto it = hash_to_idx.find(hash);
+        if (it != hash_to_idx.end())
+        {
+            batch.col_idx.push_back(it->second);
+            batch.values.push_back(1.0);
+        }
+    });
+    closeSparseRow(batch, ctx);
 }
 
 std::vector<double> CountVectorizer::getFrequencies(std::unordered_map<int, double> term_freqs) const
@@ -325,6 +388,16 @@ void CountVectorizer::save(std::ofstream& outFile) const
     outFile.write(reinterpret_cast<const char*>(&binary), sizeof(binary));
     outFile.write(reinterpret_cast<const char*>(&case_sensitive), sizeof(case_sensitive));
     outFile.write(reinterpret_cast<const char*>(&include_stopwords), sizeof(include_stopwords));
+
+    saveFeatureConfig(outFile);
+
+    size_t hash_size = hash_to_idx.size();
+    outFile.write(reinterpret_cast<const char*>(&hash_size), sizeof(hash_size));
+    for (const auto& entry : hash_to_idx)
+    {
+        outFile.write(reinterpret_cast<const char*>(&entry.first), sizeof(entry.first));
+        outFile.write(reinterpret_cast<const char*>(&entry.second), sizeof(entry.second));
+    }
 }
 
 /**
@@ -335,21 +408,20 @@ void CountVectorizer::save(std::ofstream& outFile) const
 void CountVectorizer::load(std::ifstream& inFile)
 {
     word_array.clear();
-    word_to_idx.clear();
+    hash_to_idx.clear();
     sentences.clear();
 
     inFile.read(reinterpret_cast<char*>(&vers_info), sizeof(vers_info));
     
-    size_t word_array_size;
+    size_t word_array_size = 0;
     inFile.read(reinterpret_cast<char*>(&word_array_size), sizeof(word_array_size));
     word_array.resize(word_array_size);
-    for (size_t i = 0; i < word_array_size; ++i)
+    for (size_t i = 0; i < word_array_size && inFile; ++i)
     {
-        size_t word_size;
+        size_t word_size = 0;
         inFile.read(reinterpret_cast<char*>(&word_size), sizeof(word_size));
         word_array[i].resize(word_size);
         inFile.read(&word_array[i][0], word_size);
-        word_to_idx[word_array[i]] = i;
     }
 
     /*
@@ -377,4 +449,17 @@ void CountVectorizer::load(std::ifstream& inFile)
     inFile.read(reinterpret_cast<char*>(&binary), sizeof(binary));
     inFile.read(reinterpret_cast<char*>(&case_sensitive), sizeof(case_sensitive));
     inFile.read(reinterpret_cast<char*>(&include_stopwords), sizeof(include_stopwords));
+
+    loadFeatureConfig(inFile);
+
+    size_t hash_size = 0;
+    inFile.read(reinterpret_cast<char*>(&hash_size), sizeof(hash_size));
+    for (size_t i = 0; i < hash_size && inFile; ++i)
+    {
+        uint64_t key;
+        int value;
+        inFile.read(reinterpret_cast<char*>(&key), sizeof(key));
+        inFile.read(reinterpret_cast<char*>(&value), sizeof(value));
+        hash_to_idx[key] = value;
+    }
 }
@@ -24,7 +24,6 @@ Revision History:
 #include <fstream>
 #include <sstream>
 
-#include "GlobalData.h"
 #include "BaseVectorizer.h"
 
 /**
@@ -112,18 +111,26 @@ public:
      * @brief Create a Sentence object from a vector of words.
      *
      * @param new_sentence_vector The vector of words forming the sentence.
-     * @param label_ Boolean label for the sentence.
+     * @param label_ Class index of the sentence.
      * @return Shared pointer to the created Sentence object.
      */
-    shared_ptr<Sentence> createSentenceObject(vector<string> new_sentence_vector, bool label_);
+    shared_ptr<Sentence> createSentenceObject(vector<string> new_sentence_vector, int label_);
+
+    /**
+     * @brief Add a tokenised sentence to the word array and the sentences.
+     *
+     * @param processedString Tokens of the sentence, see buildSentenceVector.
+     * @param label_ Class index of the sentence.
+     */
+    void addSentenceTokens(vector<string> processedString, int label_);
 
     /**
      * @brief Add a sentence to the CountVectorizer.
      *
      * @param new_sentence The new sentence to add.
-     * @param label_ Boolean label for the sentence.
+     * @param label_ Class index of the sentence.
      */
-    void addSentence(string new_sentence, bool label_) override;
+    void addSentence(string new_sentence, int label_) override;
 
     /**
      * @brief Check if the CountVectorizer already contains the word.
@@ -137,9 +144,19 @@ public:
      * @brief Get the feature vector for a given sentence.
      *
      * @param sentence_words The words of the sentence.
-     * @return Vector of feature values.
+     * @param ctx Context providing the scratch memory.
+     * @param sentence_features Receives the feature values.
+     */
+    void getSentenceFeatures(const TokenList& sentence_words, PredictContext& ctx, FeatureVector& sentence_features) const override;
+
+    /**
+     * @brief Append the features of a sentence as a row of a sparse batch.
+     *
+     * @param text The normalised sentence.
+     * @param ctx Context providing the scratch memory.
+     * @param batch Batch to append the row to.
      */
-    std::vector<double> getSentenceFeatures(std::vector<std::string> sentence_words) const override;
+    void appendSparseFeatures(std::string_view text, PredictContext& ctx, SparseBatch& batch) const override;
 
     std::vector<double> getFrequencies(std::unordered_map<int, double> term_freqs) const override;
 
@@ -11,12 +11,14 @@ Revision History:
 #include "DecisionTree.h"
 
 #include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
 
 DecisionTree::DecisionTree(int max_depth)
-    : max_depth(max_depth), root(nullptr)
+    : root(nullptr), max_depth(max_depth), num_classes(2), num_features(0), max_features(0.0), node_count(0)
 {
 }
 
@@ -24,12 +26,28 @@ DecisionTree::~DecisionTree()
 {
 }
 
-void DecisionTree::fit(const std::vector<std::shared_ptr<Sentence>>& sentences)
+void DecisionTree::fit(const std::vector<std::shared_ptr<Sentence>>& sentences, int num_classes_, size_t num_features_, double max_features_, RandomStream rng_)
 {
+    num_classes = std::max(num_classes_, 1);
+    num_features = num_features_;
+    max_features = max_features_;
+    rng = rng_;
+    node_count = 0;
+    feature_slot.assign(num_features, -1);
     root = buildTree(sentences, 0);
+
+    // The scratch is as large as the vocabulary, a fitted tree does not keep it.
+    std::vector<uint32_t>().swap(feature_order);
+    std::vector<uint32_t>().swap(drawn_at);
+    std::vector<int>().swap(feature_slot);
 }
 
-Prediction DecisionTree::predict(const std::vector<double>& features) const
+Prediction DecisionTree::predict(const double* features) const
+{
+    return predictNode(root, features);
+}
+
+Prediction DecisionTree::predict(const SparseRow& features) const
 {
     return predictNode(root, features);
 }
@@ -46,72 +64,158 @@ void DecisionTree::load(std::ifstream& inFile)
 
 std::shared_ptr<DecisionTree::Node> DecisionTree::buildTree(const std::vector<std::shared_ptr<Sentence>>& sentences, int depth)
 {
-    int total_samples, pos_samples;
-    int majority_class = majorityClass(sentences, total_samples, pos_samples);
+    int total_samples, label_samples;
+    int majority_class = majorityClass(sentences, total_samples, label_samples);
 
     if (sentences.empty() || depth >= max_depth)
     {
-        return std::make_shared<Node>(-1, majority_class, total_samples, pos_samples);
+        return std::make_shared<Node>(-1, majority_class, total_samples, label_samples);
+    }
+
+    // A feature sends the sentences that contain it left. Only the features
+    // present at the node can split it, so their left side is counted in one
+    // pass over the sentences rather than by splitting once per feature.
+    bool drawn = drawFeatures();
+    std::vector<int> present;
+    std::vector<size_t> left_sizes;
+    std::vector<int> left_counts;
+    for (const auto& sentence : sentences)
+    {
+        bool labelled = sentence->label >= 0 && sentence->label < num_classes;
+        for (const auto& entry : sentence->sentence_map)
+        {
+            if (entry.first < 0 || static_cast<size_t>(entry.first) >= num_features || (drawn && drawn_at[entry.first] != node_count))
+            {
+                continue;
+            }
+            int& slot = feature_slot[entry.first];
+            if (slot < 0)
+            {
+                slot = static_cast<int>(present.size());
+                present.push_back(entry.first);
+                left_sizes.push_back(0);
+                left_counts.resize(left_counts.size() + num_classes, 0);
+            }
+            left_sizes[slot]++;
+            if (labelled)
+            {
+                left_counts[slot * num_classes + sentence->label]++;
+            }
+        }
     }
 
+    // Features are tried in increasing order, the first of equal splits wins.
+    std::vector<int> totals = classCounts(sentences);
+    std::vector<int> right_counts(num_classes);
+    std::vector<int> slots(present.size());
+    std::iota(slots.begin(), slots.end(), 0);
+    std::sort(slots.begin(), slots.end(), [&](int a, int b) { return present[a] < present[b]; });
+
     double best_gini = 1.0;
     int best_feature = -1;
-    std::vector<std::shared_ptr<Sentence>> best_left, best_right;
-
-    size_t num_features = sentences[0]->sentence_map.size();
-    for (size_t i = 0; i < num_features; ++i)
+    for (int slot : slots)
     {
-        std::vector<std::shared_ptr<Sentence>> left, right;
-        split(sentences, i, left, right);
-
-        if (left.empty() || right.empty())
+        size_t left_size = left_sizes[slot];
+        size_t right_size = sentences.size() - left_size;
+        if (left_size == 0 || right_size == 0)
         {
             continue;
         }
+        for (int c = 0; c < num_classes; ++c)
+        {
+            right_counts[c] = totals[c] - left_counts[slot * num_classes + c];
+        }
 
-        double gini = giniIndex(left, right);
+        double gini = giniIndex(left_counts.data() + slot * num_classes, left_size, right_counts.data(), right_size);
         if (gini < best_gini)
         {
             best_gini = gini;
-            best_feature = i;
-            best_left = left;
-            best_right = right;
+            best_feature = present[slot];
         }
     }
+    for (int feature : present)
+    {
+        feature_slot[feature] = -1;
+    }
 
     if (best_feature == -1)
     {
-        return std::make_shared<Node>(-1, majority_class, total_samples, pos_samples);
+        return std::make_shared<Node>(-1, majority_class, total_samples, label_samples);
     }
 
-    auto node = std::make_shared<Node>(best_feature, -1, total_samples, pos_samples);
+    std::vector<std::shared_ptr<Sentence>> best_left, best_right;
+    split(sentences, best_feature, best_left, best_right);
+
+    auto node = std::make_shared<Node>(best_feature, -1, total_samples, label_samples);
     node->left = buildTree(best_left, depth + 1);
     node->right = buildTree(best_right, depth + 1);
 
     return node;
 }
 
-int DecisionTree::majorityClass(const std::vector<std::shared_ptr<Sentence>>& sentences, int& total_samples, int& pos_samples) const
+bool DecisionTree::drawFeatures()
+{
+    size_t wanted = max_features < 1.0 ? static_cast<size_t>(std::ceil(max_features * num_features)) : static_cast<size_t>(max_features);
+    if (max_features <= 0.0 || wanted >= num_features)
+    {
+        return false;
+    }
+
+    if (feature_order.empty())
+    {
+        feature_order.resize(num_features);
+        std::iota(feature_order.begin(), feature_order.end(), 0);
+        drawn_at.assign(num_features, 0);
+    }
+
+    // Partial Fisher-Yates over all columns. The permutation left by the
+    // previous node is as good a start as the identity.
+    ++node_count;
+    for (size_t k = 0; k < wanted; ++k)
+    {
+        std::swap(feature_order[k], feature_order[k + rng.below(num_features - k)]);
+        drawn_at[feature_order[k]] = node_count;
+    }
+    return true;
+}
+
+std::vector<int> DecisionTree::classCounts(const std::vector<std::shared_ptr<Sentence>>& sentences) const
+{
+    std::vector<int> counts(num_classes, 0);
+    for (const auto& sentence : sentences)
+    {
+        if (sentence->label >= 0 && sentence->label < num_classes)
+        {
+            counts[sentence->label]++;
+        }
+    }
+    return counts;
+}
+
+int DecisionTree::majorityClass(const std::vector<std::shared_ptr<Sentence>>& sentences, int& total_samples, int& label_samples) const
 {
-    pos_samples = std::count_if(sentences.begin(), sentences.end(), [](const std::shared_ptr<Sentence>& s) { return s->label == 1; });
+    std::vector<int> counts = classCounts(sentences);
+    int majority = static_cast<int>(std::max_element(counts.begin(), counts.end()) - counts.begin());
     total_samples = sentences.size();
-    int neg_count = total_samples - pos_samples;
-    return pos_samples > neg_count ? 1 : 0;
+    label_samples = counts[majority];
+    return majority;
 }
 
-double DecisionTree::giniIndex(const std::vector<std::shared_ptr<Sentence>>& left, const std::vector<std::shared_ptr<Sentence>>& right) const
+double DecisionTree::giniIndex(const int* left_counts, size_t left_size, const int* right_counts, size_t right_size) const
 {
-    auto gini = [](const std::vector<std::shared_ptr<Sentence>>& group) {
-        if (group.empty()) return 0.0;
-        int pos_count = std::count_if(group.begin(), group.end(), [](const std::shared_ptr<Sentence>& s) { return s->label == 1; });
-        int neg_count = group.size() - pos_count;
-        double p1 = static_cast<double>(pos_count) / group.size();
-        double p2 = static_cast<double>(neg_count) / group.size();
-        return 1.0 - p1 * p1 - p2 * p2;
+    auto gini = [this](const int* counts, size_t size) {
+        if (size == 0) return 0.0;
+        double impurity = 1.0;
+        for (int c = 0; c < num_classes; ++c)
+        {
+            double p = static_cast<double>(counts[c]) / size;
+            impurity -= p * p;
+        }
+        return impurity;
     };
 
-    double total_size = left.size() + right.size();
-    return (left.size() / total_size) * gini(left) + (right.size() / total_size) * gini(right);
+    double total_size = left_size + right_size;
+    return (left_size / total_size) * gini(left_counts, left_size) + (right_size / total_size) * gini(right_counts, right_size);
 }
 
 void DecisionTree::split(const std::vector<std::shared_ptr<Sentence>>& sentences, int feature_index, std::vector<std::shared_ptr<Sentence>>& left, std::vector<std::shared_ptr<Sentence>>& right) const
@@ -129,28 +233,6 @@ void DecisionTree::split(const std::vector<std::shared_ptr<Sentence>>& sentences
     }
 }
 
-Prediction DecisionTree::predictNode(const std::shared_ptr<Node>& node, const std::vector<double>& features) const
-{
-    if (!node)
-    {
-        throw std::runtime_error("Node is null");
-    }
-    if (node->feature_index == -1)
-    {
-        double probability = static_cast<double>(node->pos_samples) / node->total_samples;
-        return { node->label, probability };
-    }
-
-    if (features[node->feature_index] > 0)
-    {
-        return predictNode(node->left, features);
-    }
-    else
-    {
-        return predictNode(node->right, features);
-    }
-}
-
 void DecisionTree::saveNode(std::ofstream& outFile, const std::shared_ptr<Node>& node) const
 {
     char null_flag;
@@ -168,19 +250,18 @@ void DecisionTree::saveNode(std::ofstream& outFile, const std::shared_ptr<Node>&
     outFile.write(reinterpret_cast<const char*>(&node->feature_index), sizeof(node->feature_index));
     outFile.write(reinterpret_cast<const char*>(&node->label), sizeof(node->label));
     outFile.write(reinterpret_cast<const char*>(&node->total_samples), sizeof(node->total_samples));
-    outFile.write(reinterpret_cast<const char*>(&node->pos_samples), sizeof(node->pos_samples));
+    outFile.write(reinterpret_cast<const char*>(&node->label_samples), sizeof(node->label_samples));
     saveNode(outFile, node->left);
     saveNode(outFile, node->right);
 }
 
 std::shared_ptr<DecisionTree::Node> DecisionTree::loadNode(std::ifstream& inFile)
 {
-    char null_flag;
+    char null_flag = 1;
     int feature_index;
     int label;
     int total_samples;
-    int pos_samples;
-    int dummy;
+    int label_samples;
 
     inFile.read(reinterpret_cast<char*>(&null_flag), sizeof(null_flag));
     inFile.read(reinterpret_cast<char*>(&feature_index), sizeof(feature_index));
@@ -190,9 +271,9 @@ std::shared_ptr<DecisionTree::Node> DecisionTree::loadNode(std::ifstream& inFile
         return std::shared_ptr<Node>(nullptr);
     }
     inFile.read(reinterpret_cast<char*>(&total_samples), sizeof(total_samples));
-    inFile.read(reinterpret_cast<char*>(&pos_samples), sizeof(pos_samples));
+    inFile.read(reinterpret_cast<char*>(&label_samples), sizeof(label_samples));
 
-    auto node = std::make_shared<Node>(feature_index, label, total_samples, pos_samples);
+    auto node = std::make_shared<Node>(feature_index, label, total_samples, label_samples);
     node->left = loadNode(inFile);
     node->right = loadNode(inFile);
     return node;
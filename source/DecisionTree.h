@@ -20,9 +20,11 @@ Revision History:
 #include <memory>
 #include <string>
 #include <fstream>
+#include <stdexcept>
 
 #include "BaseClassifier.h"
 #include "BaseVectorizer.h"
+#include "RandomStream.h"
 
 /**
  * @class DecisionTree
@@ -50,16 +52,28 @@ public:
      * @brief Fit the decision tree on the provided dataset.
      *
      * @param sentences Vector of shared pointers to Sentence objects.
+     * @param num_classes Number of classes, labels are 0 to num_classes - 1.
+     * @param num_features_ Number of feature columns, see BaseVectorizer::getFeatureCount.
+     * @param max_features_ Features tried per node: 0 for all, a share below 1 or a count.
+     * @param rng_ Stream the tried features are drawn from.
      */
-    void fit(const std::vector<std::shared_ptr<Sentence>>& sentences);
+    void fit(const std::vector<std::shared_ptr<Sentence>>& sentences, int num_classes, size_t num_features_, double max_features_ = 0.0, RandomStream rng_ = RandomStream());
 
     /**
      * @brief Predict the class label for the given features.
      *
-     * @param features Vector of feature values.
+     * @param features Dense feature values, indexed by feature_index.
      * @return Prediction object containing the predicted label and probability.
      */
-    Prediction predict(const std::vector<double>& features) const;
+    Prediction predict(const double* features) const;
+
+    /**
+     * @brief Predict the class label for one row of a sparse batch.
+     *
+     * @param features Sparse feature values.
+     * @return Prediction object containing the predicted label and probability.
+     */
+    Prediction predict(const SparseRow& features) const;
 
     /**
      * @brief Save the decision tree model to a file.
@@ -85,7 +99,7 @@ private:
         int feature_index; /**< Index of the feature used for splitting. */
         int label; /**< Predicted label for the node. */
         int total_samples; /**< Total number of samples in the node. */
-        int pos_samples; /**< Number of positive samples in the node. */
+        int label_samples; /**< Number of samples of the node's label in the node. */
         std::shared_ptr<Node> left; /**< Pointer to the left child node. */
         std::shared_ptr<Node> right; /**< Pointer to the right child node. */
 
@@ -95,14 +109,31 @@ private:
          * @param feature_index Index of the feature used for splitting.
          * @param label Predicted label for the node.
          * @param total_samples Total number of samples in the node.
-         * @param pos_samples Number of positive samples in the node.
+         * @param label_samples Number of samples of the label in the node.
          */
-        Node(int feature_index = -1, int label = -1, int total_samples = 0, int pos_samples = 0)
-            : feature_index(feature_index), label(label), total_samples(total_samples), pos_samples(pos_samples) {}
+        Node(int feature_index = -1, int label = -1, int total_samples = 0, int label_samples = 0)
+            : feature_index(feature_index), label(label), total_samples(total_samples), label_samples(label_samples) {}
     };
 
     std::shared_ptr<Node> root; /**< Pointer to the root node of the decision tree. */
     int max_depth; /**< Maximum depth of the decision tree. */
+    int num_classes; /**< Number of classes seen by fit. */
+    size_t num_features; /**< Feature columns a node may split on, only used by fit. */
+    double max_features; /**< Features tried per node, only used by fit. */
+    RandomStream rng; /**< Draws the features tried per node, only used by fit. */
+    std::vector<uint32_t> feature_order; /**< Permutation of the columns the draws are taken from, only used by fit. */
+    std::vector<uint32_t> drawn_at; /**< Number of the node that last drew each column, only used by fit. */
+    std::vector<int> feature_slot; /**< Slot of each column in the counts of the current node, -1 if none. */
+    uint32_t node_count; /**< Nodes split so far by fit. */
+
+    /**
+     * @brief Draw the features the next node tries to split on.
+     *
+     * The columns drawn are marked with the number of the node in drawn_at.
+     *
+     * @return False if every feature is tried.
+     */
+    bool drawFeatures();
 
     /**
      * @brief Build the decision tree recursively.
@@ -116,21 +147,33 @@ private:
     /**
      * @brief Determine the majority class in the dataset.
      *
+     * Ties go to the lower class index.
+     *
      * @param sentences Vector of shared pointers to Sentence objects.
      * @param total_samples Total number of samples.
-     * @param pos_samples Number of positive samples.
+     * @param label_samples Number of samples of the majority class.
      * @return Majority class label.
      */
-    int majorityClass(const std::vector<std::shared_ptr<Sentence>>& sentences, int& total_samples, int& pos_samples) const;
+    int majorityClass(const std::vector<std::shared_ptr<Sentence>>& sentences, int& total_samples, int& label_samples) const;
+
+    /**
+     * @brief Count the samples of every class.
+     *
+     * @param sentences Vector of shared pointers to Sentence objects.
+     * @return Number of samples per class.
+     */
+    std::vector<int> classCounts(const std::vector<std::shared_ptr<Sentence>>& sentences) const;
 
     /**
      * @brief Calculate the Gini index for a split.
      *
-     * @param left Vector of shared pointers to Sentence objects on the left side of the split.
-     * @param right Vector of shared pointers to Sentence objects on the right side of the split.
+     * @param left_counts Samples of every class on the left side of the split.
+     * @param left_size Samples on the left side, including those without a valid label.
+     * @param right_counts Samples of every class on the right side of the split.
+     * @param right_size Samples on the right side, including those without a valid label.
      * @return Gini index value.
      */
-    double giniIndex(const std::vector<std::shared_ptr<Sentence>>& left, const std::vector<std::shared_ptr<Sentence>>& right) const;
+    double giniIndex(const int* left_counts, size_t left_size, const int* right_counts, size_t right_size) const;
 
     /**
      * @brief Split the dataset based on a feature.
@@ -146,10 +189,11 @@ private:
      * @brief Predict the class label for a given set of features at a node.
      *
      *  * @param node Pointer to the current node in the decision tree.
-     * @param features Vector of feature values.
+     * @param features Feature values, anything indexable by feature_index.
      * @return Prediction object containing the predicted label and probability.
      */
-    Prediction predictNode(const std::shared_ptr<Node>& node, const std::vector<double>& features) const;
+    template <typename Features>
+    Prediction predictNode(const std::shared_ptr<Node>& node, const Features& features) const;
 
     /**
      * @brief Save a node of the decision tree to a file recursively.
@@ -168,4 +212,28 @@ private:
     std::shared_ptr<Node> loadNode(std::ifstream& inFile);
 };
 
+template <typename Features>
+Prediction DecisionTree::predictNode(const std::shared_ptr<Node>& node, const Features& features) const
+{
+    if (!node)
+    {
+        throw std::runtime_error("Node is null");
+    }
+    if (node->feature_index == -1)
+    {
+        double probability = static_cast<double>(node->label_samples) / node->total_samples;
+        return { node->label, probability };
+    }
+
+    // Rows with the feature go left, as in split(); hashed values can be negative.
+    if (features[node->feature_index] != 0.0)
+    {
+        return predictNode(node->left, features);
+    }
+    else
+    {
+        return predictNode(node->right, features);
+    }
+}
+
 #endif // DECISIONTREE_H__
@@ -0,0 +1,231 @@
+/**
+ * @file Evaluation.cpp
+ * @brief Implementation of the Evaluation class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "Evaluation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <string>
+
+Evaluation::Evaluation(int num_classes_)
+    : num_classes(std::max(num_classes_, 0)), total(0), correct(0), unknown(0), log_loss_sum(0.0)
+{
+    matrix.assign(static_cast<size_t>(num_classes) * num_classes, 0);
+    if (num_classes == 2)
+    {
+        auc_bins.assign(2 * EVALUATION_AUC_BINS, 0);
+    }
+}
+
+void Evaluation::add(int truth, int label, double probability)
+{
+    total++;
+    if (truth < 0 || truth >= num_classes || label < 0 || label >= num_classes)
+    {
+        unknown += truth < 0 || truth >= num_classes;
+        return;
+    }
+    correct += truth == label;
+    matrix[static_cast<size_t>(truth) * num_classes + label]++;
+
+    if (num_classes != 2)
+    {
+        return;
+    }
+    // With two classes the probability of the predicted label fixes both.
+    double p = std::clamp(probability, EVALUATION_PROBABILITY_EPS, 1.0 - EVALUATION_PROBABILITY_EPS);
+    double p_true = truth == label ? p : 1.0 - p;
+    log_loss_sum -= std::log(p_true);
+
+    double p_positive = label == 1 ? p : 1.0 - p;
+    double logit = std::clamp(std::log(p_positive / (1.0 - p_positive)), -EVALUATION_AUC_LOGIT_RANGE, EVALUATION_AUC_LOGIT_RANGE);
+    int bin = static_cast<int>((logit + EVALUATION_AUC_LOGIT_RANGE) / (2.0 * EVALUATION_AUC_LOGIT_RANGE) * EVALUATION_AUC_BINS);
+    auc_bins[truth * EVALUATION_AUC_BINS + std::min(bin, EVALUATION_AUC_BINS - 1)]++;
+}
+
+void Evaluation::merge(const Evaluation& other)
+{
+    if (other.num_classes != num_classes)
+    {
+        return;
+    }
+    total += other.total;
+    correct += other.correct;
+    unknown += other.unknown;
+    log_loss_sum += other.log_loss_sum;
+    for (size_t i = 0; i < matrix.size(); ++i)
+    {
+        matrix[i] += other.matrix[i];
+    }
+    for (size_t i = 0; i < auc_bins.size(); ++i)
+    {
+        auc_bins[i] += other.auc_bins[i];
+    }
+}
+
+double Evaluation::accuracy() const
+{
+    return total ? static_cast<double>(correct) / total : 0.0;
+}
+
+size_t Evaluation::support(int c) const
+{
+    size_t n = 0;
+    for (int label = 0; label < num_classes; ++label)
+    {
+        n += confusion(c, label);
+    }
+    return n;
+}
+
+double Evaluation::precision(int c) const
+{
+    size_t predicted = 0;
+    for (int truth = 0; truth < num_classes; ++truth)
+    {
+        predicted += confusion(truth, c);
+    }
+    return predicted ? static_cast<double>(confusion(c, c)) / predicted : 0.0;
+}
+
+double Evaluation::recall(int c) const
+{
+    size_t n = support(c);
+    return n ? static_cast<double>(confusion(c, c)) / n : 0.0;
+}
+
+double Evaluation::f1(int c) const
+{
+    double p = precision(c);
+    double r = recall(c);
+    return p + r > 0.0 ? 2.0 * p * r / (p + r) : 0.0;
+}
+
+double Evaluation::macroF1() const
+{
+    double sum = 0.0;
+    for (int c = 0; c < num_classes; ++c)
+    {
+        sum += f1(c);
+    }
+    return num_classes ? sum / num_classes : 0.0;
+}
+
+double Evaluation::weightedF1() const
+{
+    double sum = 0.0;
+    size_t n = 0;
+    for (int c = 0; c < num_classes; ++c)
+    {
+        sum += f1(c) * support(c);
+        n += support(c);
+    }
+    return n ? sum / n : 0.0;
+}
+
+double Evaluation::rocAuc() const
+{
+    if (num_classes != 2)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    // Probability that a positive scores above a negative, ties count half.
+    const uint64_t* negatives = auc_bins.data();
+    const uint64_t* positives = auc_bins.data() + EVALUATION_AUC_BINS;
+    double pairs = 0.0;
+    double negatives_below = 0.0;
+    for (int b = 0; b < EVALUATION_AUC_BINS; ++b)
+    {
+        pairs += positives[b] * (negatives_below + 0.5 * negatives[b]);
+        negatives_below += negatives[b];
+    }
+    double num_positive = static_cast<double>(support(1));
+    double num_negative = static_cast<double>(support(0));
+    if (num_positive == 0.0 || num_negative == 0.0)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return pairs / (num_positive * num_negative);
+}
+
+double Evaluation::logLoss() const
+{
+    size_t known = total - unknown;
+    if (num_classes != 2 || known == 0)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return log_loss_sum / known;
+}
+
+void Evaluation::print(std::ostream& out, const LabelDictionary& labels) const
+{
+    auto metric = [&out](double value)
+    {
+        if (std::isnan(value))
+        {
+            out << "n/a";
+        }
+        else
+        {
+            out << std::fixed << std::setprecision(4) << value;
+        }
+        out << std::endl;
+    };
+
+    out << "Sentences: " << total << std::endl;
+    if (unknown)
+    {
+        out << "Labels unknown to the model: " << unknown << std::endl;
+    }
+    out << "Accuracy: ";
+    metric(accuracy());
+    out << "Macro F1: ";
+    metric(macroF1());
+    out << "Weighted F1: ";
+    metric(weightedF1());
+    out << "ROC-AUC: ";
+    metric(rocAuc());
+    out << "Log-loss: ";
+    metric(logLoss());
+
+    out << std::endl << std::left << std::setw(16) << "Class" << std::setw(11) << "Precision" << std::setw(9) << "Recall"
+        << std::setw(9) << "F1" << "Support" << std::endl;
+    for (int c = 0; c < num_classes; ++c)
+    {
+        out << std::left << std::setw(16) << labels.name(c) << std::fixed << std::setprecision(4)
+            << std::setw(11) << precision(c) << std::setw(9) << recall(c) << std::setw(9) << f1(c) << support(c) << std::endl;
+    }
+
+    if (num_classes > 0 && num_classes <= EVALUATION_MAX_MATRIX_CLASSES)
+    {
+        out << std::endl << "Confusion matrix (rows true, columns predicted):" << std::endl << std::setw(16) << "";
+        for (int label = 0; label < num_classes; ++label)
+        {
+            out << std::setw(10) << labels.name(label).substr(0, 9);
+        }
+        out << std::endl;
+        for (int truth = 0; truth < num_classes; ++truth)
+        {
+            out << std::setw(16) << labels.name(truth);
+            for (int label = 0; label < num_classes; ++label)
+            {
+                out << std::setw(10) << confusion(truth, label);
+            }
+            out << std::endl;
+        }
+    }
+    out << std::right << std::defaultfloat << std::setprecision(6);
+}
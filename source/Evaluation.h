@@ -0,0 +1,161 @@
+/**
+ * @file Evaluation.h
+ * @brief Streaming classification metrics: accuracy, precision/recall/F1, ROC-AUC and log-loss.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef EVALUATION_H__
+#define EVALUATION_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "LabelDictionary.h"
+
+#define EVALUATION_AUC_BINS             4096    /**< Histogram bins per class for ROC-AUC. */
+#define EVALUATION_AUC_LOGIT_RANGE      20.0    /**< Scores are binned by their logit, clamped to +/- this. */
+#define EVALUATION_PROBABILITY_EPS      1e-15   /**< Probabilities are clipped to [eps, 1 - eps] for logits and log-loss. */
+#define EVALUATION_MAX_MATRIX_CLASSES   20      /**< Larger confusion matrices are not printed. */
+
+/**
+ * @class Evaluation
+ * @brief Metrics of a classifier, accumulated one prediction at a time.
+ *
+ * Nothing per prediction is stored: a confusion matrix gives accuracy and
+ * the per-class precision, recall and F1, a running sum gives log-loss, and
+ * two histograms of scores, one for each true class, give ROC-AUC. The
+ * histograms have EVALUATION_AUC_BINS bins over the logit of the score, so
+ * ROC-AUC is exact up to scores in the same bin, which count as ties.
+ *
+ * A Prediction only carries the probability of the predicted label. With two
+ * classes that fixes the other one, so ROC-AUC (class 1 positive) and
+ * log-loss are available for binary models only and are NaN otherwise.
+ *
+ * Evaluations of parts of a data set can be merged.
+ */
+class Evaluation
+{
+public:
+    /**
+     * @brief Start an empty evaluation.
+     *
+     * @param num_classes_ Number of classes of the model.
+     */
+    explicit Evaluation(int num_classes_ = 0);
+
+    /**
+     * @brief Count one prediction.
+     *
+     * @param truth Class index of the true label, -1 if the model does not know it.
+     * @param label Predicted class index.
+     * @param probability Probability of the predicted label.
+     */
+    void add(int truth, int label, double probability);
+
+    /**
+     * @brief Add the counts of another evaluation with the same classes.
+     *
+     * @param other Evaluation to add.
+     */
+    void merge(const Evaluation& other);
+
+    /**
+     * @brief Number of predictions counted.
+     */
+    size_t count() const { return total; }
+
+    /**
+     * @brief Number of predictions whose true label the model does not know.
+     */
+    size_t unknownLabels() const { return unknown; }
+
+    /**
+     * @brief Number of classes.
+     */
+    int classes() const { return num_classes; }
+
+    /**
+     * @brief Share of correct predictions, unknown labels count as wrong.
+     */
+    double accuracy() const;
+
+    /**
+     * @brief Number of predictions of a class for a true class.
+     *
+     * @param truth True class index.
+     * @param label Predicted class index.
+     */
+    size_t confusion(int truth, int label) const { return matrix[static_cast<size_t>(truth) * num_classes + label]; }
+
+    /**
+     * @brief Number of predictions whose true label is a class.
+     */
+    size_t support(int c) const;
+
+    /**
+     * @brief Share of the predictions of a class that are right, 0 if it was never predicted.
+     */
+    double precision(int c) const;
+
+    /**
+     * @brief Share of the sentences of a class that are found, 0 if it has none.
+     */
+    double recall(int c) const;
+
+    /**
+     * @brief Harmonic mean of precision and recall of a class.
+     */
+    double f1(int c) const;
+
+    /**
+     * @brief Mean F1 over the classes.
+     */
+    double macroF1() const;
+
+    /**
+     * @brief Mean F1 over the classes, weighted by their support.
+     */
+    double weightedF1() const;
+
+    /**
+     * @brief Area under the ROC curve of class 1 against class 0.
+     *
+     * @return NaN unless the model has two classes and both occur.
+     */
+    double rocAuc() const;
+
+    /**
+     * @brief Mean negative log probability of the true labels.
+     *
+     * @return NaN unless the model has two classes.
+     */
+    double logLoss() const;
+
+    /**
+     * @brief Print every metric and, for up to EVALUATION_MAX_MATRIX_CLASSES classes, the confusion matrix.
+     *
+     * @param out Stream to print to.
+     * @param labels Names of the classes.
+     */
+    void print(std::ostream& out, const LabelDictionary& labels) const;
+
+private:
+    int num_classes; /**< Number of classes. */
+    size_t total; /**< Predictions counted. */
+    size_t correct; /**< Predictions of the true label. */
+    size_t unknown; /**< Predictions whose true label is unknown. */
+    std::vector<size_t> matrix; /**< Confusion matrix, true class x predicted class. */
+    std::vector<uint64_t> auc_bins; /**< Score histograms of true class 0 and 1, binary models only. */
+    double log_loss_sum; /**< Sum of -log(p(true label)), binary models only. */
+};
+
+#endif // EVALUATION_H__
@@ -0,0 +1,117 @@
+/**
+ * @file FeatureHash.h
+ * @brief Non-cryptographic hash helpers used to map tokens to feature indices.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef FEATUREHASH_H__
+#define FEATUREHASH_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#define FEATUREHASH_FNV_OFFSET      0xcbf29ce484222325ULL
+#define FEATUREHASH_FNV_PRIME       0x100000001b3ULL
+#define FEATUREHASH_ROLL_TOKEN      0x9e3779b97f4a7c15ULL  /**< Base of the rolling hash over token hashes. */
+#define FEATUREHASH_ROLL_CHAR       0x100000001b3ULL       /**< Base of the rolling hash over bytes. */
+#define FEATUREHASH_SALT_WORD       0x2545f4914f6cdd1dULL
+#define FEATUREHASH_SALT_CHAR       0x5851f42d4c957f2dULL
+
+/**
+ * @brief Finalisation step of MurmurHash3 (fmix64).
+ *
+ * FNV-1a alone leaves the low bits poorly mixed for short keys, which matters
+ * because feature indices are taken from the low bits of the hash.
+ *
+ * @param h Hash value to mix.
+ * @return Mixed hash value.
+ */
+inline uint64_t mixHash(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * @brief Hash a byte range with FNV-1a followed by fmix64.
+ *
+ * @param data Pointer to the first byte.
+ * @param len Number of bytes.
+ * @return 64-bit hash of the bytes.
+ */
+inline uint64_t hashBytes(const char* data, size_t len)
+{
+    uint64_t h = FEATUREHASH_FNV_OFFSET;
+    for (size_t i = 0; i < len; ++i)
+    {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= FEATUREHASH_FNV_PRIME;
+    }
+    return mixHash(h);
+}
+
+/**
+ * @brief Hash a string with FNV-1a followed by fmix64.
+ *
+ * @param s String to hash.
+ * @return 64-bit hash of the string.
+ */
+inline uint64_t hashString(const std::string& s)
+{
+    return hashBytes(s.data(), s.size());
+}
+
+/**
+ * @brief Integer power with wrap-around, used for the leading term of a rolling hash.
+ *
+ * @param base Base of the rolling hash.
+ * @param n Exponent.
+ * @return base^n modulo 2^64.
+ */
+inline uint64_t rollingPower(uint64_t base, int n)
+{
+    uint64_t p = 1;
+    for (int i = 0; i < n; ++i)
+    {
+        p *= base;
+    }
+    return p;
+}
+
+/**
+ * @brief Final hash of a word n-gram from its rolling hash.
+ *
+ * @param rolling Rolling hash of the last n token hashes.
+ * @param n Number of tokens in the n-gram.
+ * @return 64-bit hash of the word n-gram.
+ */
+inline uint64_t wordNgramHash(uint64_t rolling, int n)
+{
+    return mixHash(rolling ^ (FEATUREHASH_SALT_WORD * static_cast<uint64_t>(n)));
+}
+
+/**
+ * @brief Final hash of a character n-gram from its rolling hash.
+ *
+ * @param rolling Rolling hash of the last n bytes.
+ * @param n Number of bytes in the n-gram.
+ * @return 64-bit hash of the character n-gram.
+ */
+inline uint64_t charNgramHash(uint64_t rolling, int n)
+{
+    return mixHash(rolling ^ (FEATUREHASH_SALT_CHAR * static_cast<uint64_t>(n)));
+}
+
+#endif // FEATUREHASH_H__
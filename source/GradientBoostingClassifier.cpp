@@ -12,31 +12,26 @@ Revision History:
 
 #include <fstream>
 #include <iostream>
+#include <cmath>
+#include <algorithm>
 
-GradientBoostingClassifier::GradientBoostingClassifier(BaseVectorizer* pvec)
+#include "ThreadPool.h"
+
+GradientBoostingClassifier::GradientBoostingClassifier(std::shared_ptr<BaseVectorizer> pvec)
 {
 	pVec = pvec;
+	n_trees = 50;
+	max_depth = 5;
+	learning_rate = 0.01;
 }
 
 GradientBoostingClassifier::~GradientBoostingClassifier()
 {
-    delete pVec;
-}
-
-double GradientBoostingClassifier::predict_tree(const DecisionTree& tree, const std::vector<double>& features) const
-{
-    return tree.predict(features).label;
 }
 
-double GradientBoostingClassifier::predict_proba(const std::vector<double>& features) const
+int GradientBoostingClassifier::classCount() const
 {
-    double score = 0.0;
-    for (size_t i = 0; i < trees.size(); ++i)
-    {
-        double tree_prediction = predict_tree(*trees[i], features);
-        score += learning_rate * tree_prediction;
-    }
-    return 1.0 / (1.0 + exp(-score));
+    return std::max(pVec->getClassLabels().size(), 1);
 }
 
 void GradientBoostingClassifier::setHyperparameters(std::string hyperparameters)
@@ -54,11 +49,12 @@ void GradientBoostingClassifier::setHyperparameters(std::string hyperparameters)
         std::string key;
         double value;
 
+        if (pVec->setOption(token)) {
+            continue;
+        }
         if (std::getline(pairStream, key, '=') && pairStream >> value) {
             cout << key << " = " << value << endl;
-            if (key == "minfrequency") {
-                minfrequency = value;
-            }
+            pVec->setHyperparameter(key, value);
             if (key == "n_trees") {
                 n_trees = value;
             }
@@ -74,121 +70,61 @@ void GradientBoostingClassifier::setHyperparameters(std::string hyperparameters)
 
 void GradientBoostingClassifier::fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels)
 {
-    if (minfrequency > 0)
-    {
-        pVec->scanForSparseHistogram(abs_filepath_to_features, minfrequency);
-    }
     pVec->fit(abs_filepath_to_features, abs_filepath_to_labels);
+    fitSentences(pVec->sentences);
+}
 
-    size_t num_features = pVec->word_array.size();
+void GradientBoostingClassifier::fitSentences(const std::vector<std::shared_ptr<Sentence>>& sentences)
+{
+    // The trees are independent, each is grown by whichever thread takes it.
     trees.clear();
-
-    std::vector<std::shared_ptr<Sentence>> sentences = pVec->sentences;
-    std::vector<double> labels(sentences.size());
-
-    std::ifstream label_file(abs_filepath_to_labels);
-    std::string label;
-    for (size_t i = 0; i < labels.size(); ++i)
-    {
-        label_file >> labels[i];
-    }
-    label_file.close();
-
-    std::vector<double> residuals(labels.size());
-
-    for (int i = 0; i < n_trees; ++i)
+    trees.resize(std::max(n_trees, 0));
+    ThreadPool::shared().parallelFor(trees.size(), 1, [&](size_t begin, size_t end)
     {
-        for (size_t j = 0; j < sentences.size(); ++j)
+        for (size_t i = begin; i < end; ++i)
         {
-            std::vector<double> features;
-            const auto& sentence_map = sentences[j]->sentence_map;
-            features = pVec->getFrequencies(sentence_map);
-            double y_true = labels[j];
-            double y_pred = predict_proba(features);
-            residuals[j] = y_true - y_pred;
+            auto tree = std::make_unique<DecisionTree>(max_depth);
+            tree->fit(sentences, classCount(), pVec->getFeatureCount());
+            trees[i] = std::move(tree);
         }
-
-        auto tree = std::make_unique<DecisionTree>(max_depth);
-        tree->fit(sentences);
-        trees.push_back(std::move(tree));
-    }
+    });
 }
 
-Prediction GradientBoostingClassifier::predict(std::string sentence, bool preprocess)
+Prediction GradientBoostingClassifier::predictFeatures(const FeatureVector& features, PredictContext& ctx) const
 {
-    GlobalData vars;
-    Prediction result;
-    std::vector<std::string> processed_input = pVec->buildSentenceVector(sentence, preprocess);
-    std::vector<double> feature_vector = pVec->getSentenceFeatures(processed_input);
-    double probability = predict_proba(feature_vector);
-
-    result.probability = probability;
-
-    if (probability > 0.5)
-    {
-        result.label = vars.POS;
-    }
-    else
+    int num_classes = classCount();
+    FeatureVector scores(num_classes, 0.0, ctx.resource());
+    for (const auto& tree : trees)
     {
-        result.label = vars.NEG;
+        scores[tree->predict(features.data()).label] += learning_rate;
     }
 
-    return result;
+    return softmax(scores.data(), num_classes);
 }
 
-void GradientBoostingClassifier::predict(std::string abs_filepath_to_features, std::string abs_filepath_to_labels, bool preprocess)
+void GradientBoostingClassifier::predictSparseBatch(const SparseBatch& batch, std::span<Prediction> results, PredictContext& ctx) const
 {
-    std::ifstream in(abs_filepath_to_features);
-    std::ofstream out(abs_filepath_to_labels);
-    std::string feature_input;
+    int num_classes = classCount();
+    FeatureVector scores(TREE_BLOCK_ROWS * num_classes, ctx.resource());
 
-    if (!in)
+    // Every tree is walked by a whole block of rows while its nodes are in cache.
+    for (size_t begin = 0; begin < batch.rows(); begin += TREE_BLOCK_ROWS)
     {
-        std::cerr << "ERROR: Cannot open features file.\n";
-        return;
-    }
-
-    if (!out)
-    {
-        std::cerr << "ERROR: Cannot open labels file.\n";
-        return;
-    }
-
-    #ifdef BENCHMARK
-    double sumduration = 0.0;
-    double sumstrlen = 0.0;
-    size_t num_rows = 0;
-    #endif
+        size_t end = std::min(begin + TREE_BLOCK_ROWS, batch.rows());
+        std::fill(scores.begin(), scores.end(), 0.0);
 
-    while (getline(in, feature_input))
-    {
-        #ifdef BENCHMARK
-        auto start = std::chrono::high_resolution_clock::now();
-        #endif
-
-        Prediction result = predict(feature_input, preprocess);
-
-        #ifdef BENCHMARK
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> duration = end - start;
-        double milliseconds = duration.count();
-        sumduration += milliseconds;
-        sumstrlen += feature_input.length();
-        num_rows++;
-        #endif
-
-        out << result.label << "," << result.probability << std::endl;
+        for (const auto& tree : trees)
+        {
+            for (size_t r = begin; r < end; ++r)
+            {
+                scores[(r - begin) * num_classes + tree->predict(batch.row(r)).label] += learning_rate;
+            }
+        }
+        for (size_t r = begin; r < end; ++r)
+        {
+            results[r] = softmax(scores.data() + (r - begin) * num_classes, num_classes);
+        }
     }
-
-    #ifdef BENCHMARK
-    double avgduration = sumduration / num_rows;
-    cout << "Average Time per Text = " << avgduration << " ms" << endl;
-    double avgstrlen = sumstrlen / num_rows;
-    cout << "Average Length of Text (chars) = " << avgstrlen << endl;
-    #endif
-
-    in.close();
-    out.close();
 }
 
 void GradientBoostingClassifier::save(const std::string& filename) const
@@ -223,15 +159,16 @@ void GradientBoostingClassifier::load(const std::string& filename)
     if (!inFile.is_open())
     {
         std::cerr << "Failed to open file for reading." << std::endl;
+        loaded = false;
         return;
     }
 
     pVec->load(inFile);
 
-    size_t tree_count;
+    size_t tree_count = 0;
     inFile.read(reinterpret_cast<char*>(&tree_count), sizeof(tree_count));
     trees.resize(tree_count);
-    for (size_t i = 0; i < tree_count; ++i)
+    for (size_t i = 0; i < tree_count && inFile; ++i)
     {
         auto tree = std::make_unique<DecisionTree>(max_depth);
         tree->load(inFile);
@@ -242,5 +179,6 @@ void GradientBoostingClassifier::load(const std::string& filename)
     inFile.read(reinterpret_cast<char*>(&max_depth), sizeof(max_depth));
     inFile.read(reinterpret_cast<char*>(&learning_rate), sizeof(learning_rate));
     
+    loaded = !inFile.fail();
     inFile.close();
 }
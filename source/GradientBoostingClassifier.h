@@ -29,15 +29,18 @@ Revision History:
  * an ensemble of decision trees for classification tasks. It builds a strong
  * learner by sequentially adding weak learners (decision trees) and fitting
  * them to the residual errors of the previous predictions.
+ *
+ * Every class scores the learning rate for each tree that predicts it, and
+ * the softmax of the class scores gives the probability of the winner.
  */
 class GradientBoostingClassifier : public BaseClassifier
 {
 public:
     /**
      * @brief Constructor for GradientBoostingClassifier.
-     * @param pvec Pointer to a BaseVectorizer object for feature extraction.
+     * @param pvec Vectorizer for feature extraction, shared with the caller.
      */
-    GradientBoostingClassifier(BaseVectorizer* pvec);
+    GradientBoostingClassifier(std::shared_ptr<BaseVectorizer> pvec);
     ~GradientBoostingClassifier();
     
     /**
@@ -54,18 +57,10 @@ public:
     void fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels) override;
 
     /**
-     * @brief Predict labels for test data.
-     * @param abs_filepath_to_features Absolute file path to the file containing features.
-     * @param abs_filepath_to_labels Absolute file path to the file to save predicted labels.
-     */
-    void predict(std::string abs_filepath_to_features, std::string abs_filepath_to_labels, bool preprocess = true) override;
-
-    /**
-     * @brief Predict label for a single input sentence.
-     * @param sentence Input sentence to predict label for.
-     * @return Prediction object containing predicted label.
+     * @brief Train on sentences vectorised by pVec, see BaseClassifier::fitSentences.
+     * @param sentences Training sentences.
      */
-    Prediction predict(std::string sentence, bool preprocess = true) override;
+    void fitSentences(const std::vector<std::shared_ptr<Sentence>>& sentences) override;
 
     /**
      * @brief Save the model to a file.
@@ -79,6 +74,23 @@ public:
      */
     void load(const std::string& filename) override;
 
+protected:
+    /**
+     * @brief Score a feature vector with the boosted trees.
+     * @param features Feature vector of the sentence.
+     * @param ctx Context providing the scratch memory.
+     * @return Prediction object containing predicted label.
+     */
+    Prediction predictFeatures(const FeatureVector& features, PredictContext& ctx) const override;
+
+    /**
+     * @brief Score a batch, sending blocks of rows down one tree at a time.
+     * @param batch Feature vectors of the batch.
+     * @param results Receives one Prediction per row.
+     * @param ctx Context providing the scratch memory.
+     */
+    void predictSparseBatch(const SparseBatch& batch, std::span<Prediction> results, PredictContext& ctx) const override;
+
 private:
     std::vector<std::unique_ptr<DecisionTree>> trees; /**< Vector of decision trees. */
     int n_trees; /**< Number of trees in the ensemble. */
@@ -86,19 +98,10 @@ private:
     double learning_rate; /**< Learning rate for gradient boosting. */
 
     /**
-     * @brief Predict using a single decision tree.
-     * @param tree Decision tree to make predictions.
-     * @param features Input features for prediction.
-     * @return Predicted value.
-     */
-    double predict_tree(const DecisionTree& tree, const std::vector<double>& features) const;
-
-    /**
-     * @brief Predict class probabilities for input features.
-     * @param features Input features for prediction.
-     * @return Predicted class probabilities.
+     * @brief Number of classes the trees vote for.
+     * @return Number of labels of the vectorizer, at least 1.
      */
-    double predict_proba(const std::vector<double>& features) const;
+    int classCount() const;
 };
 
 #endif // GRADIENTBOOSTINGCLASSIFIER_H__
@@ -0,0 +1,383 @@
+/**
+ * @file HashingVectorizer.cpp
+ * @brief Implementation of the HashingVectorizer class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "HashingVectorizer.h"
+
+using namespace std;
+
+/**
+ * @brief Default constructor.
+ *
+ * Defaults to binary=false, case_sensitive=true and include_stopwords=true.
+ */
+HashingVectorizer::HashingVectorizer()
+{
+    binary = false;
+    case_sensitive = true;
+    include_stopwords = true;
+    hash_bits = HASHINGVECTORIZER_DEFAULT_BITS;
+    alternate_sign = true;
+    this_vectorizer_id = ID_VECTORIZER_HASHING;
+}
+
+/**
+ * @brief Constructor with options.
+ *
+ * @param binary_ Boolean flag indicating if binary vectors are used.
+ * @param case_sensitive_ Boolean flag indicating if case sensitivity is considered.
+ * @param include_stopwords_ Boolean flag indicating if stop words are included.
+ */
+HashingVectorizer::HashingVectorizer(bool binary_, bool case_sensitive_, bool include_stopwords_)
+{
+    binary = binary_;
+    case_sensitive = case_sensitive_;
+    include_stopwords = include_stopwords_;
+    hash_bits = HASHINGVECTORIZER_DEFAULT_BITS;
+    alternate_sign = true;
+    this_vectorizer_id = ID_VECTORIZER_HASHING;
+}
+
+/**
+ * @brief Destructor.
+ */
+HashingVectorizer::~HashingVectorizer()
+{
+}
+
+/**
+ * @brief Fit the vectorizer on the given dataset.
+ *
+ * @param abs_filepath_to_features Absolute file path to the features file.
+ * @param abs_filepath_to_labels Absolute file path to the labels file.
+ */
+void HashingVectorizer::fit(string abs_filepath_to_features, string abs_filepath_to_labels)
+{
+    if (isCorpusFile(abs_filepath_to_features))
+    {
+        loadCorpus(abs_filepath_to_features);
+        return;
+    }
+
+    LineReader features_in;
+    LineReader labels_in;
+    string_view feature_output;
+    string_view label_output;
+
+    if (!features_in.open(abs_filepath_to_features))
+    {
+        cout << "ERROR: Cannot open features file.\n";
+        return;
+    }
+
+    if (!labels_in.open(abs_filepath_to_labels))
+    {
+        cout << "ERROR: Cannot open labels file.\n";
+        return;
+    }
+
+    cout << "Fitting HashingVectorizer..." << endl;
+
+    // No vocabulary to build, so features and labels are consumed in lockstep,
+    // a block of sentences at a time that is tokenised in parallel. A mapped
+    // file is tokenised in place, lines read from a pipe are copied because
+    // the next read may overwrite them.
+    vector<string> lines(FIT_BLOCK_SENTENCES);
+    vector<string_view> features(FIT_BLOCK_SENTENCES);
+    vector<int> labels(FIT_BLOCK_SENTENCES);
+    bool mismatch = false;
+    while (!mismatch)
+    {
+        size_t n = 0;
+        while (n < FIT_BLOCK_SENTENCES && features_in.next(feature_output))
+        {
+            if (!labels_in.next(label_output))
+            {
+                cout << "ERROR: Feature dimension is different from label dimension\n";
+                mismatch = true;
+                break;
+            }
+            features[n] = features_in.isMapped() ? feature_output : string_view(lines[n].assign(feature_output));
+            labels[n] = class_labels.add(label_output);
+            n++;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+
+        vector<vector<string>> tokens = buildSentenceVectors(std::span<const string_view>(features.data(), n));
+        for (size_t i = 0; i < n; ++i)
+        {
+            sentences.push_back(createSentenceObject(std::move(tokens[i]), labels[i]));
+        }
+    }
+
+    features_in.close();
+    labels_in.close();
+
+    sortLabels();
+}
+
+/**
+ * @brief Print the dimensions of the HashingVectorizer object.
+ */
+void HashingVectorizer::shape()
+{
+    cout << "------------------------------" << endl;
+    cout << "Current HashingVectorizer Shape:" << endl;
+    cout << "Hashed feature columns: 2^" << hash_bits << " = " << to_string(getFeatureCount()) << endl;
+    cout << "Documents in corpus: " << to_string(getSentenceCount()) << endl;
+    cout << "------------------------------" << endl;
+}
+
+/**
+ * @brief Print the document frequency of the first 10 non-empty columns.
+ */
+void HashingVectorizer::head()
+{
+    unordered_map<int, int> doc_freqs;
+    for (const auto& sentence : sentences)
+    {
+        for (const auto& entry : sentence->sentence_map)
+        {
+            doc_freqs[entry.first]++;
+        }
+    }
+
+    int printed = 0;
+    cout << "------------------------------" << endl;
+    cout << "Current HashingVectorizer Head:" << endl;
+    for (unsigned int i = 0; i < getFeatureCount() && printed < 10; i++)
+    {
+        if (doc_freqs.count(i))
+        {
+            cout << "column " << i << ": " << doc_freqs[i] << endl;
+            printed++;
+        }
+    }
+    cout << "------------------------------" << endl;
+}
+
+/**
+ * @brief Set hash_bits (k) and alternate_sign.
+ *
+ * @param key Name of the hyperparameter.
+ * @param value Value of the hyperparameter.
+ */
+void HashingVectorizer::setHyperparameter(const std::string& key, double value)
+{
+    if (key == "hash_bits")
+    {
+        hash_bits = static_cast<int>(value);
+        if (hash_bits < 1 || hash_bits > HASHINGVECTORIZER_MAX_BITS)
+        {
+            cout << "WARNING: hash_bits out of range, using " << HASHINGVECTORIZER_DEFAULT_BITS << endl;
+            hash_bits = HASHINGVECTORIZER_DEFAULT_BITS;
+        }
+    }
+    else if (key == "alternate_sign")
+    {
+        alternate_sign = (value != 0.0);
+    }
+    else
+    {
+        BaseVectorizer::setHyperparameter(key, value);
+    }
+}
+
+/**
+ * @brief Columns are fixed by the hash, so there is nothing to remap.
+ *
+ * @param old_to_new Ignored.
+ * @return Always false.
+ */
+bool HashingVectorizer::remapFeatures(const std::vector<int>& old_to_new)
+{
+    cerr << "ERROR: HashingVectorizer has no vocabulary to prune, lower hash_bits instead.\n";
+    return false;
+}
+
+// ===========================================================|
+// ======================HELPERS==============================|
+// ===========================================================|
+
+/**
+ * @brief Column and sign of a feature hash.
+ *
+ * The column is taken from the low bits of the hash and the sign from the
+ * top bit, which is independent of the column for any k <= 24.
+ *
+ * @param h Feature hash, see BaseVectorizer::forEachFeature.
+ * @param sign Receives +1.0 or -1.0.
+ * @return Column index of the feature.
+ */
+int HashingVectorizer::hashColumn(uint64_t h, double& sign) const
+{
+    sign = (alternate_sign && (h >> 63)) ? -1.0 : 1.0;
+    return static_cast<int>(h & (getFeatureCount() - 1));
+}
+
+/**
+ * @brief Create a Sentence object from a vector of words.
+ *
+ * @param new_sentence_vector The vector of words forming the sentence.
+ * @param label_ Class index of the sentence.
+ * @return Shared pointer to the created Sentence object.
+ */
+shared_ptr<Sentence> HashingVectorizer::createSentenceObject(vector<string> new_sentence_vector, int label_)
+{
+    shared_ptr<Sentence> new_sentence(new Sentence);
+    forEachFeature(new_sentence_vector, [&](uint64_t hash, const FeatureSpan& span)
+    {
+        double sign;
+        int idx = hashColumn(hash, sign);
+        new_sentence->sentence_map[idx] += sign;
+    });
+
+    // Drop columns where signed collisions cancelled out completely.
+    for (auto it = new_sentence->sentence_map.begin(); it != new_sentence->sentence_map.end();)
+    {
+        if (it->second == 0.0)
+        {
+            it = new_sentence->sentence_map.erase(it);
+        }
+        else
+        {
+            if (binary)
+            {
+                it->second = it->second > 0 ? 1.0 : -1.0;
+            }
+            ++it;
+        }
+    }
+    new_sentence->label = label_;
+    return new_sentence;
+}
+
+/**
+ * @brief Add a sentence to the HashingVectorizer.
+ *
+ * @param new_sentence The new sentence to add.
+ * @param label_ Class index of the sentence.
+ */
+void HashingVectorizer::addSentence(string new_sentence, int label_)
+{
+    vector<string> processedString;
+    processedString = buildSentenceVector(new_sentence);
+    shared_ptr<Sentence> sentObj = createSentenceObject(processedString, label_);
+    sentences.push_back(sentObj);
+}
+
+/**
+ * @brief Every word has a column, so this always holds.
+ *
+ * @param word_to_check The word to check.
+ * @return Always true.
+ */
+bool HashingVectorizer::ContainsWord(const string& word_to_check)
+{
+    return true;
+}
+
+/**
+ * @brief Get the feature vector for a given sentence.
+ *
+ * @param sentence_words The words of the sentence.
+ * @return Vector of feature values.
+ */
+void HashingVectorizer::getSentenceFeatures(const TokenList& sentence_words, PredictContext& ctx, FeatureVector& sentence_features) const
+{
+    sentence_features.assign(getFeatureCount(), 0.0);
+    forEachFeature(sentence_words, [&](uint64_t hash, const FeatureSpan& span)
+    {
+        double sign;
+        int idx = hashColumn(hash, sign);
+        sentence_features[idx] += sign;
+    });
+    if (binary)
+    {
+        for (auto& v : sentence_features)
+        {
+            v = (v > 0) - (v < 0);
+        }
+    }
+}
+
+void HashingVectorizer::appendSparseFeatures(std::string_view text, PredictContext& ctx, SparseBatch& batch) const
+{
+    forEachTextFeature(text, [&](uint64_t hash, const FeatureSpan& span)
+    {
+        double sign;
+        batch.col_idx.push_back(hashColumn(hash, sign));
+        batch.values.push_back(sign);
+    });
+    closeSparseRow(batch, ctx);
+
+    if (binary)
+    {
+        for (size_t i = batch.row_ptr[batch.rows() - 1]; i < batch.row_ptr.back(); ++i)
+        {
+            batch.values[i] = batch.values[i] > 0 ? 1.0 : -1.0;
+        }
+    }
+}
+
+std::vector<double> HashingVectorizer::getFrequencies(std::unordered_map<int, double> term_freqs) const
+{
+    std::vector<double> sentence_features(getFeatureCount(), 0.0);
+    for (const auto& entry : term_freqs)
+    {
+        sentence_features[entry.first] = entry.second;
+    }
+    return sentence_features;
+}
+
+/**
+ * @brief Save the HashingVectorizer settings to a file.
+ *
+ * @param outFile Output file stream to save the model.
+ */
+void HashingVectorizer::save(std::ofstream& outFile) const
+{
+    outFile.write(reinterpret_cast<const char*>(&vers_info), sizeof(vers_info));
+    outFile.write(reinterpret_cast<const char*>(&hash_bits), sizeof(hash_bits));
+    outFile.write(reinterpret_cast<const char*>(&alternate_sign), sizeof(alternate_sign));
+    outFile.write(reinterpret_cast<const char*>(&binary), sizeof(binary));
+    outFile.write(reinterpret_cast<const char*>(&case_sensitive), sizeof(case_sensitive));
+    outFile.write(reinterpret_cast<const char*>(&include_stopwords), sizeof(include_stopwords));
+    saveFeatureConfig(outFile);
+}
+
+/**
+ * @brief Load the HashingVectorizer settings from a file.
+ *
+ * @param inFile Input file stream to load the model.
+ */
+void HashingVectorizer::load(std::ifstream& inFile)
+{
+    sentences.clear();
+
+    inFile.read(reinterpret_cast<char*>(&vers_info), sizeof(vers_info));
+    inFile.read(reinterpret_cast<char*>(&hash_bits), sizeof(hash_bits));
+    if (hash_bits < 1 || hash_bits > HASHINGVECTORIZER_MAX_BITS)
+    {
+        // A corrupt or foreign file, getFeatureCount must still be a valid shift.
+        hash_bits = HASHINGVECTORIZER_DEFAULT_BITS;
+        inFile.setstate(std::ios::failbit);
+    }
+    inFile.read(reinterpret_cast<char*>(&alternate_sign), sizeof(alternate_sign));
+    inFile.read(reinterpret_cast<char*>(&binary), sizeof(binary));
+    inFile.read(reinterpret_cast<char*>(&case_sensitive), sizeof(case_sensitive));
+    inFile.read(reinterpret_cast<char*>(&include_stopwords), sizeof(include_stopwords));
+    loadFeatureConfig(inFile);
+}
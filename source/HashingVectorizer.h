@@ -0,0 +1,196 @@
+/**
+ * @file HashingVectorizer.h
+ * @brief Header file for the HashingVectorizer class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef HASHINGVECTORIZER_H__
+#define HASHINGVECTORIZER_H__
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+
+#include "BaseVectorizer.h"
+#include "FeatureHash.h"
+
+#define HASHINGVECTORIZER_DEFAULT_BITS  16
+#define HASHINGVECTORIZER_MAX_BITS      24
+
+/**
+ * @class HashingVectorizer
+ * @brief Converts a collection of text documents to a matrix of hashed token counts.
+ *
+ * Instead of learning a vocabulary, every token is mapped to one of
+ * \f$2^k\f$ columns by a fast non-cryptographic hash:
+ * \f[
+ * \text{x}_j(d) = \sum_{t \in d,\ h(t) \bmod 2^k = j} \xi(t)
+ * \f]
+ * where \f$\xi(t) \in \{-1, +1\}\f$ is derived from an independent bit of the
+ * hash when alternate_sign is enabled, so that colliding tokens cancel out in
+ * expectation instead of piling up.
+ *
+ * No vocabulary is stored, fitting is a single stateless pass over the corpus
+ * and the model size only depends on k, never on the size of the corpus.
+ */
+class HashingVectorizer : public BaseVectorizer
+{
+public:
+    // ======================CONSTRUCTORS==============================|
+
+    /**
+     * @brief Default constructor.
+     *
+     * Defaults to binary=false, case_sensitive=true, include_stopwords=true,
+     * 2^16 features and alternate signs.
+     */
+    HashingVectorizer();
+
+    /**
+     * @brief Constructor with options.
+     *
+     * @param binary_ Boolean flag indicating if binary vectors are used.
+     * @param case_sensitive_ Boolean flag indicating if case sensitivity is considered.
+     * @param include_stopwords_ Boolean flag indicating if stop words are included.
+     */
+    HashingVectorizer(bool binary_, bool case_sensitive_, bool include_stopwords_);
+
+    /**
+     * @brief Destructor.
+     */
+    ~HashingVectorizer();
+
+    // ======================USER INTERFACE FUNCTIONS==================|
+
+    /**
+     * @brief Fit the vectorizer on the given dataset.
+     *
+     * Only hashes the documents, nothing is learned from them.
+     *
+     * @param abs_filepath_to_features Absolute file path to the features file.
+     * @param abs_filepath_to_labels Absolute file path to the labels file.
+     */
+    void fit(string abs_filepath_to_features, string abs_filepath_to_labels) override;
+
+    /**
+     * @brief Print the dimensions of the HashingVectorizer object.
+     */
+    void shape() override;
+
+    /**
+     * @brief Print the document frequency of the first 10 non-empty columns.
+     */
+    void head() override;
+
+    /**
+     * @brief Set hash_bits (k) and alternate_sign, other keys go to BaseVectorizer.
+     *
+     * @param key Name of the hyperparameter.
+     * @param value Value of the hyperparameter.
+     */
+    void setHyperparameter(const std::string& key, double value) override;
+
+    /**
+     * @brief Columns are fixed by the hash, so there is nothing to remap.
+     *
+     * @param old_to_new Ignored.
+     * @return Always false.
+     */
+    bool remapFeatures(const std::vector<int>& old_to_new) override;
+
+    /**
+     * @brief Number of columns, 2^hash_bits.
+     *
+     * @return Number of features.
+     */
+    unsigned int getFeatureCount() const override { return 1u << hash_bits; }
+
+    // ======================HELPERS===================================|
+
+    /**
+     * @brief Create a Sentence object from a vector of words.
+     *
+     * @param new_sentence_vector The vector of words forming the sentence.
+     * @param label_ Class index of the sentence.
+     * @return Shared pointer to the created Sentence object.
+     */
+    shared_ptr<Sentence> createSentenceObject(vector<string> new_sentence_vector, int label_);
+
+    /**
+     * @brief Add a sentence to the HashingVectorizer.
+     *
+     * @param new_sentence The new sentence to add.
+     * @param label_ Class index of the sentence.
+     */
+    void addSentence(string new_sentence, int label_) override;
+
+    /**
+     * @brief Every word has a column, so this always holds.
+     *
+     * @param word_to_check The word to check.
+     * @return Always true.
+     */
+    bool ContainsWord(const string& word_to_check) override;
+
+    /**
+     * @brief Get the feature vector for a given sentence.
+     *
+     * @param sentence_words The words of the sentence.
+     * @param ctx Context providing the scratch memory.
+     * @param sentence_features Receives the feature values.
+     */
+    void getSentenceFeatures(const TokenList& sentence_words, PredictContext& ctx, FeatureVector& sentence_features) const override;
+
+    /**
+     * @brief Append the features of a sentence as a row of a sparse batch.
+     *
+     * @param text The normalised sentence.
+     * @param ctx Context providing the scratch memory.
+     * @param batch Batch to append the row to.
+     */
+    void appendSparseFeatures(std::string_view text, PredictContext& ctx, SparseBatch& batch) const override;
+
+    std::vector<double> getFrequencies(std::unordered_map<int, double> term_freqs) const override;
+
+    /**
+     * @brief Save the HashingVectorizer settings to a file.
+     *
+     * @param outFile Output file stream to save the model.
+     */
+    void save(std::ofstream& outFile) const override;
+
+    /**
+     * @brief Load the HashingVectorizer settings from a file.
+     *
+     * Sets the failbit of inFile if hash_bits is out of range.
+     *
+     * @param inFile Input file stream to load the model.
+     */
+    void load(std::ifstream& inFile) override;
+
+private:
+    int hash_bits; /**< Number of columns is 2^hash_bits. */
+    bool alternate_sign; /**< Flag indicating if collisions are signed. */
+
+    /**
+     * @brief Column and sign of a feature hash.
+     *
+     * @param h Feature hash.
+     * @param sign Receives +1.0 or -1.0.
+     * @return Column index of the feature.
+     */
+    int hashColumn(uint64_t h, double& sign) const;
+};
+
+#endif // HASHINGVECTORIZER_H__
@@ -0,0 +1,290 @@
+/**
+ * @file HyperparameterSearch.cpp
+ * @brief Implementation of the HyperparameterSearch class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "HyperparameterSearch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "LineReader.h"
+#include "ThreadPool.h"
+
+HyperparameterSearch::HyperparameterSearch(int vectorizer_id_, int classifier_id_)
+    : vectorizer_id(vectorizer_id_), classifier_id(classifier_id_)
+{
+}
+
+bool HyperparameterSearch::fitCorpus(const std::string& abs_filepath_to_features, const std::string& abs_filepath_to_labels, const std::string& base_hyperparameters_)
+{
+    TextClassifierFactory factory;
+    TextClassifierFactory::Product host = factory.getTextClassifier(vectorizer_id, classifier_id);
+    if (host == nullptr)
+    {
+        std::cerr << "ERROR: Invalid vectorizer id or classifier id.\n";
+        return false;
+    }
+
+    if (BaseVectorizer::isCorpusFile(abs_filepath_to_features))
+    {
+        std::cerr << "ERROR: Held out folds are scored from text, give the features file rather than a corpus file.\n";
+        return false;
+    }
+    LineReader in(abs_filepath_to_features);
+    if (!in)
+    {
+        std::cerr << "ERROR: Cannot open features file.\n";
+        return false;
+    }
+    texts = in.readAll();
+    in.close();
+
+    // The classifier forwards every key to its vectorizer, which becomes the corpus.
+    base_hyperparameters = base_hyperparameters_;
+    host->setHyperparameters(base_hyperparameters);
+    corpus = host->pVec;
+    corpus->fit(abs_filepath_to_features, abs_filepath_to_labels);
+
+    if (corpus->getSentenceCount() == 0 || corpus->getSentenceCount() != texts.size())
+    {
+        std::cerr << "ERROR: The features and labels files could not be vectorised.\n";
+        corpus.reset();
+        return false;
+    }
+    labels.resize(texts.size());
+    for (size_t i = 0; i < texts.size(); ++i)
+    {
+        labels[i] = corpus->getSentence(i)->label;
+    }
+    return true;
+}
+
+std::vector<HyperparameterSearch::FoldRun> HyperparameterSearch::runFolds(const std::vector<std::string>& candidates, size_t k, unsigned int num_threads)
+{
+    const size_t n = texts.size();
+    const int num_classes = corpus->getClassLabels().size();
+
+    // Every fold trains on the shared sentences outside it and scores the texts inside it.
+    std::vector<std::vector<std::shared_ptr<Sentence>>> train_sets(k);
+    std::vector<std::vector<std::string_view>> held_out(k);
+    std::vector<std::vector<int>> held_out_labels(k);
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t f = i % k;
+        held_out[f].push_back(texts[i]);
+        held_out_labels[f].push_back(labels[i]);
+        for (size_t g = 0; g < k; ++g)
+        {
+            if (g != f)
+            {
+                train_sets[g].push_back(corpus->getSentence(i));
+            }
+        }
+    }
+
+    // Classifiers are set up here, because setHyperparameters prints. Each
+    // one parses its hyperparameters into a vectorizer of its own, which is
+    // then swapped for the shared corpus.
+    const size_t runs = candidates.size() * k;
+    TextClassifierFactory factory;
+    std::vector<TextClassifierFactory::Product> models(runs);
+    std::vector<FoldRun> fold_runs(runs);
+    for (size_t r = 0; r < runs; ++r)
+    {
+        models[r] = factory.getTextClassifier(vectorizer_id, classifier_id);
+        models[r]->setHyperparameters(base_hyperparameters + "," + candidates[r / k]);
+        models[r]->pVec = corpus;
+        fold_runs[r].evaluation = Evaluation(num_classes);
+    }
+
+    std::unique_ptr<ThreadPool> own_pool;
+    if (num_threads > 0)
+    {
+        own_pool = std::make_unique<ThreadPool>(num_threads);
+    }
+    ThreadPool& pool = own_pool ? *own_pool : ThreadPool::shared();
+    pool.parallelFor(runs, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t r = begin; r < end; ++r)
+        {
+            const size_t f = r % k;
+            const std::vector<std::string_view>& test = held_out[f];
+            FoldRun& result = fold_runs[r];
+            try
+            {
+                auto start = std::chrono::steady_clock::now();
+                models[r]->fitSentences(train_sets[f]);
+                auto trained = std::chrono::steady_clock::now();
+
+                std::vector<Prediction> predictions(test.size());
+                for (size_t s = 0; s < test.size(); s += PREDICT_BATCH_SIZE)
+                {
+                    size_t count = std::min<size_t>(PREDICT_BATCH_SIZE, test.size() - s);
+                    models[r]->predictBatch(std::span<const std::string_view>(test.data() + s, count), std::span<Prediction>(predictions.data() + s, count), false);
+                }
+                auto predicted = std::chrono::steady_clock::now();
+
+                for (size_t i = 0; i < test.size(); ++i)
+                {
+                    result.evaluation.add(held_out_labels[f][i], predictions[i].label, predictions[i].probability);
+                }
+                result.train_seconds = std::chrono::duration<double>(trained - start).count();
+                result.predict_seconds = std::chrono::duration<double>(predicted - trained).count();
+            }
+            catch (const std::exception&)
+            {
+                result.failed = true;
+            }
+            // Only one trained model per thread is alive at a time.
+            models[r].reset();
+        }
+    });
+    return fold_runs;
+}
+
+std::vector<SearchResult> HyperparameterSearch::run(const std::vector<std::string>& candidates, int folds, unsigned int num_threads)
+{
+    std::vector<SearchResult> results;
+    if (corpus == nullptr || candidates.empty())
+    {
+        return results;
+    }
+    const size_t k = std::clamp<size_t>(folds, 2, texts.size());
+    std::vector<FoldRun> fold_runs = runFolds(candidates, k, num_threads);
+
+    for (size_t c = 0; c < candidates.size(); ++c)
+    {
+        SearchResult summary = { candidates[c], 0.0, 0.0, 0.0, 0.0, false };
+        double predict_seconds = 0.0;
+        for (size_t f = 0; f < k; ++f)
+        {
+            const FoldRun& result = fold_runs[c * k + f];
+            summary.accuracy += result.evaluation.accuracy() / k;
+            summary.train_seconds += result.train_seconds / k;
+            predict_seconds += result.predict_seconds;
+            summary.failed |= result.failed;
+        }
+        for (size_t f = 0; f < k; ++f)
+        {
+            double deviation = fold_runs[c * k + f].evaluation.accuracy() - summary.accuracy;
+            summary.accuracy_stddev += deviation * deviation / k;
+        }
+        summary.accuracy_stddev = std::sqrt(summary.accuracy_stddev);
+        summary.predict_us = predict_seconds / texts.size() * 1e6;
+        results.push_back(summary);
+    }
+
+    // Failed candidates last, then by accuracy, then the faster to train.
+    std::stable_sort(results.begin(), results.end(), [](const SearchResult& a, const SearchResult& b)
+    {
+        if (a.failed != b.failed)
+        {
+            return b.failed;
+        }
+        if (a.accuracy != b.accuracy)
+        {
+            return a.accuracy > b.accuracy;
+        }
+        return a.train_seconds < b.train_seconds;
+    });
+    return results;
+}
+
+Evaluation HyperparameterSearch::crossValidate(const std::string& hyperparameters, int folds, unsigned int num_threads)
+{
+    if (corpus == nullptr)
+    {
+        return Evaluation();
+    }
+    const size_t k = std::clamp<size_t>(folds, 2, texts.size());
+    std::vector<FoldRun> fold_runs = runFolds(std::vector<std::string>(1, hyperparameters), k, num_threads);
+
+    Evaluation evaluation(corpus->getClassLabels().size());
+    for (const auto& result : fold_runs)
+    {
+        if (result.failed)
+        {
+            std::cerr << "ERROR: Training or scoring a fold failed.\n";
+            return Evaluation(corpus->getClassLabels().size());
+        }
+        evaluation.merge(result.evaluation);
+    }
+    return evaluation;
+}
+
+std::vector<std::string> HyperparameterSearch::expandGrid(const std::string& grid)
+{
+    std::vector<std::string> combinations(1);
+    std::string pair;
+    std::istringstream pairs(grid);
+    while (std::getline(pairs, pair, ','))
+    {
+        if (pair.empty())
+        {
+            continue;
+        }
+        std::vector<std::string> options;
+        size_t eq = pair.find('=');
+        if (eq == std::string::npos)
+        {
+            options.push_back(pair);
+        }
+        else
+        {
+            std::string value;
+            std::istringstream values(pair.substr(eq + 1));
+            while (std::getline(values, value, SEARCH_GRID_SEPARATOR))
+            {
+                options.push_back(pair.substr(0, eq + 1) + value);
+            }
+        }
+
+        std::vector<std::string> expanded;
+        expanded.reserve(combinations.size() * options.size());
+        for (const auto& prefix : combinations)
+        {
+            for (const auto& option : options)
+            {
+                expanded.push_back(prefix.empty() ? option : prefix + "," + option);
+            }
+        }
+        combinations.swap(expanded);
+    }
+    return combinations;
+}
+
+void HyperparameterSearch::printLeaderboard(const std::vector<SearchResult>& results, std::ostream& out)
+{
+    out << std::left << std::setw(6) << "Rank" << std::setw(10) << "Accuracy" << std::setw(9) << "+/-"
+        << std::setw(11) << "Train s" << std::setw(13) << "Predict us" << "Hyperparameters" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const SearchResult& result = results[i];
+        out << std::left << std::setw(6) << i + 1;
+        if (result.failed)
+        {
+            out << std::setw(43) << "failed";
+        }
+        else
+        {
+            out << std::fixed << std::setprecision(4) << std::setw(10) << result.accuracy << std::setw(9) << result.accuracy_stddev
+                << std::setprecision(3) << std::setw(11) << result.train_seconds << std::setprecision(2) << std::setw(13) << result.predict_us;
+        }
+        out << result.hyperparameters << std::endl;
+    }
+    out << std::defaultfloat << std::setprecision(6);
+}
@@ -0,0 +1,163 @@
+/**
+ * @file HyperparameterSearch.h
+ * @brief k-fold evaluation of hyperparameter candidates on one shared vectorised corpus.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef HYPERPARAMETERSEARCH_H__
+#define HYPERPARAMETERSEARCH_H__
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "TextClassifierFactory.h"
+#include "Evaluation.h"
+
+#define SEARCH_DEFAULT_FOLDS    5       /**< Folds of the search command when none are given. */
+#define SEARCH_GRID_SEPARATOR   '|'     /**< Separates the values of a key in a grid, e.g. "epochs=5|15". */
+
+/**
+ * @struct SearchResult
+ * @brief Cross-validated score of one hyperparameter candidate.
+ */
+struct SearchResult
+{
+    std::string hyperparameters;    /**< Classifier hyperparameters of the candidate. */
+    double accuracy;                /**< Mean accuracy on the held out folds. */
+    double accuracy_stddev;         /**< Standard deviation of the fold accuracies. */
+    double train_seconds;           /**< Mean time to train on one fold. */
+    double predict_us;              /**< Mean time to predict one held out text, in microseconds. */
+    bool failed;                    /**< Training or prediction of a fold threw, the scores are meaningless. */
+};
+
+/**
+ * @class HyperparameterSearch
+ * @brief Scores classifier hyperparameters by k-fold cross-validation.
+ *
+ * The features file is vectorised once, by fitCorpus, into a vectorizer that
+ * every candidate then shares read only: each candidate and fold gets its
+ * own classifier whose pVec points at that vectorizer and which is trained
+ * with fitSentences on the sentences outside the fold. The held out texts are
+ * scored with predictBatch, so the predict time includes tokenising, like a
+ * deployed model. All candidate x fold runs are spread over a ThreadPool,
+ * each thread holds one trained model at a time.
+ *
+ * Vectorizer hyperparameters (n-grams, min_df, ...) are fixed by fitCorpus.
+ * The vocabulary and IDF values are computed on the whole file, held out
+ * folds included, which is the price of vectorising only once.
+ */
+class HyperparameterSearch
+{
+public:
+    /**
+     * @brief Create a search for a vectorizer/classifier pair.
+     *
+     * @param vectorizer_id_ ID_VECTORIZER_* of the shared vectorizer.
+     * @param classifier_id_ ID_CLASSIFIER_* of the candidates.
+     */
+    HyperparameterSearch(int vectorizer_id_, int classifier_id_);
+
+    /**
+     * @brief Vectorise the training data once.
+     *
+     * @param abs_filepath_to_features Absolute file path to the features file.
+     * @param abs_filepath_to_labels Absolute file path to the labels file.
+     * @param base_hyperparameters_ Applied to the vectorizer, and to every candidate before its own.
+     * @return False if the ids are invalid or the files could not be vectorised.
+     */
+    bool fitCorpus(const std::string& abs_filepath_to_features, const std::string& abs_filepath_to_labels, const std::string& base_hyperparameters_);
+
+    /**
+     * @brief Score every candidate by k-fold cross-validation.
+     *
+     * Sentence i is held out in fold i % folds.
+     *
+     * @param candidates Classifier hyperparameter strings, as for setHyperparameters.
+     * @param folds Number of folds, at least 2 and at most one per sentence.
+     * @param num_threads Threads training at once, 0 for ThreadPool::shared().
+     * @return One result per candidate, best accuracy first.
+     */
+    std::vector<SearchResult> run(const std::vector<std::string>& candidates, int folds, unsigned int num_threads = 0);
+
+    /**
+     * @brief Cross-validate one set of hyperparameters with every metric of Evaluation.
+     *
+     * Like run with a single candidate. The predictions of all held out
+     * folds are counted together.
+     *
+     * @param hyperparameters Classifier hyperparameters, as for setHyperparameters.
+     * @param folds Number of folds, at least 2 and at most one per sentence.
+     * @param num_threads Threads training at once, 0 for ThreadPool::shared().
+     * @return Metrics over every sentence, with a count of 0 if no corpus is fitted.
+     */
+    Evaluation crossValidate(const std::string& hyperparameters, int folds, unsigned int num_threads = 0);
+
+    /**
+     * @brief Names of the classes of the corpus.
+     */
+    const LabelDictionary& getClassLabels() const { return corpus->getClassLabels(); }
+
+    /**
+     * @brief Expand a grid into hyperparameter strings.
+     *
+     * Every key may list several values separated by SEARCH_GRID_SEPARATOR,
+     * "epochs=5|15,learning_rate=0.01|0.1" gives four candidates. The first
+     * key changes slowest.
+     *
+     * @param grid Hyperparameter string with value lists.
+     * @return Every combination of the values.
+     */
+    static std::vector<std::string> expandGrid(const std::string& grid);
+
+    /**
+     * @brief Print results as a table, in their order.
+     *
+     * @param results Results of run.
+     * @param out Stream to print to.
+     */
+    static void printLeaderboard(const std::vector<SearchResult>& results, std::ostream& out);
+
+    /**
+     * @brief Number of sentences in the corpus.
+     */
+    size_t size() const { return texts.size(); }
+
+private:
+    int vectorizer_id; /**< Vectorizer of the corpus. */
+    int classifier_id; /**< Classifier of the candidates. */
+    std::string base_hyperparameters; /**< Put before the hyperparameters of every candidate. */
+    std::shared_ptr<BaseVectorizer> corpus; /**< Fitted vectorizer, only read once fitCorpus returns. */
+    std::vector<std::string> texts; /**< Lines of the features file, for scoring held out folds. */
+    std::vector<int> labels; /**< Class index of every line. */
+
+    /**
+     * @struct FoldRun
+     * @brief Outcome of training one candidate without one fold and scoring that fold.
+     */
+    struct FoldRun
+    {
+        Evaluation evaluation;          /**< Metrics of the held out fold. */
+        double train_seconds = 0.0;     /**< Time to train. */
+        double predict_seconds = 0.0;   /**< Time to score the held out fold. */
+        bool failed = false;            /**< Training or scoring threw. */
+    };
+
+    /**
+     * @brief Train and score every candidate on every fold.
+     *
+     * @return candidates.size() * folds runs, those of candidate c at [c * folds, (c + 1) * folds).
+     */
+    std::vector<FoldRun> runFolds(const std::vector<std::string>& candidates, size_t folds, unsigned int num_threads);
+};
+
+#endif // HYPERPARAMETERSEARCH_H__
@@ -9,6 +9,7 @@ Revision History:
 --*/
 
 #include "KDTree.h"
+#include "SimdKernels.h"
 
 KDTree::KDTree() : root(nullptr), dimension(0) {}
 
@@ -58,7 +59,7 @@ void KDTree::destroyTree(KDNode* node)
     delete node;
 }
 
-int KDTree::nearestNeighbor(const std::vector<double>& point)
+int KDTree::nearestNeighbor(const double* point) const
 {
     KDNode* best = nullptr;
     double best_dist = std::numeric_limits<double>::infinity();
@@ -66,7 +67,7 @@ int KDTree::nearestNeighbor(const std::vector<double>& point)
     return best->label;
 }
 
-void KDTree::nearest(KDNode* root, const std::vector<double>& target, KDNode*& best, double& best_dist, int depth) const
+void KDTree::nearest(KDNode* root, const double* target, KDNode*& best, double& best_dist, int depth) const
 {
     if (!root) return;
 
@@ -88,47 +89,39 @@ void KDTree::nearest(KDNode* root, const std::vector<double>& target, KDNode*& b
     }
 }
 
-double KDTree::calculateDistance(const std::vector<double>& a, const std::vector<double>& b) const
+double KDTree::calculateDistance(const std::vector<double>& a, const double* b) const
 {
-    double sum = 0.0;
-    for (size_t i = 0; i < a.size(); ++i)
-    {
-        double diff = a[i] - b[i];
-        sum += diff * diff;
-    }
-    return std::sqrt(sum);
+    return std::sqrt(SimdKernels::squaredDistance(a.data(), b, a.size()));
 }
 
-std::vector<double> KDTree::getClosestDistances(const std::vector<double>& point, int k)
+void KDTree::getClosestDistances(const double* point, int k, std::pmr::vector<double>& closest_distances) const
 {
-    // Min heap to store distances
-    std::priority_queue<double> closest_distances;
+    // Max heap of the k smallest distances, kept in the caller's buffer
+    closest_distances.clear();
+    closest_distances.reserve(k + 1);
 
     // Recursive function to find k nearest neighbors
     findKNearest(root, point, closest_distances, k, 0);
 
-    // Convert the min heap to a vector and return
-    std::vector<double> result;
-    while (!closest_distances.empty()) {
-        result.push_back(closest_distances.top());
-        closest_distances.pop();
-    }
-    std::reverse(result.begin(), result.end()); // Reversing to get the distances in ascending order
-    return result;
+    // Sorting the heap gives the distances in ascending order
+    std::sort_heap(closest_distances.begin(), closest_distances.end());
 }
 
-void KDTree::findKNearest(KDNode* root, const std::vector<double>& target, std::priority_queue<double>& closest_distances, int k, int depth)
+void KDTree::findKNearest(KDNode* root, const double* target, std::pmr::vector<double>& closest_distances, size_t k, int depth) const
 {
     if (!root) return;
 
     double d = calculateDistance(root->point, target);
 
-    // If the queue is not full yet or the current distance is less than the maximum distance in the queue
-    if (closest_distances.size() < k || d < closest_distances.top())
+    // If the heap is not full yet or the current distance is less than the maximum distance in the heap
+    if (closest_distances.size() < k || d < closest_distances.front())
     {
-        closest_distances.push(d);
+        closest_distances.push_back(d);
+        std::push_heap(closest_distances.begin(), closest_distances.end());
         if (closest_distances.size() > k) {
-            closest_distances.pop(); // Remove the maximum distance if the queue size exceeds k
+            // Remove the maximum distance if the heap size exceeds k
+            std::pop_heap(closest_distances.begin(), closest_distances.end());
+            closest_distances.pop_back();
         }
     }
 
@@ -137,7 +130,7 @@ void KDTree::findKNearest(KDNode* root, const std::vector<double>& target, std::
     KDNode* other = target[axis] < root->point[axis] ? root->right : root->left;
 
     findKNearest(next, target, closest_distances, k, depth + 1);
-    if (std::abs(target[axis] - root->point[axis]) < closest_distances.top())
+    if (std::abs(target[axis] - root->point[axis]) < closest_distances.front())
     {
         findKNearest(other, target, closest_distances, k, depth + 1);
     }
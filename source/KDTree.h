@@ -15,7 +15,7 @@ Revision History:
 #include <algorithm>
 #include <cmath>
 #include <limits>
-#include <queue>
+#include <memory_resource>
 
 /**
  * @file KDTree.h
@@ -58,18 +58,18 @@ public:
 
     /**
      * @brief Find the nearest neighbor to a given point.
-     * @param point Query point.
+     * @param point Query point, as many values as the training points.
      * @return Label of the nearest neighbor.
      */
-    int nearestNeighbor(const std::vector<double>& point);
+    int nearestNeighbor(const double* point) const;
 
     /**
      * @brief Get the closest distances to a given point from k nearest neighbors.
-     * @param point Query point.
+     * @param point Query point, as many values as the training points.
      * @param k Number of nearest neighbors.
-     * @return Closest distances to the query point.
+     * @param closest_distances Receives the closest distances in ascending order.
      */
-    std::vector<double> getClosestDistances(const std::vector<double>& point, int k);
+    void getClosestDistances(const double* point, int k, std::pmr::vector<double>& closest_distances) const;
 
 private:
     KDNode* root; /**< Pointer to the root node of the KDTree. */
@@ -97,25 +97,25 @@ private:
      * @param best_dist Distance to the nearest neighbor found so far.
      * @param depth Depth of the current node in the tree.
      */
-    void nearest(KDNode* root, const std::vector<double>& target, KDNode*& best, double& best_dist, int depth) const;
+    void nearest(KDNode* root, const double* target, KDNode*& best, double& best_dist, int depth) const;
 
     /**
      * @brief Calculate the Euclidean distance between two points.
-     * @param a First point.
-     * @param b Second point.
+     * @param a Point of the tree.
+     * @param b Query point.
      * @return Euclidean distance between the points.
      */
-    double calculateDistance(const std::vector<double>& a, const std::vector<double>& b) const;
+    double calculateDistance(const std::vector<double>& a, const double* b) const;
 
     /**
      * @brief Find k nearest neighbors to a given point.
      * @param root Root node of the subtree.
      * @param target Query point.
-     * @param closest_distances Priority queue to store the closest distances.
+     * @param closest_distances Max-heap of the closest distances found so far.
      * @param k Number of nearest neighbors.
      * @param depth Depth of the current node in the tree.
      */
-    void findKNearest(KDNode* root, const std::vector<double>& target, std::priority_queue<double>& closest_distances, int k, int depth);
+    void findKNearest(KDNode* root, const double* target, std::pmr::vector<double>& closest_distances, size_t k, int depth) const;
 };
 
 #endif // KDTREE_H__
@@ -14,15 +14,16 @@ Revision History:
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include "SimdKernels.h"
 
-KNNClassifier::KNNClassifier(BaseVectorizer* pvec)
+KNNClassifier::KNNClassifier(std::shared_ptr<BaseVectorizer> pvec)
 {
     pVec = pvec;
+    k = 3;
 }
 
 KNNClassifier::~KNNClassifier()
 {
-    delete pVec;
 }
 
 void KNNClassifier::setHyperparameters(std::string hyperparameters)
@@ -38,11 +39,12 @@ void KNNClassifier::setHyperparameters(std::string hyperparameters)
         std::string key;
         double value;
 
+        if (pVec->setOption(token)) {
+            continue;
+        }
         if (std::getline(pairStream, key, '=') && pairStream >> value) {
             cout << key << " = " << value << endl;
-            if (key == "minfrequency") {
-                minfrequency = value;
-            }
+            pVec->setHyperparameter(key, value);
             if (key == "k") {
                 k = value;
             }
@@ -52,100 +54,35 @@ void KNNClassifier::setHyperparameters(std::string hyperparameters)
 
 void KNNClassifier::fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels)
 {
-    if (minfrequency > 0)
-    {
-        pVec->scanForSparseHistogram(abs_filepath_to_features, minfrequency);
-    }
     pVec->fit(abs_filepath_to_features, abs_filepath_to_labels);
+    fitSentences(pVec->sentences);
+}
 
-    size_t num_features = pVec->word_array.size();
-    std::vector<std::shared_ptr<Sentence>> sentences = pVec->sentences;
+void KNNClassifier::fitSentences(const std::vector<std::shared_ptr<Sentence>>& sentences)
+{
     training_features.clear();
     training_labels.clear();
 
-    std::ifstream label_file(abs_filepath_to_labels);
-    std::string label;
     for (size_t i = 0; i < sentences.size(); ++i)
     {
         std::vector<double> features;
         const auto& sentence_map = sentences[i]->sentence_map;
         features = pVec->getFrequencies(sentence_map);
         training_features.push_back(features);
-
-        label_file >> label;
-        training_labels.push_back(std::stoi(label));
+        training_labels.push_back(sentences[i]->label);
     }
-    label_file.close();
 
     kd_tree.build(training_features, training_labels);
 }
 
-void KNNClassifier::predict(std::string abs_filepath_to_features, std::string abs_filepath_to_labels, bool preprocess)
-{
-    std::ifstream in(abs_filepath_to_features);
-    std::ofstream out(abs_filepath_to_labels);
-    std::string feature_input;
-
-    if (!in)
-    {
-        std::cerr << "ERROR: Cannot open features file.\n";
-        return;
-    }
-
-    if (!out)
-    {
-        std::cerr << "ERROR: Cannot open labels file.\n";
-        return;
-    }
-
-    #ifdef BENCHMARK
-    double sumduration = 0.0;
-    double sumstrlen = 0.0;
-    size_t num_rows = 0;
-    #endif
-
-    while (getline(in, feature_input))
-    {
-        #ifdef BENCHMARK
-        auto start = std::chrono::high_resolution_clock::now();
-        #endif
-
-        Prediction result = predict(feature_input, preprocess);
-
-        #ifdef BENCHMARK
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> duration = end - start;
-        double milliseconds = duration.count();
-        sumduration += milliseconds;
-        sumstrlen += feature_input.length();
-        num_rows++;
-        #endif
-
-        out << result.label << "," << result.probability << std::endl;
-    }
-
-    #ifdef BENCHMARK
-    double avgduration = sumduration / num_rows;
-    cout << "Average Time per Text = " << avgduration << " ms" << endl;
-    double avgstrlen = sumstrlen / num_rows;
-    cout << "Average Length of Text (chars) = " << avgstrlen << endl;
-    #endif
-
-    in.close();
-    out.close();
-}
-
-Prediction KNNClassifier::predict(std::string sentence, bool preprocess)
+Prediction KNNClassifier::predictFeatures(const FeatureVector& features, PredictContext& ctx) const
 {
-    GlobalData vars;
-    std::vector<std::string> processed_input = pVec->buildSentenceVector(sentence, preprocess);
-    std::vector<double> feature_vector = pVec->getSentenceFeatures(processed_input);
-
-    int label = kd_tree.nearestNeighbor(feature_vector);
+    int label = kd_tree.nearestNeighbor(features.data());
 
     // Calculate probability
     double total_distance = 0.0;
-    std::vector<double> closest_distances = kd_tree.getClosestDistances(feature_vector, k);
+    std::pmr::vector<double> closest_distances(ctx.resource());
+    kd_tree.getClosestDistances(features.data(), k, closest_distances);
     for (double dist : closest_distances)
     {
         total_distance += dist;
@@ -163,13 +100,7 @@ int KNNClassifier::getLabel(const std::vector<double>& features) const
 
 double KNNClassifier::calculateDistance(const std::vector<double>& a, const std::vector<double>& b) const
 {
-    double sum = 0.0;
-    for (size_t i = 0; i < a.size(); ++i)
-    {
-        double diff = a[i] - b[i];
-        sum += diff * diff;
-    }
-    return std::sqrt(sum);
+    return std::sqrt(SimdKernels::squaredDistance(a.data(), b.data(), a.size()));
 }
 
 void KNNClassifier::save(const std::string& filename) const
@@ -205,27 +136,29 @@ void KNNClassifier::load(const std::string& filename)
     if (!inFile.is_open())
     {
         std::cerr << "Failed to open file for reading." << std::endl;
+        loaded = false;
         return;
     }
 
     pVec->load(inFile);
 
-    size_t training_features_size;
+    size_t training_features_size = 0;
     inFile.read(reinterpret_cast<char*>(&training_features_size), sizeof(training_features_size));
     training_features.resize(training_features_size);
     for (auto& features : training_features)
     {
-        size_t features_size;
+        size_t features_size = 0;
         inFile.read(reinterpret_cast<char*>(&features_size), sizeof(features_size));
         features.resize(features_size);
         inFile.read(reinterpret_cast<char*>(features.data()), features_size * sizeof(int));
     }
 
-    size_t training_labels_size;
+    size_t training_labels_size = 0;
     inFile.read(reinterpret_cast<char*>(&training_labels_size), sizeof(training_labels_size));
     training_labels.resize(training_labels_size);
     inFile.read(reinterpret_cast<char*>(training_labels.data()), training_labels_size * sizeof(int));
 
+    loaded = !inFile.fail();
     inFile.close();
 
     kd_tree.build(training_features, training_labels);
@@ -32,9 +32,9 @@ class KNNClassifier : public BaseClassifier
 public:
     /**
      * @brief Constructor for KNNClassifier.
-     * @param pvec Pointer to a BaseVectorizer object for feature extraction.
+     * @param pvec Vectorizer for feature extraction, shared with the caller.
      */
-    KNNClassifier(BaseVectorizer* pvec);
+    KNNClassifier(std::shared_ptr<BaseVectorizer> pvec);
     ~KNNClassifier();
 
     /**
@@ -51,18 +51,10 @@ public:
     void fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels) override;
 
     /**
-     * @brief Predict labels for test data.
-     * @param abs_filepath_to_features Absolute file path to the file containing features.
-     * @param abs_filepath_to_labels Absolute file path to the file to save predicted labels.
-     */
-    void predict(std::string abs_filepath_to_features, std::string abs_filepath_to_labels, bool preprocess = true) override;
-
-    /**
-     * @brief Predict label for a single input sentence.
-     * @param sentence Input sentence to predict label for.
-     * @return Prediction object containing predicted label.
+     * @brief Train on sentences vectorised by pVec, see BaseClassifier::fitSentences.
+     * @param sentences Training sentences.
      */
-    Prediction predict(std::string sentence, bool preprocess = true) override;
+    void fitSentences(const std::vector<std::shared_ptr<Sentence>>& sentences) override;
 
     /**
      * @brief Save the model to a file.
@@ -76,6 +68,15 @@ public:
      */
     void load(const std::string& filename) override;
 
+protected:
+    /**
+     * @brief Label a feature vector by its nearest training points.
+     * @param features Feature vector of the sentence.
+     * @param ctx Context providing the scratch memory.
+     * @return Prediction object containing predicted label.
+     */
+    Prediction predictFeatures(const FeatureVector& features, PredictContext& ctx) const override;
+
 private:
     int k; /**< Number of nearest neighbors to consider. */
     std::vector<std::vector<double>> training_features; /**< Training features. */
@@ -0,0 +1,138 @@
+/**
+ * @file LabelDictionary.cpp
+ * @brief Implementation of the LabelDictionary class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "LabelDictionary.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+
+/**
+ * @brief Label without surrounding white space.
+ */
+static std::string_view trimLabel(std::string_view name)
+{
+    const char* space = " \t\r\n";
+    size_t begin = name.find_first_not_of(space);
+    if (begin == std::string_view::npos)
+    {
+        return std::string_view();
+    }
+    size_t end = name.find_last_not_of(space);
+    return name.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief Parse a label as an integer.
+ */
+static bool parseInteger(const std::string& name, long long& value)
+{
+    if (name.empty())
+    {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtoll(name.c_str(), &end, 10);
+    return *end == '\0';
+}
+
+int LabelDictionary::add(std::string_view name)
+{
+    name = trimLabel(name);
+    auto it = index.find(std::string(name));
+    if (it != index.end())
+    {
+        return it->second;
+    }
+    names.emplace_back(name);
+    index[names.back()] = size() - 1;
+    return size() - 1;
+}
+
+int LabelDictionary::find(std::string_view name) const
+{
+    auto it = index.find(std::string(trimLabel(name)));
+    return it == index.end() ? -1 : it->second;
+}
+
+const std::string& LabelDictionary::name(int label) const
+{
+    static const std::string unknown;
+    if (label < 0 || label >= size())
+    {
+        return unknown;
+    }
+    return names[label];
+}
+
+std::vector<int> LabelDictionary::sort()
+{
+    std::vector<long long> values(names.size());
+    bool numeric = true;
+    for (size_t i = 0; i < names.size() && numeric; ++i)
+    {
+        numeric = parseInteger(names[i], values[i]);
+    }
+
+    std::vector<int> order(names.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b)
+    {
+        return numeric ? values[a] < values[b] : names[a] < names[b];
+    });
+
+    std::vector<int> remap(names.size());
+    std::vector<std::string> sorted(names.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        remap[order[i]] = static_cast<int>(i);
+        sorted[i] = names[order[i]];
+        index[sorted[i]] = static_cast<int>(i);
+    }
+    names.swap(sorted);
+    return remap;
+}
+
+void LabelDictionary::clear()
+{
+    names.clear();
+    index.clear();
+}
+
+void LabelDictionary::save(std::ofstream& outFile) const
+{
+    uint32_t count = static_cast<uint32_t>(names.size());
+    outFile.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const auto& name : names)
+    {
+        uint32_t len = static_cast<uint32_t>(name.size());
+        outFile.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        outFile.write(name.data(), len);
+    }
+}
+
+void LabelDictionary::load(std::ifstream& inFile)
+{
+    clear();
+    uint32_t count = 0;
+    inFile.read(reinterpret_cast<char*>(&count), sizeof(count));
+    for (uint32_t i = 0; i < count && inFile; ++i)
+    {
+        uint32_t len = 0;
+        inFile.read(reinterpret_cast<char*>(&len), sizeof(len));
+        std::string name(len, '\0');
+        inFile.read(&name[0], len);
+        add(name);
+    }
+}
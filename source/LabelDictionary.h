@@ -0,0 +1,99 @@
+/**
+ * @file LabelDictionary.h
+ * @brief Mapping between the labels of a training set and class indices.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef LABELDICTIONARY_H__
+#define LABELDICTIONARY_H__
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+
+/**
+ * @class LabelDictionary
+ * @brief Names of the classes of a model, indexed 0 to size() - 1.
+ *
+ * Labels are read as text, so any label, e.g. an intent name, can be used.
+ * Classifiers only see class indices and every weight vector is indexed by
+ * them. After fitting, the names are sorted, numerically if every label is
+ * an integer, so labels 0 and 1 of a binary data set keep indices 0 and 1.
+ * Labels first seen by partial_fit are appended, because sorting would move
+ * the indices of trained classes.
+ */
+class LabelDictionary
+{
+public:
+    /**
+     * @brief Index of a label, added as a new class if unknown.
+     *
+     * Leading and trailing white space of the label is ignored.
+     *
+     * @param name Label as read from a labels file.
+     * @return Class index of the label.
+     */
+    int add(std::string_view name);
+
+    /**
+     * @brief Index of a known label.
+     *
+     * @param name Label to look up.
+     * @return Class index of the label, -1 if unknown.
+     */
+    int find(std::string_view name) const;
+
+    /**
+     * @brief Name of a class.
+     *
+     * @param label Class index.
+     * @return Label of the class, empty for an invalid index.
+     */
+    const std::string& name(int label) const;
+
+    /**
+     * @brief Number of classes.
+     */
+    int size() const { return static_cast<int>(names.size()); }
+
+    /**
+     * @brief Sort the names, numerically if all of them are integers.
+     *
+     * @return New index of every old index.
+     */
+    std::vector<int> sort();
+
+    /**
+     * @brief Forget all labels.
+     */
+    void clear();
+
+    /**
+     * @brief Save the labels to a file.
+     *
+     * @param outFile Output file stream.
+     */
+    void save(std::ofstream& outFile) const;
+
+    /**
+     * @brief Load labels written by save.
+     *
+     * @param inFile Input file stream.
+     */
+    void load(std::ifstream& inFile);
+
+private:
+    std::vector<std::string> names; /**< Label of every class. */
+    std::unordered_map<std::string, int> index; /**< Class index of every label. */
+};
+
+#endif // LABELDICTIONARY_H__
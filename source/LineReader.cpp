@@ -0,0 +1,216 @@
+/**
+ * @file LineReader.cpp
+ * @brief Implementation of the LineReader class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "LineReader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "SimdKernels.h"
+
+LineReader::LineReader()
+    : fd(-1), mapped(false), owns_mapping(false), at_eof(false), begin(nullptr), end(nullptr), pos(nullptr)
+{
+}
+
+LineReader::LineReader(const std::string& abs_filepath)
+    : LineReader()
+{
+    open(abs_filepath);
+}
+
+LineReader::~LineReader()
+{
+    close();
+}
+
+bool LineReader::open(const std::string& abs_filepath)
+{
+    close();
+    int file = ::open(abs_filepath.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+#if !defined(_WIN32)
+    struct stat info;
+    if (fstat(file, &info) == 0 && S_ISREG(info.st_mode))
+    {
+        size_t size = static_cast<size_t>(info.st_size);
+        if (size == 0)
+        {
+            ::close(file);
+            mapped = true;
+            return true;
+        }
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping != MAP_FAILED)
+        {
+            // The mapping keeps the file alive, the descriptor is not needed.
+            ::close(file);
+            madvise(mapping, size, MADV_SEQUENTIAL);
+            begin = pos = static_cast<const char*>(mapping);
+            end = begin + size;
+            mapped = true;
+            owns_mapping = true;
+            return true;
+        }
+    }
+#endif
+
+    fd = file;
+    buffer.resize(LINEREADER_BUFFER_SIZE);
+    begin = pos = end = buffer.data();
+    return true;
+}
+
+void LineReader::assign(std::string_view text)
+{
+    close();
+    begin = pos = text.data();
+    end = text.data() + text.size();
+    mapped = true;
+}
+
+bool LineReader::next(std::string_view& line)
+{
+    for (;;)
+    {
+        size_t len = static_cast<size_t>(end - pos);
+        size_t newline = len ? SimdKernels::findByte(pos, len, '\n') : 0;
+        if (newline < len)
+        {
+            line = std::string_view(pos, newline);
+            pos += newline + 1;
+            return true;
+        }
+        if (mapped || at_eof || fd < 0)
+        {
+            if (len == 0)
+            {
+                return false;
+            }
+            line = std::string_view(pos, len);
+            pos = end;
+            return true;
+        }
+        refill();
+    }
+}
+
+bool LineReader::next(std::string& line)
+{
+    std::string_view view;
+    if (!next(view))
+    {
+        return false;
+    }
+    line.assign(view.data(), view.size());
+    return true;
+}
+
+std::vector<std::string> LineReader::readAll()
+{
+    std::vector<std::string> lines;
+    std::string_view line;
+    while (next(line))
+    {
+        lines.emplace_back(line);
+    }
+    return lines;
+}
+
+bool LineReader::refill()
+{
+    // Keep the start of the unfinished line, grow only when it fills the buffer.
+    size_t pending = static_cast<size_t>(end - pos);
+    if (pending > 0 && pos != buffer.data())
+    {
+        std::memmove(buffer.data(), pos, pending);
+    }
+    if (pending == buffer.size())
+    {
+        buffer.resize(buffer.size() * 2);
+    }
+    begin = pos = buffer.data();
+    end = begin + pending;
+
+    for (;;)
+    {
+        auto n = ::read(fd, buffer.data() + pending, static_cast<unsigned int>(buffer.size() - pending));
+        if (n > 0)
+        {
+            end += n;
+            return true;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        at_eof = true;
+        return false;
+    }
+}
+
+void LineReader::close()
+{
+#if !defined(_WIN32)
+    if (owns_mapping)
+    {
+        munmap(const_cast<char*>(begin), static_cast<size_t>(end - begin));
+    }
+#endif
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+    fd = -1;
+    mapped = false;
+    owns_mapping = false;
+    at_eof = false;
+    begin = end = pos = nullptr;
+    buffer.clear();
+    buffer.shrink_to_fit();
+}
+
+std::vector<std::string_view> LineReader::split(std::string_view text, size_t parts)
+{
+    std::vector<std::string_view> result;
+    parts = std::max<size_t>(parts, 1);
+    size_t start = 0;
+    for (size_t i = 1; i <= parts && start < text.size(); ++i)
+    {
+        size_t cut = text.size();
+        if (i < parts)
+        {
+            // Cut after the first line end at or behind the even share.
+            size_t target = std::max(start, text.size() / parts * i);
+            size_t newline = target + SimdKernels::findByte(text.data() + target, text.size() - target, '\n');
+            cut = std::min(newline + 1, text.size());
+        }
+        result.push_back(text.substr(start, cut - start));
+        start = cut;
+    }
+    return result;
+}
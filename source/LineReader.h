@@ -0,0 +1,145 @@
+/**
+ * @file LineReader.h
+ * @brief Memory mapped line reader for features and labels files.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef LINEREADER_H__
+#define LINEREADER_H__
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define LINEREADER_BUFFER_SIZE  (1 << 20)   /**< Bytes read at once when the file cannot be mapped. */
+
+/**
+ * @class LineReader
+ * @brief Yields the lines of a file as string_views, without a copy per line.
+ *
+ * A regular file is mapped into memory read only and the lines are views into
+ * the mapping, valid until the reader is closed. Anything else, a pipe or a
+ * FIFO, is read with read() into a LINEREADER_BUFFER_SIZE buffer that grows
+ * for longer lines; there a view is valid until the next call to next.
+ *
+ * Lines split exactly as std::getline splits them: at '\n', which is not part
+ * of the line, a '\r' before it is kept, and a last line without '\n' is
+ * still a line. Line ends are found with SimdKernels::findByte.
+ *
+ * A mapped file can be cut at line boundaries with split and every part read
+ * by its own reader, opened with assign, for parallel workers.
+ */
+class LineReader
+{
+public:
+    LineReader();
+
+    /**
+     * @brief Open a file, see open.
+     */
+    explicit LineReader(const std::string& abs_filepath);
+
+    /**
+     * @brief Unmap or close the file.
+     */
+    ~LineReader();
+
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    /**
+     * @brief Open a file for reading, closing the previous one.
+     *
+     * @param abs_filepath Absolute file path.
+     * @return False if the file cannot be opened.
+     */
+    bool open(const std::string& abs_filepath);
+
+    /**
+     * @brief Read lines from text in memory, for example a part returned by split.
+     *
+     * @param text Bytes to read, must outlive the reader.
+     */
+    void assign(std::string_view text);
+
+    /**
+     * @brief Whether a file or text is open.
+     */
+    bool isOpen() const { return mapped || fd >= 0; }
+
+    explicit operator bool() const { return isOpen(); }
+
+    /**
+     * @brief Whether every line is a view into one block of memory, see data.
+     */
+    bool isMapped() const { return mapped; }
+
+    /**
+     * @brief The whole mapped file or assigned text, empty when read from a pipe.
+     */
+    std::string_view data() const { return std::string_view(begin, mapped ? end - begin : 0); }
+
+    /**
+     * @brief Read the next line.
+     *
+     * @param line Set to the line, without its '\n'.
+     * @return False at the end of the file.
+     */
+    bool next(std::string_view& line);
+
+    /**
+     * @brief Read the next line into a string, like std::getline.
+     *
+     * @param line Set to the line, without its '\n'.
+     * @return False at the end of the file.
+     */
+    bool next(std::string& line);
+
+    /**
+     * @brief Read every remaining line.
+     *
+     * @return The lines as strings.
+     */
+    std::vector<std::string> readAll();
+
+    /**
+     * @brief Unmap or close the file, views into a mapping become invalid.
+     */
+    void close();
+
+    /**
+     * @brief Cut text into about equally large parts that end at line ends.
+     *
+     * @param text Text to cut, usually data() of a mapped file.
+     * @param parts Number of parts wanted.
+     * @return At most parts non-empty parts, together exactly text, in order.
+     */
+    static std::vector<std::string_view> split(std::string_view text, size_t parts);
+
+private:
+    int fd; /**< Descriptor read from, -1 when mapped or closed. */
+    bool mapped; /**< Lines are views into [begin, end). */
+    bool owns_mapping; /**< The mapping was made by open and is unmapped by close. */
+    bool at_eof; /**< read() returned 0, only the buffer is left. */
+    const char* begin; /**< Start of the mapping or of the buffered bytes. */
+    const char* end; /**< End of the mapping or of the buffered bytes. */
+    const char* pos; /**< Start of the next line. */
+    std::vector<char> buffer; /**< Buffer of the read() fallback. */
+
+    /**
+     * @brief Move the unread bytes to the front of the buffer and read more behind them.
+     *
+     * @return False if nothing more could be read.
+     */
+    bool refill();
+};
+
+#endif // LINEREADER_H__
@@ -12,25 +12,50 @@ Revision History:
 
 #include <fstream>
 #include <iostream>
+#include <algorithm>
+#include <numeric>
+#include "SimdKernels.h"
 
-LogisticRegressionClassifier::LogisticRegressionClassifier(BaseVectorizer* pvec)
+LogisticRegressionClassifier::LogisticRegressionClassifier(std::shared_ptr<BaseVectorizer> pvec)
 {
     pVec = pvec;
+    seed = RANDOM_DEFAULT_SEED;
+    shuffle = true;
+    weight_precision = WEIGHT_PRECISION_F64;
+    num_classes = 0;
+    bias = 0.0;
 }
 
 LogisticRegressionClassifier::~LogisticRegressionClassifier()
 {
-    delete pVec;
 }
 
-double LogisticRegressionClassifier::predict_proba(const std::vector<double>& features) const
+void LogisticRegressionClassifier::classProbabilities(const std::vector<double>& z, std::vector<double>& probs) const
 {
-    double z = bias;
-    for (size_t i = 0; i < features.size(); ++i) {
-        z += weights[i] * features[i];
+    size_t cols = z.size();
+    if (cols == 1)
+    {
+        probs[1] = 1.0 / (1.0 + exp(-z[0]));
+        probs[0] = 1.0 - probs[1];
+        return;
     }
 
-    return 1.0 / (1.0 + exp(-z));
+    double max_z = 0.0;
+    for (size_t k = 0; k < cols; ++k)
+    {
+        max_z = std::max(max_z, z[k]);
+    }
+    probs[0] = exp(-max_z);
+    double sum = probs[0];
+    for (size_t k = 0; k < cols; ++k)
+    {
+        probs[k + 1] = exp(z[k] - max_z);
+        sum += probs[k + 1];
+    }
+    for (auto& p : probs)
+    {
+        p /= sum;
+    }
 }
 
 void LogisticRegressionClassifier::setHyperparameters(std::string hyperparameters)
@@ -38,23 +63,27 @@ void LogisticRegressionClassifier::setHyperparameters(std::string hyperparameter
     std::string token;
     std::istringstream tokenStream(hyperparameters);
 
-    // "bias=0.0,epochs=15,learning_rate=0.01,l1_regularization_param=0.005,l2_regularization_param=0.0"
+    // "bias=0.0,epochs=15,learning_rate=0.01,l1_regularization_param=0.005,l2_regularization_param=0.0,seed=0,shuffle=1,weight_precision=64"
     bias = 0.0;
     epochs = 15;
     learning_rate = 0.01;
     l1_regularization_param = 0.005;
     l2_regularization_param = 0.0;
+    seed = RANDOM_DEFAULT_SEED;
+    shuffle = true;
+    weight_precision = WEIGHT_PRECISION_F64;
 
     while (std::getline(tokenStream, token, ',')) {
         std::istringstream pairStream(token);
         std::string key;
         double value;
 
+        if (pVec->setOption(token)) {
+            continue;
+        }
         if (std::getline(pairStream, key, '=') && pairStream >> value) {
             cout << key << " = " << value << endl;
-            if (key == "minfrequency") {
-                minfrequency = value;
-            }
+            pVec->setHyperparameter(key, value);
             if (key == "bias") {
                 bias = value;
             }
@@ -70,149 +99,199 @@ void LogisticRegressionClassifier::setHyperparameters(std::string hyperparameter
             else if (key == "l2_regularization_param") {
                 l2_regularization_param = value;
             }
+            else if (key == "seed") {
+                seed = static_cast<uint64_t>(value);
+            }
+            else if (key == "shuffle") {
+                shuffle = value != 0;
+            }
+            else if (key == "weight_precision") {
+                weight_precision = value;
+                if (!QuantizedWeights::isValidPrecision(weight_precision)) {
+                    cout << "WARNING: weight_precision must be 64, 32 or 8, using 64" << endl;
+                    weight_precision = WEIGHT_PRECISION_F64;
+                }
+            }
         }
     }
 }
 
 void LogisticRegressionClassifier::fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels)
 {
-    if (minfrequency > 0)
+    pVec->fit(abs_filepath_to_features, abs_filepath_to_labels);
+    fitSentences(pVec->sentences);
+}
+
+void LogisticRegressionClassifier::fitSentences(const std::vector<std::shared_ptr<Sentence>>& sentences)
+{
+    num_classes = pVec->getClassLabels().size();
+    weights.assign(pVec->getFeatureCount() * columns(), 0.0);
+    biases.assign(columns(), bias);
+
+    train(sentences, 0);
+}
+
+void LogisticRegressionClassifier::partial_fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels)
+{
+    size_t first_sentence = pVec->getSentenceCount();
+    pVec->partial_fit(abs_filepath_to_features, abs_filepath_to_labels);
+
+    // A loaded model only has its packed weights.
+    if (weights.size() != packed_weights.size())
     {
-        pVec->scanForSparseHistogram(abs_filepath_to_features, minfrequency);
+        weights = packed_weights.unpack();
     }
-    pVec->fit(abs_filepath_to_features, abs_filepath_to_labels);
+    resizeWeights();
 
-    size_t num_features = pVec->word_array.size();
-    weights.assign(num_features, 0.0);
+    train(pVec->sentences, first_sentence);
+}
 
-    std::vector<std::shared_ptr<Sentence>> sentences = pVec->sentences;
-    std::vector<int> labels(sentences.size());
+void LogisticRegressionClassifier::prune(double threshold, int top_k)
+{
+    // A loaded model only has its packed weights.
+    if (weights.size() != packed_weights.size())
+    {
+        weights = packed_weights.unpack();
+    }
 
-    std::ifstream label_file(abs_filepath_to_labels);
-    if (!label_file.is_open()) {
-        throw std::runtime_error("Unable to open label file");
+    size_t cols = columns();
+    std::vector<int> old_to_new = selectFeatures(weights, pVec->getFeatureCount(), cols, threshold, top_k);
+    if (!pVec->remapFeatures(old_to_new))
+    {
+        return;
     }
-    for (size_t i = 0; i < labels.size(); ++i)
+    compactRows(weights, cols, old_to_new);
+    packed_weights.pack(weights, weight_precision);
+}
+
+void LogisticRegressionClassifier::resizeWeights()
+{
+    size_t old_cols = columns();
+    size_t old_rows = old_cols ? weights.size() / old_cols : 0;
+    num_classes = pVec->getClassLabels().size();
+    size_t cols = columns();
+    size_t rows = pVec->getFeatureCount();
+
+    if (cols == old_cols)
     {
-        label_file >> labels[i];
+        weights.resize(rows * cols, 0.0);
+        return;
     }
-    label_file.close();
 
+    std::vector<double> grown(rows * cols, 0.0);
+    for (size_t j = 0; j < std::min(rows, old_rows); ++j)
+    {
+        std::copy(weights.begin() + j * old_cols, weights.begin() + (j + 1) * old_cols, grown.begin() + j * cols);
+    }
+    weights.swap(grown);
+    biases.resize(cols, 0.0);
+}
+
+void LogisticRegressionClassifier::train(const std::vector<std::shared_ptr<Sentence>>& sentences, size_t first_sentence)
+{
+    size_t num_sentences = sentences.size() - first_sentence;
+    size_t cols = columns();
+    if (cols == 0)
+    {
+        packed_weights.pack(weights, weight_precision);
+        return;
+    }
+
+    std::vector<double> z(cols);
+    std::vector<double> probs(cols + 1);
+    std::vector<double> errors(cols);
+    std::vector<size_t> order(sentences.size() - first_sentence);
     for (int epoch = 0; epoch < epochs; ++epoch)
     {
         double total_loss = 0.0;
-        for (size_t i = 0; i < sentences.size(); ++i)
+        // Every epoch draws its order from a stream of its own.
+        std::iota(order.begin(), order.end(), first_sentence);
+        if (shuffle)
+        {
+            RandomStream(seed, epoch, first_sentence).shuffle(order);
+        }
+        for (size_t i : order)
         {
             std::vector<double> features;
             const auto& sentence_map = sentences[i]->sentence_map;
             features = pVec->getFrequencies(sentence_map);
-            double y_true = labels[i];
-            double y_false;
-            if (1.0 == y_true)
+            int label = sentences[i]->label;
+
+            z = biases;
+            if (cols == 1)
             {
-                y_false = 0.0;
+                z[0] += SimdKernels::dot(weights.data(), features.data(), features.size());
             }
             else
             {
-                y_false = 1.0;
+                for (size_t j = 0; j < features.size(); ++j)
+                {
+                    if (features[j] != 0.0)
+                    {
+                        SimdKernels::axpy(features[j], weights.data() + j * cols, z.data(), cols);
+                    }
+                }
             }
-            double y_pred = predict_proba(features);
-            double error = y_pred - y_true;
+            classProbabilities(z, probs);
 
-            total_loss += y_true * log(y_pred) + y_false * log(1 - y_pred);
+            total_loss += log(probs[label]);
 
-            for (size_t j = 0; j < features.size(); ++j)
+            for (size_t k = 0; k < cols; ++k)
             {
-                double gradient = error * features[j];
-
-                weights[j] -= learning_rate * (gradient + l1_regularization_param * (weights[j] > 0 ? 1 : -1) + 2 * l2_regularization_param * weights[j]);
+                // Column k holds class k + 1.
+                errors[k] = probs[k + 1] - (label == static_cast<int>(k + 1) ? 1.0 : 0.0);
             }
 
-            bias -= learning_rate * error;
+            updateFeatureRows(features.size(), cols, [&](size_t begin, size_t end)
+            {
+                for (size_t k = 0; k < cols; ++k)
+                {
+                    for (size_t j = begin; j < end; ++j)
+                    {
+                        double& w = weights[j * cols + k];
+                        double gradient = errors[k] * features[j];
+
+                        w -= learning_rate * (gradient + l1_regularization_param * (w > 0 ? 1 : -1) + 2 * l2_regularization_param * w);
+                    }
+                }
+            });
+
+            for (size_t k = 0; k < cols; ++k)
+            {
+                biases[k] -= learning_rate * errors[k];
+            }
         }
-        total_loss = -total_loss / sentences.size();
+        total_loss = -total_loss / num_sentences;
         if (epoch % 100 == 0)
         {
             std::cout << "Epoch " << epoch << " Loss: " << total_loss << std::endl;
         }
     }
+
+    packed_weights.pack(weights, weight_precision);
 }
 
-Prediction LogisticRegressionClassifier::predict(std::string sentence, bool preprocess)
+Prediction LogisticRegressionClassifier::predictFeatures(const FeatureVector& features, PredictContext& ctx) const
 {
-    GlobalData vars;
-    Prediction result;
-    std::vector<string> processed_input = pVec->buildSentenceVector(sentence, preprocess);
-    std::vector<double> feature_vector = pVec->getSentenceFeatures(processed_input);
-    double probability = predict_proba(feature_vector);
-    
-    result.probability = probability;
-
-    if (probability > 0.5)
-    {
-        result.label = vars.POS;
-    }
-    else
-    {
-        result.label = vars.NEG;
-    }
+    // The pivot class keeps a score of zero.
+    FeatureVector scores(num_classes, 0.0, ctx.resource());
+    std::copy(biases.begin(), biases.end(), scores.begin() + 1);
+    packed_weights.addRows(features.data(), features.size(), columns(), scores.data() + 1);
 
-    return result;
+    return softmax(scores.data(), num_classes);
 }
 
-void LogisticRegressionClassifier::predict(std::string abs_filepath_to_features, std::string abs_filepath_to_labels, bool preprocess)
+void LogisticRegressionClassifier::predictSparseBatch(const SparseBatch& batch, std::span<Prediction> results, PredictContext& ctx) const
 {
-    std::ifstream in(abs_filepath_to_features);
-    std::ofstream out(abs_filepath_to_labels);
-    std::string feature_input;
-
-    if (!in)
-    {
-        std::cerr << "ERROR: Cannot open features file.\n";
-        return;
-    }
-
-    if (!out)
-    {
-        std::cerr << "ERROR: Cannot open labels file.\n";
-        return;
-    }
-
-    #ifdef BENCHMARK
-    double sumduration = 0.0;
-    double sumstrlen = 0.0;
-    size_t num_rows = 0;
-    #endif
+    FeatureVector scores(num_classes, 0.0, ctx.resource());
 
-    while (getline(in, feature_input))
+    for (size_t r = 0; r < batch.rows(); ++r)
     {
-        #ifdef BENCHMARK
-        auto start = std::chrono::high_resolution_clock::now();
-        #endif
-
-        Prediction result = predict(feature_input, preprocess);
-
-        #ifdef BENCHMARK
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> duration = end - start;
-        double milliseconds = duration.count();
-        sumduration += milliseconds;
-        sumstrlen += feature_input.length();
-        num_rows++;
-        #endif
-
-        out << result.label << "," << result.probability << std::endl;
+        SparseRow row = batch.row(r);
+        std::copy(biases.begin(), biases.end(), scores.begin() + 1);
+        packed_weights.addRowsSparse(row.idx, row.val, row.nnz, columns(), scores.data() + 1);
+        results[r] = softmax(scores.data(), num_classes);
     }
-
-    #ifdef BENCHMARK
-    double avgduration = sumduration / num_rows;
-    cout << "Average Time per Text = " << avgduration << " ms" << endl;
-    double avgstrlen = sumstrlen / num_rows;
-    cout << "Average Length of Text (chars) = " << avgstrlen << endl;
-    #endif
-
-    in.close();
-    out.close();
 }
 
 void LogisticRegressionClassifier::save(const std::string& filename) const
@@ -226,10 +305,9 @@ void LogisticRegressionClassifier::save(const std::string& filename) const
 
     pVec->save(outFile);
 
-    size_t weight_size = weights.size();
-    outFile.write(reinterpret_cast<const char*>(&weight_size), sizeof(weight_size));
-    outFile.write(reinterpret_cast<const char*>(weights.data()), weight_size * sizeof(double));
-    outFile.write(reinterpret_cast<const char*>(&bias), sizeof(bias));
+    packed_weights.save(outFile);
+    outFile.write(reinterpret_cast<const char*>(&num_classes), sizeof(num_classes));
+    outFile.write(reinterpret_cast<const char*>(biases.data()), biases.size() * sizeof(double));
 
     outFile.close();
 }
@@ -240,16 +318,19 @@ void LogisticRegressionClassifier::load(const std::string& filename)
     if (!inFile.is_open())
     {
         std::cerr << "Failed to open file for reading." << std::endl;
+        loaded = false;
         return;
     }
 
     pVec->load(inFile);
 
-    size_t weight_size;
-    inFile.read(reinterpret_cast<char*>(&weight_size), sizeof(weight_size));
-    weights.resize(weight_size);
-    inFile.read(reinterpret_cast<char*>(weights.data()), weight_size * sizeof(double));
-    inFile.read(reinterpret_cast<char*>(&bias), sizeof(bias));
+    packed_weights.load(inFile);
+    weight_precision = packed_weights.getPrecision();
+    num_classes = 0;
+    inFile.read(reinterpret_cast<char*>(&num_classes), sizeof(num_classes));
+    biases.resize(columns());
+    inFile.read(reinterpret_cast<char*>(biases.data()), biases.size() * sizeof(double));
 
+    loaded = !inFile.fail();
     inFile.close();
 }
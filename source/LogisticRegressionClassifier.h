@@ -19,6 +19,8 @@ Revision History:
 #include <vector>
 #include <cmath>
 #include "BaseClassifier.h"
+#include "QuantizedWeights.h"
+#include "RandomStream.h"
 
 /**
  * @brief Logistic regression classifier implementation.
@@ -27,15 +29,22 @@ Revision History:
  * the probability of a binary outcome using the logistic function:
  * \f[ P(y=1|x) = \frac{1}{1 + e^{-(w \cdot x + b)}} \f]
  * where \f$ w \f$ are the weights, \f$ b \f$ is the bias term, and \f$ x \f$ is the input feature vector.
+ *
+ * With more than two classes this becomes a softmax regression with class 0
+ * as the pivot, which keeps a score of zero:
+ * \f[ P(y=k|x) = \frac{e^{w_k \cdot x + b_k}}{1 + \sum_{j=1}^{C-1} e^{w_j \cdot x + b_j}} \f]
+ * The weights are a features x (C - 1) matrix, so two classes train and
+ * score exactly like the binary model and every class is scored in one pass
+ * over the features.
  */
 class LogisticRegressionClassifier: public BaseClassifier
 {
 public:
     /**
      * @brief Constructor for LogisticRegressionClassifier.
-     * @param pvec Pointer to a BaseVectorizer object for feature extraction.
+     * @param pvec Vectorizer for feature extraction, shared with the caller.
      */
-    LogisticRegressionClassifier(BaseVectorizer* pvec);
+    LogisticRegressionClassifier(std::shared_ptr<BaseVectorizer> pvec);
     ~LogisticRegressionClassifier();
 
     /**
@@ -53,18 +62,32 @@ public:
     void fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels) override;
 
     /**
-     * @brief Predict labels for test data.
-     * @param abs_filepath_to_features Absolute file path to the file containing features.
-     * @param abs_filepath_to_labels Absolute file path to the file to save predicted labels.
+     * @brief Train on sentences vectorised by pVec, see BaseClassifier::fitSentences.
+     * @param sentences Training sentences.
      */
-    void predict(std::string abs_filepath_to_features, std::string abs_filepath_to_labels, bool preprocess = true) override;
+    void fitSentences(const std::vector<std::shared_ptr<Sentence>>& sentences) override;
 
     /**
-     * @brief Predict label for a single input sentence.
-     * @param sentence Input sentence to predict label for.
-     * @return Prediction object containing predicted label.
+     * @brief Continue training from the current weights on new sentences only.
+     *
+     * Weights of new features start at zero. A loaded model continues from
+     * its packed weights, which are exact for weight_precision=64.
+     *
+     * @param abs_filepath_to_features Absolute file path to the file containing the new features.
+     * @param abs_filepath_to_labels Absolute file path to the file containing the new labels.
+     */
+    void partial_fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels) override;
+
+    /**
+     * @brief Drop features with small weights from the vocabulary and the weight matrix.
+     *
+     * A feature counts by the largest |w| over all columns. A loaded model is
+     * pruned from its packed weights and packed again with the same precision.
+     *
+     * @param threshold Largest |w| a feature must exceed to be kept.
+     * @param top_k Maximum number of features kept, 0 for no limit.
      */
-    Prediction predict(std::string sentence, bool preprocess = true) override;
+    void prune(double threshold, int top_k) override;
 
     /**
      * @brief Save the model to a file.
@@ -78,20 +101,66 @@ public:
      */
     void load(const std::string& filename) override;
 
+protected:
+    /**
+     * @brief Score a feature vector with the packed weights.
+     * @param features Feature vector of the sentence.
+     * @param ctx Context providing the scratch memory.
+     * @return Prediction object containing predicted label.
+     */
+    Prediction predictFeatures(const FeatureVector& features, PredictContext& ctx) const override;
+
+    /**
+     * @brief Score a batch with one sparse matrix-vector product.
+     * @param batch Feature vectors of the batch.
+     * @param results Receives one Prediction per row.
+     * @param ctx Context providing the scratch memory.
+     */
+    void predictSparseBatch(const SparseBatch& batch, std::span<Prediction> results, PredictContext& ctx) const override;
+
 private:
-    std::vector<double> weights; /**< Coefficients for features. */
-    double bias; /**< Bias term. */
+    std::vector<double> weights; /**< Coefficients for features x (classes - 1), only kept while training. */
+    QuantizedWeights packed_weights; /**< Coefficients used for scoring. */
+    int weight_precision; /**< Bits per weight when the model is packed (64, 32 or 8). */
+    int num_classes; /**< Number of classes. */
+    std::vector<double> biases; /**< Bias term of every class but the pivot. */
+    double bias; /**< Initial bias term. */
     int epochs; /**< Number of training epochs. */
     double learning_rate; /**< Learning rate for gradient descent. */
     double l1_regularization_param; /**< L1 regularization parameter. */
     double l2_regularization_param; /**< L2 regularization parameter. */
+    uint64_t seed; /**< Seed of the per-epoch shuffles. */
+    bool shuffle; /**< Visit the sentences in a new random order every epoch. */
+
+    /**
+     * @brief Number of weight columns, one per class but the pivot.
+     * @return Number of columns.
+     */
+    size_t columns() const { return num_classes > 1 ? num_classes - 1 : 0; }
+
+    /**
+     * @brief Grow the weights to the features and classes of the vectorizer.
+     *
+     * Existing weights keep their place, new ones start at zero.
+     */
+    void resizeWeights();
+
+    /**
+     * @brief Run the training epochs over sentences from first_sentence on.
+     * @param sentences Sentences vectorised by pVec.
+     * @param first_sentence Index of the first sentence to train on.
+     */
+    void train(const std::vector<std::shared_ptr<Sentence>>& sentences, size_t first_sentence);
 
     /**
-     * @brief Predict class probability for input features using logistic function.
-     * @param features Input features for prediction.
-     * @return Predicted class probability.
+     * @brief Class probabilities from the scores of all classes but the pivot.
+     *
+     * A single column uses the logistic function, as the binary model always has.
+     *
+     * @param z Scores of classes 1 to C - 1.
+     * @param probs Receives the probabilities of all C classes.
      */
-    double predict_proba(const std::vector<double>& features) const;
+    void classProbabilities(const std::vector<double>& z, std::vector<double>& probs) const;
 };
 
 #endif // LOGISTICREGRESSIONCLASSIFIER_H__
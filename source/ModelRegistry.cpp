@@ -0,0 +1,140 @@
+/**
+ * @file ModelRegistry.cpp
+ * @brief Implementation of the ModelRegistry class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "ModelRegistry.h"
+
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+ModelRegistry::Reader::Reader(const ModelRegistry& registry_)
+    : registry(registry_), seen_version(0)
+{
+}
+
+const ModelRegistry::Model& ModelRegistry::Reader::get()
+{
+    uint64_t latest = registry.version();
+    if (latest != seen_version)
+    {
+        // The model is stored before the version is bumped, so this is at
+        // least as new as latest.
+        model = registry.current();
+        seen_version = latest;
+    }
+    return model;
+}
+
+ModelRegistry::ModelRegistry(int vectorizer_id_, int classifier_id_)
+    : vectorizer_id(vectorizer_id_), classifier_id(classifier_id_), model(nullptr), published(0), cache_capacity(0)
+{
+}
+
+ModelRegistry::~ModelRegistry()
+{
+    wait();
+}
+
+bool ModelRegistry::load(const std::string& model_path)
+{
+    std::lock_guard<std::mutex> lock(loader_mutex);
+    Model loaded = build(model_path);
+    if (loaded == nullptr)
+    {
+        return false;
+    }
+    publish(loaded);
+    return true;
+}
+
+void ModelRegistry::loadAsync(const std::string& model_path)
+{
+    wait();
+    pending = std::async(std::launch::async, [this, model_path]() { return load(model_path); });
+}
+
+bool ModelRegistry::wait()
+{
+    if (!pending.valid())
+    {
+        return false;
+    }
+    return pending.get();
+}
+
+void ModelRegistry::publish(Model model_)
+{
+    model.store(std::move(model_), std::memory_order_release);
+    published.fetch_add(1, std::memory_order_release);
+}
+
+ModelRegistry::Model ModelRegistry::current() const
+{
+    return model.load(std::memory_order_acquire);
+}
+
+ModelRegistry::Model ModelRegistry::build(const std::string& model_path) const
+{
+    // Classifier load() only reports a missing file on stderr, so check first.
+    std::ifstream probe(model_path, std::ios::binary | std::ios::ate);
+    if (!probe.is_open() || probe.tellg() <= 0)
+    {
+        std::cerr << "ERROR: Cannot open model file " << model_path << ".\n";
+        return nullptr;
+    }
+    probe.close();
+
+    try
+    {
+        TextClassifierFactory factory;
+        TextClassifierFactory::Product loaded = factory.getTextClassifier(vectorizer_id, classifier_id);
+        if (loaded == nullptr)
+        {
+            std::cerr << "ERROR: Invalid vectorizer id or classifier id.\n";
+            return nullptr;
+        }
+        loaded->load(model_path);
+        if (!loaded->isLoaded())
+        {
+            std::cerr << "ERROR: Model file " << model_path << " is incomplete.\n";
+            return nullptr;
+        }
+
+        int num_classes = loaded->pVec->getClassLabels().size();
+        if (loaded->pVec->getFeatureCount() == 0 || num_classes == 0)
+        {
+            std::cerr << "ERROR: Model " << model_path << " has no features or no classes.\n";
+            return nullptr;
+        }
+
+        // Score a sentence before anyone else can, a model that was cut short
+        // or belongs to another classifier fails here instead of in serving.
+        std::string_view text(MODELREGISTRY_PROBE_TEXT);
+        Prediction result;
+        loaded->predictBatch(std::span<const std::string_view>(&text, 1), std::span<Prediction>(&result, 1));
+        if (result.label < 0 || result.label >= num_classes || !std::isfinite(result.probability))
+        {
+            std::cerr << "ERROR: Model " << model_path << " gives invalid predictions.\n";
+            return nullptr;
+        }
+        loaded->enableCache(cache_capacity.load(std::memory_order_relaxed));
+        return loaded;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: Cannot load model " << model_path << ": " << e.what() << "\n";
+        return nullptr;
+    }
+}
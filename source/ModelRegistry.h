@@ -0,0 +1,177 @@
+/**
+ * @file ModelRegistry.h
+ * @brief Publishes the model of a long running process and swaps it without a restart.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef MODELREGISTRY_H__
+#define MODELREGISTRY_H__
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "TextClassifierFactory.h"
+
+#define MODELREGISTRY_PROBE_TEXT    "model registry probe"  /**< Sentence scored to validate a freshly loaded model. */
+
+/**
+ * @class ModelRegistry
+ * @brief Holds the current model of a vectorizer/classifier pair and replaces it atomically.
+ *
+ * A new model file is loaded into a separate classifier, validated and only
+ * then published, so a broken file never replaces a working model. Publishing
+ * is a single atomic store of a shared_ptr (read-copy-update): predictions
+ * that already hold the old model finish on it and the old model is freed
+ * when the last of them lets go, new predictions see the new model.
+ *
+ * Published models are const, so only the reentrant inference members of
+ * BaseClassifier can be called on them and every thread shares one copy.
+ *
+ * Scoring threads should keep a Reader. Its get() only reads an atomic
+ * counter while the model is unchanged, so the hot path takes no lock and
+ * does not touch the reference count shared by all threads.
+ */
+class ModelRegistry
+{
+public:
+    typedef std::shared_ptr<const BaseClassifier> Model; /**< Shared read-only handle to a published model. */
+
+    /**
+     * @class Reader
+     * @brief Per-thread cached handle to the current model.
+     *
+     * A Reader is not thread safe, every scoring thread needs its own. It
+     * keeps the model it returned last alive until get() is called again
+     * after a swap.
+     */
+    class Reader
+    {
+    public:
+        /**
+         * @brief Create a reader of a registry, which must outlive it.
+         *
+         * @param registry_ Registry to read the model from.
+         */
+        explicit Reader(const ModelRegistry& registry_);
+
+        /**
+         * @brief Current model, refreshed if a new one was published since the last call.
+         *
+         * @return Model to score with, null if none was published yet.
+         */
+        const Model& get();
+
+    private:
+        const ModelRegistry& registry; /**< Registry the model comes from. */
+        uint64_t seen_version; /**< Version of the cached model. */
+        Model model; /**< Cached model. */
+    };
+
+    /**
+     * @brief Create an empty registry for models of one vectorizer and classifier.
+     *
+     * @param vectorizer_id_ Vectorizer id, see ID_VECTORIZER_*.
+     * @param classifier_id_ Classifier id, see ID_CLASSIFIER_*.
+     */
+    ModelRegistry(int vectorizer_id_, int classifier_id_);
+
+    /**
+     * @brief Wait for a background load still running.
+     */
+    ~ModelRegistry();
+
+    ModelRegistry(const ModelRegistry&) = delete;
+    ModelRegistry& operator=(const ModelRegistry&) = delete;
+
+    /**
+     * @brief Load, validate and publish a model file on the calling thread.
+     *
+     * On failure the current model stays published.
+     *
+     * @param model_path Path to a model written by the f command.
+     * @return True if the new model was published.
+     */
+    bool load(const std::string& model_path);
+
+    /**
+     * @brief Load, validate and publish a model file on a background thread.
+     *
+     * Waits for a previous background load first, so loads are published in
+     * the order they were requested. loadAsync and wait are meant to be
+     * called from one controlling thread.
+     *
+     * @param model_path Path to a model written by the f command.
+     */
+    void loadAsync(const std::string& model_path);
+
+    /**
+     * @brief Wait for the last background load.
+     *
+     * @return True if it published its model, false if it failed or none was started.
+     */
+    bool wait();
+
+    /**
+     * @brief Publish a model that was fitted or loaded by the caller.
+     *
+     * @param model_ Model to publish, it must not be modified afterwards.
+     */
+    void publish(Model model_);
+
+    /**
+     * @brief Snapshot of the current model.
+     *
+     * Takes a short internal lock of the shared_ptr, scoring threads should
+     * prefer a Reader.
+     *
+     * @return Current model, null if none was published yet.
+     */
+    Model current() const;
+
+    /**
+     * @brief Give every model loaded from now on a PredictionCache.
+     *
+     * Each model gets its own empty cache, so a swap never serves predictions
+     * of the previous model. The model published already is not changed.
+     *
+     * @param capacity Number of predictions per cache, 0 for none.
+     */
+    void setCacheCapacity(size_t capacity) { cache_capacity.store(capacity, std::memory_order_relaxed); }
+
+    /**
+     * @brief Number of models published so far.
+     *
+     * @return Version of the current model, 0 if none was published yet.
+     */
+    uint64_t version() const { return published.load(std::memory_order_acquire); }
+
+private:
+    int vectorizer_id; /**< Vectorizer of every model. */
+    int classifier_id; /**< Classifier of every model. */
+    std::atomic<Model> model; /**< Current model. */
+    std::atomic<uint64_t> published; /**< Bumped after every store to model. */
+    std::atomic<size_t> cache_capacity; /**< Capacity of the cache of loaded models, 0 for none. */
+    std::mutex loader_mutex; /**< Serialises loads, never taken on the predict path. */
+    std::future<bool> pending; /**< Result of the last background load. */
+
+    /**
+     * @brief Load a model file into a new classifier and check that it can score.
+     *
+     * @param model_path Path to the model file.
+     * @return The loaded model, null if it cannot be used.
+     */
+    Model build(const std::string& model_path) const;
+};
+
+#endif // MODELREGISTRY_H__
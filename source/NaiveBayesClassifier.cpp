@@ -13,15 +13,17 @@ Revision History:
 #include <fstream>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
-NaiveBayesClassifier::NaiveBayesClassifier(BaseVectorizer* pvec)
+NaiveBayesClassifier::NaiveBayesClassifier(std::shared_ptr<BaseVectorizer> pvec)
 {
     pVec = pvec;
+    weight_precision = WEIGHT_PRECISION_F64;
+    num_classes = 0;
 }
 
 NaiveBayesClassifier::~NaiveBayesClassifier()
 {
-    delete pVec;
 }
 
 void NaiveBayesClassifier::setHyperparameters(std::string hyperparameters)
@@ -29,203 +31,165 @@ void NaiveBayesClassifier::setHyperparameters(std::string hyperparameters)
     std::string token;
     std::istringstream tokenStream(hyperparameters);
 
-    // "smoothing_param_m=1.0,smoothing_param_p=0.5"
+    // "smoothing_param_m=1.0,smoothing_param_p=0.5,weight_precision=64"
     smoothing_param_m = 1.0;
 	smoothing_param_p = 0.5;
+    weight_precision = WEIGHT_PRECISION_F64;
 
     while (std::getline(tokenStream, token, ',')) {
         std::istringstream pairStream(token);
         std::string key;
         double value;
 
+        if (pVec->setOption(token)) {
+            continue;
+        }
         if (std::getline(pairStream, key, '=') && pairStream >> value) {
-            cout << key << " = " << value << endl;        
-            if (key == "minfrequency") {
-                minfrequency = value;
-            }
+            cout << key << " = " << value << endl;
+            pVec->setHyperparameter(key, value);
             if (key == "smoothing_param_m") {
                 smoothing_param_m = value;
             }
 			else if (key == "smoothing_param_p") {
                 smoothing_param_p = value;
             }
+            else if (key == "weight_precision") {
+                weight_precision = value;
+                if (!QuantizedWeights::isValidPrecision(weight_precision)) {
+                    cout << "WARNING: weight_precision must be 64, 32 or 8, using 64" << endl;
+                    weight_precision = WEIGHT_PRECISION_F64;
+                }
+            }
         }
     }
 }
 
 void NaiveBayesClassifier::fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels)
 {
-    if (minfrequency > 0)
-    {
-        pVec->scanForSparseHistogram(abs_filepath_to_features, minfrequency);
-    }
     pVec->fit(abs_filepath_to_features, abs_filepath_to_labels);
+    fitSentences(pVec->sentences);
+}
 
-    std::vector<std::shared_ptr<Sentence>> sentences = pVec->sentences;
-    int num_sentences = sentences.size();
+void NaiveBayesClassifier::fitSentences(const std::vector<std::shared_ptr<Sentence>>& sentences)
+{
+    num_classes = 0;
+    class_counts.clear();
+    total_words.clear();
+    word_counts.clear();
+    resizeClasses();
+    countSentences(sentences, 0);
+    updateLogProbabilities();
+}
 
-    int num_pos = 0;
-    int num_neg = 0;
-    std::unordered_map<int, double> word_count_pos;
-    std::unordered_map<int, double> word_count_neg;
-    std::vector<double> tfidf_features_pos;
-    std::vector<double> tfidf_features_neg;
-    int total_words_pos = 0;
-    int total_words_neg = 0;
+void NaiveBayesClassifier::partial_fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels)
+{
+    size_t first_sentence = pVec->getSentenceCount();
+    pVec->partial_fit(abs_filepath_to_features, abs_filepath_to_labels);
 
-    for (const auto& sentence : sentences)
+    resizeClasses();
+    countSentences(pVec->sentences, first_sentence);
+    updateLogProbabilities();
+}
+
+void NaiveBayesClassifier::resizeClasses()
+{
+    num_classes = pVec->getClassLabels().size();
+    class_counts.resize(num_classes, 0);
+    total_words.resize(num_classes, 0.0);
+    word_counts.resize(num_classes);
+}
+
+void NaiveBayesClassifier::countSentences(const std::vector<std::shared_ptr<Sentence>>& sentences, size_t first_sentence)
+{
+    for (size_t i = first_sentence; i < sentences.size(); ++i)
     {
-        if (sentence->label)
+        const auto& sentence = sentences[i];
+        int c = sentence->label;
+        class_counts[c]++;
+        for (const auto& entry : sentence->sentence_map)
         {
-            num_pos++;
-            for (const auto& entry : sentence->sentence_map)
-            {
-                word_count_pos[entry.first] += entry.second;
-                total_words_pos += entry.second;
-            }
-        }
-        else
-        {
-            num_neg++;
-            for (const auto& entry : sentence->sentence_map)
-            {
-                word_count_neg[entry.first] += entry.second;
-                total_words_neg += entry.second;
-            }
+            word_counts[c][entry.first] += std::abs(entry.second);
+            total_words[c] += std::abs(entry.second);
         }
     }
+}
 
-    log_prior_pos = std::log(static_cast<double>(num_pos) / num_sentences);
-    log_prior_neg = std::log(static_cast<double>(num_neg) / num_sentences);
-	double mp = smoothing_param_m * smoothing_param_p;
-    double tfidf_sum_pos = 0.0;
-    double tfidf_sum_neg = 0.0;
+void NaiveBayesClassifier::updateLogProbabilities()
+{
+    int num_sentences = 0;
+    for (int c = 0; c < num_classes; ++c)
+    {
+        num_sentences += class_counts[c];
+    }
 
-    if (ID_VECTORIZER_TFIDF == pVec->this_vectorizer_id) {
-        tfidf_features_pos = pVec->getFrequencies(word_count_pos);
-        tfidf_features_neg = pVec->getFrequencies(word_count_neg);
-        for (const auto& v : tfidf_features_pos)
-        {
-            tfidf_sum_pos += v;
-        }
-        for (const auto& v : tfidf_features_neg)
-        {
-            tfidf_sum_neg += v;
-        }
+    log_priors.assign(num_classes, 0.0);
+    for (int c = 0; c < num_classes; ++c)
+    {
+        log_priors[c] = std::log(static_cast<double>(class_counts[c]) / num_sentences);
     }
+    double mp = smoothing_param_m * smoothing_param_p;
+    unsigned int num_features = pVec->getFeatureCount();
 
-    for (const auto& word : pVec->word_array)
+    // Row-major, the log probabilities of one feature for every class are contiguous.
+    std::vector<double> class_log_probs(static_cast<size_t>(num_features) * num_classes);
+    for (int c = 0; c < num_classes; ++c)
     {
-        int idx = pVec->word_to_idx[word];
         if (ID_VECTORIZER_TFIDF == pVec->this_vectorizer_id) {
-            log_prob_pos[idx] = std::log((tfidf_features_pos[idx] + mp) / (tfidf_sum_pos + smoothing_param_m + pVec->word_array.size()));
-            log_prob_neg[idx] = std::log((tfidf_features_neg[idx] + mp) / (tfidf_sum_neg + smoothing_param_m + pVec->word_array.size()));
+            std::vector<double> tfidf_features = pVec->getFrequencies(word_counts[c]);
+            double tfidf_sum = 0.0;
+            for (const auto& v : tfidf_features)
+            {
+                tfidf_sum += v;
+            }
+            for (unsigned int idx = 0; idx < num_features; ++idx)
+            {
+                class_log_probs[static_cast<size_t>(idx) * num_classes + c] =
+                    std::log((tfidf_features[idx] + mp) / (tfidf_sum + smoothing_param_m + num_features));
+            }
         }
-        else 
+        else
         {
-            log_prob_pos[idx] = std::log((word_count_pos[idx] + mp) / (total_words_pos + smoothing_param_m + pVec->word_array.size()));
-            log_prob_neg[idx] = std::log((word_count_neg[idx] + mp) / (total_words_neg + smoothing_param_m + pVec->word_array.size()));
+            for (unsigned int idx = 0; idx < num_features; ++idx)
+            {
+                auto it = word_counts[c].find(idx);
+                double count = it == word_counts[c].end() ? 0.0 : it->second;
+                class_log_probs[static_cast<size_t>(idx) * num_classes + c] =
+                    std::log((count + mp) / (total_words[c] + smoothing_param_m + num_features));
+            }
         }
     }
+    log_probs.pack(class_log_probs, weight_precision);
 }
 
-double NaiveBayesClassifier::calculate_log_probability(const std::vector<double>& features, bool is_positive) const
+Prediction NaiveBayesClassifier::predictFeatures(const FeatureVector& features, PredictContext& ctx) const
 {
-    double log_prob = is_positive ? log_prior_pos : log_prior_neg;
-    const auto& log_prob_map = is_positive ? log_prob_pos : log_prob_neg;
-
+    FeatureVector counts(features.size(), ctx.resource());
     for (size_t i = 0; i < features.size(); ++i)
     {
-        if (features[i] > 0)
-        {
-            log_prob += std::abs(features[i]) * log_prob_map.at(i);
-        }
-    }
-    return log_prob;
-}
-
-Prediction NaiveBayesClassifier::predict(std::string sentence, bool preprocess)
-{
-    GlobalData vars;
-    Prediction result;
-    std::vector<std::string> processed_input = pVec->buildSentenceVector(sentence, preprocess);
-    std::vector<double> feature_vector = pVec->getSentenceFeatures(processed_input);
-
-    double log_prob_pos = calculate_log_probability(feature_vector, true);
-    double log_prob_neg = calculate_log_probability(feature_vector, false);
-
-    double max_log_prob = std::max(log_prob_pos, log_prob_neg);
-    double exp_log_prob_pos = std::exp(log_prob_pos - max_log_prob);
-    double exp_log_prob_neg = std::exp(log_prob_neg - max_log_prob);
-    double sum_exp_log_probs = exp_log_prob_pos + exp_log_prob_neg;
-
-    result.probability = exp_log_prob_pos / sum_exp_log_probs;
-
-    if (log_prob_pos > log_prob_neg)
-    {
-        result.label = vars.POS;
-    }
-    else
-    {
-        result.label = vars.NEG;
+        counts[i] = std::abs(features[i]);
     }
 
-    return result;
+    FeatureVector scores(log_priors.begin(), log_priors.end(), ctx.resource());
+    log_probs.addRows(counts.data(), counts.size(), num_classes, scores.data());
+    return softmax(scores.data(), num_classes);
 }
 
-void NaiveBayesClassifier::predict(std::string abs_filepath_to_features, std::string abs_filepath_to_labels, bool preprocess)
+void NaiveBayesClassifier::predictSparseBatch(const SparseBatch& batch, std::span<Prediction> results, PredictContext& ctx) const
 {
-    std::ifstream in(abs_filepath_to_features);
-    std::ofstream out(abs_filepath_to_labels);
-    std::string feature_input;
-
-    if (!in)
+    FeatureVector counts(batch.values.size(), ctx.resource());
+    for (size_t i = 0; i < counts.size(); ++i)
     {
-        std::cerr << "ERROR: Cannot open features file.\n";
-        return;
+        counts[i] = std::abs(batch.values[i]);
     }
 
-    if (!out)
+    FeatureVector scores(num_classes, ctx.resource());
+    for (size_t r = 0; r < batch.rows(); ++r)
     {
-        std::cerr << "ERROR: Cannot open labels file.\n";
-        return;
+        SparseRow row = batch.row(r);
+        std::copy(log_priors.begin(), log_priors.end(), scores.begin());
+        log_probs.addRowsSparse(row.idx, counts.data() + batch.row_ptr[r], row.nnz, num_classes, scores.data());
+        results[r] = softmax(scores.data(), num_classes);
     }
-
-    #ifdef BENCHMARK
-    double sumduration = 0.0;
-    double sumstrlen = 0.0;
-    size_t num_rows = 0;
-    #endif
-
-    while (getline(in, feature_input))
-    {  
-        #ifdef BENCHMARK
-        auto start = std::chrono::high_resolution_clock::now();
-        #endif
-        
-        Prediction result = predict(feature_input, preprocess);
-    
-        #ifdef BENCHMARK
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> duration = end - start;
-        double milliseconds = duration.count();
-        sumduration += milliseconds;
-        sumstrlen += feature_input.length();
-        num_rows++;
-        #endif
-
-        out << result.label << "," << result.probability << std::endl;
-    }
-
-    #ifdef BENCHMARK
-    double avgduration = sumduration / num_rows;
-    cout << "Average Time per Text = " << avgduration << " ms" << endl;
-    double avgstrlen = sumstrlen / num_rows;
-    cout << "Average Length of Text (chars) = " << avgstrlen << endl;
-    #endif
-
-    in.close();
-    out.close();
 }
 
 void NaiveBayesClassifier::save(const std::string& filename) const
@@ -239,27 +203,27 @@ void NaiveBayesClassifier::save(const std::string& filename) const
 
     pVec->save(outFile);
 
-    size_t size;
+    log_probs.save(outFile);
 
-    size = log_prob_pos.size();
-    outFile.write(reinterpret_cast<const char*>(&size), sizeof(size));
-    for (const auto& pair : log_prob_pos)
-    {
-        outFile.write(reinterpret_cast<const char*>(&pair.first), sizeof(pair.first));
-        outFile.write(reinterpret_cast<const char*>(&pair.second), sizeof(pair.second));
-    }
+    outFile.write(reinterpret_cast<const char*>(&num_classes), sizeof(num_classes));
+    outFile.write(reinterpret_cast<const char*>(log_priors.data()), num_classes * sizeof(double));
 
-    size = log_prob_neg.size();
-    outFile.write(reinterpret_cast<const char*>(&size), sizeof(size));
-    for (const auto& pair : log_prob_neg)
+    // Class counts, so that partial_fit can continue from this model.
+    outFile.write(reinterpret_cast<const char*>(&smoothing_param_m), sizeof(smoothing_param_m));
+    outFile.write(reinterpret_cast<const char*>(&smoothing_param_p), sizeof(smoothing_param_p));
+    outFile.write(reinterpret_cast<const char*>(class_counts.data()), num_classes * sizeof(int));
+    outFile.write(reinterpret_cast<const char*>(total_words.data()), num_classes * sizeof(double));
+    for (const auto& word_count : word_counts)
     {
-        outFile.write(reinterpret_cast<const char*>(&pair.first), sizeof(pair.first));
-        outFile.write(reinterpret_cast<const char*>(&pair.second), sizeof(pair.second));
+        size_t count_size = word_count.size();
+        outFile.write(reinterpret_cast<const char*>(&count_size), sizeof(count_size));
+        for (const auto& entry : word_count)
+        {
+            outFile.write(reinterpret_cast<const char*>(&entry.first), sizeof(entry.first));
+            outFile.write(reinterpret_cast<const char*>(&entry.second), sizeof(entry.second));
+        }
     }
 
-    outFile.write(reinterpret_cast<const char*>(&log_prior_pos), sizeof(log_prior_pos));
-    outFile.write(reinterpret_cast<const char*>(&log_prior_neg), sizeof(log_prior_neg));
-
     outFile.close();
 }
 
@@ -269,37 +233,42 @@ void NaiveBayesClassifier::load(const std::string& filename)
     if (!inFile.is_open())
     {
         std::cerr << "Failed to open file for reading." << std::endl;
+        loaded = false;
         return;
     }
 
     pVec->load(inFile);
 
-    size_t size;
-
-    inFile.read(reinterpret_cast<char*>(&size), sizeof(size));
-    log_prob_pos.clear();
-    for (size_t i = 0; i < size; ++i)
-    {
-        int key;
-        double value;
-        inFile.read(reinterpret_cast<char*>(&key), sizeof(key));
-        inFile.read(reinterpret_cast<char*>(&value), sizeof(value));
-        log_prob_pos[key] = value;
-    }
-
-    inFile.read(reinterpret_cast<char*>(&size), sizeof(size));
-    log_prob_neg.clear();
-    for (size_t i = 0; i < size; ++i)
+    log_probs.load(inFile);
+    weight_precision = log_probs.getPrecision();
+
+    num_classes = 0;
+    inFile.read(reinterpret_cast<char*>(&num_classes), sizeof(num_classes));
+    log_priors.resize(num_classes);
+    inFile.read(reinterpret_cast<char*>(log_priors.data()), num_classes * sizeof(double));
+
+    inFile.read(reinterpret_cast<char*>(&smoothing_param_m), sizeof(smoothing_param_m));
+    inFile.read(reinterpret_cast<char*>(&smoothing_param_p), sizeof(smoothing_param_p));
+    class_counts.resize(num_classes);
+    total_words.resize(num_classes);
+    word_counts.assign(num_classes, {});
+    inFile.read(reinterpret_cast<char*>(class_counts.data()), num_classes * sizeof(int));
+    inFile.read(reinterpret_cast<char*>(total_words.data()), num_classes * sizeof(double));
+    for (auto& word_count : word_counts)
     {
-        int key;
-        double value;
-        inFile.read(reinterpret_cast<char*>(&key), sizeof(key));
-        inFile.read(reinterpret_cast<char*>(&value), sizeof(value));
-        log_prob_neg[key] = value;
+        size_t count_size = 0;
+        inFile.read(reinterpret_cast<char*>(&count_size), sizeof(count_size));
+        word_count.reserve(count_size);
+        for (size_t i = 0; i < count_size && inFile; ++i)
+        {
+            int key;
+            double value;
+            inFile.read(reinterpret_cast<char*>(&key), sizeof(key));
+            inFile.read(reinterpret_cast<char*>(&value), sizeof(value));
+            word_count[key] = value;
+        }
     }
 
-    inFile.read(reinterpret_cast<char*>(&log_prior_pos), sizeof(log_prior_pos));
-    inFile.read(reinterpret_cast<char*>(&log_prior_neg), sizeof(log_prior_neg));
-
+    loaded = !inFile.fail();
     inFile.close();
 }
@@ -19,6 +19,7 @@ Revision History:
 #include <vector>
 #include <unordered_map>
 #include "BaseClassifier.h"
+#include "QuantizedWeights.h"
 
 /**
  * @brief Naive Bayes classifier implementation.
@@ -29,15 +30,19 @@ Revision History:
  * \f[ P(y|x) \propto P(y) \prod_{i=1}^{n} P(x_i|y) \f]
  * where \f$ P(y) \f$ is the prior probability of class \f$ y \f$,
  * and \f$ P(x_i|y) \f$ is the conditional probability of feature \f$ x_i \f$ given class \f$ y \f$.
+ *
+ * Any number of classes is supported (multinomial naive Bayes). The log
+ * probabilities are kept as one features x classes matrix, so a sentence is
+ * scored against every class in a single pass over its features.
  */
 class NaiveBayesClassifier : public BaseClassifier
 {
 public:
     /**
      * @brief Constructor for NaiveBayesClassifier.
-     * @param pvec Pointer to a BaseVectorizer object for feature extraction.
+     * @param pvec Vectorizer for feature extraction, shared with the caller.
      */
-    NaiveBayesClassifier(BaseVectorizer* pvec);
+    NaiveBayesClassifier(std::shared_ptr<BaseVectorizer> pvec);
     ~NaiveBayesClassifier();
 
     /**
@@ -55,18 +60,20 @@ public:
     void fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels) override;
 
     /**
-     * @brief Predict labels for test data.
-     * @param abs_filepath_to_features Absolute file path to the file containing features.
-     * @param abs_filepath_to_labels Absolute file path to the file to save predicted labels.
+     * @brief Train on sentences vectorised by pVec, see BaseClassifier::fitSentences.
+     * @param sentences Training sentences.
      */
-    void predict(std::string abs_filepath_to_features, std::string abs_filepath_to_labels, bool preprocess = true) override;
+    void fitSentences(const std::vector<std::shared_ptr<Sentence>>& sentences) override;
 
     /**
-     * @brief Predict label for a single input sentence.
-     * @param sentence Input sentence to predict label for.
-     * @return Prediction object containing predicted label.
+     * @brief Add the counts of new sentences and recompute the log probabilities.
+     *
+     * Gives the same model as fitting on the old and new data together.
+     *
+     * @param abs_filepath_to_features Absolute file path to the file containing the new features.
+     * @param abs_filepath_to_labels Absolute file path to the file containing the new labels.
      */
-    Prediction predict(std::string sentence, bool preprocess = true) override;
+    void partial_fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels) override;
 
     /**
      * @brief Save the model to a file.
@@ -80,21 +87,50 @@ public:
      */
     void load(const std::string& filename) override;
 
+protected:
+    /**
+     * @brief Score a feature vector with the class log probabilities.
+     * @param features Feature vector of the sentence.
+     * @param ctx Context providing the scratch memory.
+     * @return Prediction object containing predicted label.
+     */
+    Prediction predictFeatures(const FeatureVector& features, PredictContext& ctx) const override;
+
+    /**
+     * @brief Score a batch with one pass over the features of every row.
+     * @param batch Feature vectors of the batch.
+     * @param results Receives one Prediction per row.
+     * @param ctx Context providing the scratch memory.
+     */
+    void predictSparseBatch(const SparseBatch& batch, std::span<Prediction> results, PredictContext& ctx) const override;
+
 private:
     double smoothing_param_m; /**< Laplace smoothing parameter. */
 	double smoothing_param_p; /**< Laplace smoothing parameter. */
-    std::unordered_map<int, double> log_prob_pos; /**< Log probabilities for positive class. */
-    std::unordered_map<int, double> log_prob_neg; /**< Log probabilities for negative class. */
-    double log_prior_pos; /**< Log prior probability for positive class. */
-    double log_prior_neg; /**< Log prior probability for negative class. */
+    int weight_precision; /**< Bits per log probability when the model is packed (64, 32 or 8). */
+    int num_classes; /**< Number of classes. */
+    QuantizedWeights log_probs; /**< Log probability of every feature and class, features x classes. */
+    std::vector<double> log_priors; /**< Log prior probability of every class. */
+    std::vector<int> class_counts; /**< Number of sentences seen per class. */
+    std::vector<double> total_words; /**< Sum of the feature counts of the sentences of every class. */
+    std::vector<std::unordered_map<int, double>> word_counts; /**< Count of every feature in the sentences of every class. */
+
+    /**
+     * @brief Add the feature counts of sentences to the class counts.
+     * @param sentences Sentences vectorised by pVec.
+     * @param first_sentence Index of the first sentence not counted yet.
+     */
+    void countSentences(const std::vector<std::shared_ptr<Sentence>>& sentences, size_t first_sentence);
+
+    /**
+     * @brief Compute the priors and log probabilities from the class counts.
+     */
+    void updateLogProbabilities();
 
     /**
-     * @brief Calculate the log probability of features given the class label.
-     * @param features Input features for prediction.
-     * @param is_positive Whether the class label is positive.
-     * @return Log probability.
+     * @brief Grow the class counts to the number of labels of the vectorizer.
      */
-    double calculate_log_probability(const std::vector<double>& features, bool is_positive) const;
+    void resizeClasses();
 };
 
 #endif // NAIVEBAYESCLASSIFIER_H__
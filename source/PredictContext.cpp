@@ -0,0 +1,38 @@
+/**
+ * @file PredictContext.cpp
+ * @brief Implementation of the PredictContext and PredictScope classes.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "PredictContext.h"
+
+PredictContext::PredictContext()
+{
+    depth = 0;
+}
+
+PredictContext& PredictContext::local()
+{
+    thread_local PredictContext ctx;
+    return ctx;
+}
+
+PredictScope::PredictScope(PredictContext& ctx_) : ctx(ctx_)
+{
+    ctx.depth++;
+}
+
+PredictScope::~PredictScope()
+{
+    if (--ctx.depth == 0)
+    {
+        ctx.arena.reset();
+    }
+}
@@ -0,0 +1,141 @@
+/**
+ * @file PredictContext.h
+ * @brief Per-thread scratch state shared by the tokenizer, vectorizers and classifiers.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef PREDICTCONTEXT_H__
+#define PREDICTCONTEXT_H__
+
+#include <string_view>
+#include <vector>
+#include <memory_resource>
+#include <algorithm>
+
+#include "Arena.h"
+
+typedef std::pmr::vector<std::string_view> TokenList; /**< Tokens pointing into arena memory. */
+typedef std::pmr::vector<double> FeatureVector; /**< Feature vector living in the arena. */
+
+/**
+ * @brief One row of a SparseBatch, non-zero features sorted by index.
+ */
+struct SparseRow
+{
+    const int* idx; /**< Indices of the non-zero features, ascending. */
+    const double* val; /**< Values of the non-zero features. */
+    size_t nnz; /**< Number of non-zero features. */
+
+    /**
+     * @brief Value of a feature, found by binary search.
+     *
+     * @param col Index of the feature.
+     * @return Value of the feature, 0 if it is not stored.
+     */
+    double operator[](int col) const
+    {
+        const int* it = std::lower_bound(idx, idx + nnz, col);
+        return (it != idx + nnz && *it == col) ? val[it - idx] : 0.0;
+    }
+};
+
+/**
+ * @brief Feature vectors of a batch of sentences in CSR layout.
+ *
+ * Row r owns the entries [row_ptr[r], row_ptr[r + 1]) of col_idx and values.
+ * All three arrays live in the arena of a PredictContext.
+ */
+struct SparseBatch
+{
+    /**
+     * @brief Constructor for an empty batch.
+     *
+     * @param mr Memory resource of the arrays.
+     */
+    explicit SparseBatch(std::pmr::memory_resource* mr) : row_ptr(mr), col_idx(mr), values(mr)
+    {
+        row_ptr.push_back(0);
+    }
+
+    /**
+     * @brief Number of rows.
+     */
+    size_t rows() const { return row_ptr.size() - 1; }
+
+    /**
+     * @brief View of one row.
+     *
+     * @param r Index of the row.
+     * @return Indices and values of the row.
+     */
+    SparseRow row(size_t r) const
+    {
+        return { col_idx.data() + row_ptr[r], values.data() + row_ptr[r], row_ptr[r + 1] - row_ptr[r] };
+    }
+
+    std::pmr::vector<size_t> row_ptr; /**< Start of every row, plus the end of the last one. */
+    std::pmr::vector<int> col_idx; /**< Feature indices. */
+    std::pmr::vector<double> values; /**< Feature values. */
+};
+
+/**
+ * @class PredictContext
+ * @brief Scratch memory of one prediction.
+ *
+ * Everything a prediction needs temporarily (the normalised text, the
+ * tokens, the feature vector, hash tables) is allocated from the arena of the
+ * context of the calling thread, which is reset once the prediction is done.
+ * In steady state a prediction therefore never calls malloc.
+ */
+class PredictContext
+{
+public:
+    PredictContext();
+
+    /**
+     * @brief Context of the calling thread.
+     *
+     * @return Thread local context.
+     */
+    static PredictContext& local();
+
+    /**
+     * @brief Memory resource to construct pmr containers with.
+     */
+    std::pmr::memory_resource* resource() { return &arena; }
+
+    Arena arena; /**< Scratch memory, reset after each prediction. */
+
+private:
+    friend class PredictScope;
+    int depth; /**< Number of open PredictScopes. */
+};
+
+/**
+ * @class PredictScope
+ * @brief Resets the arena of a context when the outermost scope ends.
+ *
+ * Containers allocated from the arena must be declared after the scope so
+ * that they are destroyed before the arena is reset.
+ */
+class PredictScope
+{
+public:
+    explicit PredictScope(PredictContext& ctx_);
+    ~PredictScope();
+
+    PredictScope(const PredictScope&) = delete;
+    PredictScope& operator=(const PredictScope&) = delete;
+
+private:
+    PredictContext& ctx;
+};
+
+#endif // PREDICTCONTEXT_H__
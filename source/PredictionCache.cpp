@@ -0,0 +1,179 @@
+/**
+ * @file PredictionCache.cpp
+ * @brief Implementation of the PredictionCache class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "PredictionCache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "BaseClassifier.h"
+#include "FeatureHash.h"
+
+PredictionCache::PredictionCache(size_t capacity)
+    : shards(PREDICTIONCACHE_SHARDS)
+{
+    shard_capacity = std::max<size_t>(1, (capacity + PREDICTIONCACHE_SHARDS - 1) / PREDICTIONCACHE_SHARDS);
+
+    // Keep the index at most half full so probe sequences stay short.
+    size_t index_size = 1;
+    while (index_size < 2 * shard_capacity)
+    {
+        index_size <<= 1;
+    }
+    index_mask = index_size - 1;
+
+    for (auto& shard : shards)
+    {
+        shard.slots.resize(shard_capacity);
+        shard.index.assign(index_size, -1);
+    }
+}
+
+uint64_t PredictionCache::key(std::string_view text, uint64_t model_tag)
+{
+    return mixHash(hashBytes(text.data(), text.size()) ^ model_tag);
+}
+
+uint64_t PredictionCache::modelTag(const char* vers_info)
+{
+    return hashBytes(vers_info, std::strlen(vers_info));
+}
+
+bool PredictionCache::find(uint64_t key, Prediction& result)
+{
+    Shard& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    int32_t slot = shard.index[probe(shard, key)];
+    if (slot < 0)
+    {
+        shard.misses++;
+        return false;
+    }
+    Slot& entry = shard.slots[slot];
+    entry.referenced = true;
+    result.label = entry.label;
+    result.probability = entry.probability;
+    shard.hits++;
+    return true;
+}
+
+void PredictionCache::insert(uint64_t key, const Prediction& result)
+{
+    Shard& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    size_t pos = probe(shard, key);
+    if (shard.index[pos] >= 0)
+    {
+        // Another thread scored the same text meanwhile.
+        return;
+    }
+
+    size_t slot;
+    if (shard.used < shard_capacity)
+    {
+        slot = shard.used++;
+    }
+    else
+    {
+        // CLOCK: clear reference bits until an entry without one comes up.
+        while (shard.slots[shard.hand].referenced)
+        {
+            shard.slots[shard.hand].referenced = false;
+            shard.hand = (shard.hand + 1) % shard_capacity;
+        }
+        slot = shard.hand;
+        shard.hand = (shard.hand + 1) % shard_capacity;
+        erase(shard, probe(shard, shard.slots[slot].key));
+        pos = probe(shard, key);
+    }
+
+    shard.slots[slot] = { key, result.label, result.probability, false };
+    shard.index[pos] = static_cast<int32_t>(slot);
+}
+
+void PredictionCache::clear()
+{
+    for (auto& shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::fill(shard.index.begin(), shard.index.end(), -1);
+        shard.used = 0;
+        shard.hand = 0;
+    }
+}
+
+uint64_t PredictionCache::hits() const
+{
+    uint64_t total = 0;
+    for (const auto& shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.hits;
+    }
+    return total;
+}
+
+uint64_t PredictionCache::misses() const
+{
+    uint64_t total = 0;
+    for (const auto& shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.misses;
+    }
+    return total;
+}
+
+size_t PredictionCache::size() const
+{
+    size_t total = 0;
+    for (const auto& shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.used;
+    }
+    return total;
+}
+
+size_t PredictionCache::probe(const Shard& shard, uint64_t key) const
+{
+    size_t pos = key & index_mask;
+    while (shard.index[pos] >= 0 && shard.slots[shard.index[pos]].key != key)
+    {
+        pos = (pos + 1) & index_mask;
+    }
+    return pos;
+}
+
+void PredictionCache::erase(Shard& shard, size_t pos)
+{
+    // Move later entries of the probe run back into the gap, unless that
+    // would put them before their home position.
+    size_t next = pos;
+    for (;;)
+    {
+        next = (next + 1) & index_mask;
+        int32_t slot = shard.index[next];
+        if (slot < 0)
+        {
+            break;
+        }
+        size_t home = shard.slots[slot].key & index_mask;
+        if (((next - home) & index_mask) >= ((next - pos) & index_mask))
+        {
+            shard.index[pos] = slot;
+            pos = next;
+        }
+    }
+    shard.index[pos] = -1;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file PredictionCache.h
+ * @brief Sharded CLOCK cache of predictions keyed by the hash of the normalised text.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef PREDICTIONCACHE_H__
+#define PREDICTIONCACHE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#define PREDICTIONCACHE_SHARD_BITS  4                                   /**< Top key bits that pick the shard. */
+#define PREDICTIONCACHE_SHARDS      (1 << PREDICTIONCACHE_SHARD_BITS)   /**< Independently locked parts of the cache. */
+
+struct Prediction;
+
+/**
+ * @class PredictionCache
+ * @brief Remembers the predictions of texts that were scored before.
+ *
+ * Entries are keyed by a 64-bit hash of the normalised text mixed with a
+ * hash of the model version (vers_info), so a cache never answers for a
+ * model with another version. Two different texts with the same 64-bit hash
+ * would share an entry, at about 1 in 2^64 per pair this is ignored.
+ *
+ * The cache is split into PREDICTIONCACHE_SHARDS shards picked by the top
+ * bits of the key, each with its own mutex, so threads scoring different
+ * texts rarely wait for each other. A shard evicts with the CLOCK algorithm:
+ * a hit only sets a reference bit, and the clock hand gives every entry a
+ * second chance before it is replaced. Slots and the open addressing index
+ * are allocated once, lookups and inserts never call malloc.
+ *
+ * All members are thread safe.
+ */
+class PredictionCache
+{
+public:
+    /**
+     * @brief Create an empty cache.
+     *
+     * @param capacity Number of predictions kept, at least one per shard.
+     */
+    explicit PredictionCache(size_t capacity);
+
+    PredictionCache(const PredictionCache&) = delete;
+    PredictionCache& operator=(const PredictionCache&) = delete;
+
+    /**
+     * @brief Key of a normalised text for a model version.
+     *
+     * @param text Text as returned by BaseVectorizer::normalize.
+     * @param model_tag Hash of the model version, see modelTag.
+     * @return Cache key.
+     */
+    static uint64_t key(std::string_view text, uint64_t model_tag);
+
+    /**
+     * @brief Hash of a model version string.
+     *
+     * @param vers_info Version string, NUL terminated.
+     * @return Tag to pass to key.
+     */
+    static uint64_t modelTag(const char* vers_info);
+
+    /**
+     * @brief Look up a prediction and count a hit or a miss.
+     *
+     * @param key Cache key.
+     * @param result Receives the cached prediction on a hit.
+     * @return True on a hit.
+     */
+    bool find(uint64_t key, Prediction& result);
+
+    /**
+     * @brief Store a prediction, evicting an entry of the shard if it is full.
+     *
+     * @param key Cache key.
+     * @param result Prediction to store.
+     */
+    void insert(uint64_t key, const Prediction& result);
+
+    /**
+     * @brief Remove every entry, the counters are kept.
+     */
+    void clear();
+
+    /**
+     * @brief Number of lookups that found a prediction.
+     */
+    uint64_t hits() const;
+
+    /**
+     * @brief Number of lookups that found nothing.
+     */
+    uint64_t misses() const;
+
+    /**
+     * @brief Number of predictions stored.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Maximum number of predictions stored.
+     */
+    size_t capacity() const { return shard_capacity * PREDICTIONCACHE_SHARDS; }
+
+private:
+    /**
+     * @struct Slot
+     * @brief One cached prediction.
+     */
+    struct Slot
+    {
+        uint64_t key;           /**< Cache key. */
+        int label;              /**< Prediction::label. */
+        double probability;     /**< Prediction::probability. */
+        bool referenced;        /**< Set on a hit, cleared when the clock hand passes. */
+    };
+
+    /**
+     * @struct Shard
+     * @brief Independently locked part of the cache, on its own cache lines.
+     */
+    struct alignas(64) Shard
+    {
+        mutable std::mutex mutex;       /**< Guards the fields below. */
+        std::vector<Slot> slots;        /**< Entries, the first used ones are filled. */
+        std::vector<int32_t> index;     /**< Open addressing table of slot numbers, -1 when empty. */
+        size_t used = 0;                /**< Filled slots. */
+        size_t hand = 0;                /**< Next slot the clock looks at. */
+        uint64_t hits = 0;              /**< Lookups that found an entry. */
+        uint64_t misses = 0;            /**< Lookups that found nothing. */
+    };
+
+    size_t shard_capacity; /**< Slots per shard. */
+    size_t index_mask; /**< Size of each index minus one. */
+    std::vector<Shard> shards; /**< The shards. */
+
+    /**
+     * @brief Shard holding a key, picked by its top bits.
+     */
+    Shard& shardOf(uint64_t key) { return shards[key >> (64 - PREDICTIONCACHE_SHARD_BITS)]; }
+
+    /**
+     * @brief Position of a key in the index of a shard.
+     *
+     * @return Position holding the key, or the empty position ending its probe sequence.
+     */
+    size_t probe(const Shard& shard, uint64_t key) const;
+
+    /**
+     * @brief Remove the entry at an index position, closing the gap with backward shifting.
+     */
+    void erase(Shard& shard, size_t pos);
+};
+
+#endif // PREDICTIONCACHE_H__
@@ -0,0 +1,495 @@
+/**
+ * @file PredictionWriter.cpp
+ * @brief Implementation of the PredictionWriter class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "PredictionWriter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+
+#include "BaseClassifier.h"
+
+// Arrow metadata constants, see Schema.fbs and Message.fbs of the Arrow format.
+#define ARROW_METADATA_V5               4
+#define ARROW_HEADER_SCHEMA             1
+#define ARROW_HEADER_DICTIONARY_BATCH   2
+#define ARROW_HEADER_RECORD_BATCH       3
+#define ARROW_TYPE_FLOATING_POINT       3
+#define ARROW_TYPE_UTF8                 5
+#define ARROW_PRECISION_SINGLE          1
+#define ARROW_CONTINUATION              0xFFFFFFFFu
+
+/**
+ * @class FlatBufferBuilder
+ * @brief Just enough of a flatbuffers builder to write Arrow metadata.
+ *
+ * Like the real builder it works back to front: an object is prepended to
+ * the buffer and known by its distance from the end, so everything it refers
+ * to must be created before it. Tables are built one at a time.
+ */
+class FlatBufferBuilder
+{
+public:
+    typedef uint32_t Offset; /**< Distance of an object from the end of the buffer. */
+
+    template <typename T>
+    void push(T value)
+    {
+        preAlign(sizeof(T), sizeof(T));
+        uint8_t raw[sizeof(T)];
+        std::memcpy(raw, &value, sizeof(T));
+        bytes.insert(bytes.begin(), raw, raw + sizeof(T));
+    }
+
+    Offset createString(std::string_view s)
+    {
+        preAlign(s.size() + 1, 4);
+        bytes.insert(bytes.begin(), 1, 0);
+        bytes.insert(bytes.begin(), s.begin(), s.end());
+        push<uint32_t>(static_cast<uint32_t>(s.size()));
+        return size();
+    }
+
+    /**
+     * @brief Vector of structs made of int64 fields, e.g. FieldNode and Buffer.
+     */
+    Offset createStructVector(const std::vector<int64_t>& fields, size_t fields_per_struct)
+    {
+        size_t len = fields.size() * sizeof(int64_t);
+        preAlign(len, 4);
+        preAlign(len, sizeof(int64_t));
+        const uint8_t* raw = reinterpret_cast<const uint8_t*>(fields.data());
+        bytes.insert(bytes.begin(), raw, raw + len);
+        push<uint32_t>(static_cast<uint32_t>(fields.size() / fields_per_struct));
+        return size();
+    }
+
+    Offset createOffsetVector(const std::vector<Offset>& items)
+    {
+        preAlign(items.size() * sizeof(uint32_t), 4);
+        for (size_t i = items.size(); i-- > 0;)
+        {
+            pushOffset(items[i]);
+        }
+        push<uint32_t>(static_cast<uint32_t>(items.size()));
+        return size();
+    }
+
+    void startTable()
+    {
+        fields.clear();
+        table_start = size();
+    }
+
+    template <typename T>
+    void addField(int id, T value)
+    {
+        push(value);
+        fields.emplace_back(id, size());
+    }
+
+    void addOffsetField(int id, Offset target)
+    {
+        pushOffset(target);
+        fields.emplace_back(id, size());
+    }
+
+    Offset endTable()
+    {
+        push<int32_t>(0);
+        Offset table = size();
+
+        int slots = 0;
+        for (const auto& field : fields)
+        {
+            slots = std::max(slots, field.first + 1);
+        }
+        std::vector<uint16_t> vtable(2 + slots, 0);
+        vtable[0] = static_cast<uint16_t>(vtable.size() * sizeof(uint16_t));
+        vtable[1] = static_cast<uint16_t>(table - table_start);
+        for (const auto& field : fields)
+        {
+            vtable[2 + field.first] = static_cast<uint16_t>(table - field.second);
+        }
+        for (size_t i = vtable.size(); i-- > 0;)
+        {
+            push<uint16_t>(vtable[i]);
+        }
+
+        // The table starts with the signed distance back to its vtable.
+        int32_t to_vtable = static_cast<int32_t>(size() - table);
+        std::memcpy(bytes.data() + size() - table, &to_vtable, sizeof(to_vtable));
+        return table;
+    }
+
+    std::vector<uint8_t> finish(Offset root)
+    {
+        preAlign(sizeof(uint32_t), max_align);
+        pushOffset(root);
+        return bytes;
+    }
+
+private:
+    std::vector<uint8_t> bytes;
+    std::vector<std::pair<int, Offset>> fields;
+    Offset table_start = 0;
+    size_t max_align = 1;
+
+    Offset size() const { return static_cast<Offset>(bytes.size()); }
+
+    /**
+     * @brief Pad so that the size is aligned once len more bytes are prepended.
+     */
+    void preAlign(size_t len, size_t alignment)
+    {
+        max_align = std::max(max_align, alignment);
+        bytes.insert(bytes.begin(), (alignment - (bytes.size() + len) % alignment) % alignment, 0);
+    }
+
+    void pushOffset(Offset target)
+    {
+        preAlign(sizeof(uint32_t), sizeof(uint32_t));
+        push<uint32_t>(size() + sizeof(uint32_t) - target);
+    }
+};
+
+/**
+ * @brief Buffers and field nodes of an Arrow message body being assembled.
+ */
+struct ArrowBody
+{
+    std::vector<uint8_t> bytes;
+    std::vector<int64_t> buffers; /**< Offset and length of every buffer. */
+    std::vector<int64_t> nodes; /**< Length and null count of every column. */
+
+    void addBuffer(const void* data, size_t len)
+    {
+        buffers.push_back(static_cast<int64_t>(bytes.size()));
+        buffers.push_back(static_cast<int64_t>(len));
+        const uint8_t* raw = static_cast<const uint8_t*>(data);
+        bytes.insert(bytes.end(), raw, raw + len);
+        bytes.resize((bytes.size() + 7) & ~static_cast<size_t>(7), 0);
+    }
+
+    void addNode(int64_t length, int64_t null_count)
+    {
+        nodes.push_back(length);
+        nodes.push_back(null_count);
+    }
+};
+
+/**
+ * @brief RecordBatch table describing a body.
+ */
+static FlatBufferBuilder::Offset arrowRecordBatch(FlatBufferBuilder& fbb, int64_t rows, const ArrowBody& body)
+{
+    FlatBufferBuilder::Offset nodes = fbb.createStructVector(body.nodes, 2);
+    FlatBufferBuilder::Offset buffers = fbb.createStructVector(body.buffers, 2);
+    fbb.startTable();
+    fbb.addField<int64_t>(0, rows);
+    fbb.addOffsetField(1, nodes);
+    fbb.addOffsetField(2, buffers);
+    return fbb.endTable();
+}
+
+/**
+ * @brief Message table around a header, finished.
+ */
+static std::vector<uint8_t> arrowMessage(FlatBufferBuilder& fbb, uint8_t header_type, FlatBufferBuilder::Offset header, int64_t body_length)
+{
+    fbb.startTable();
+    fbb.addField<int64_t>(3, body_length);
+    fbb.addOffsetField(2, header);
+    fbb.addField<int16_t>(0, ARROW_METADATA_V5);
+    fbb.addField<uint8_t>(1, header_type);
+    return fbb.finish(fbb.endTable());
+}
+
+PredictionWriter::PredictionWriter(const LabelDictionary& labels_, int format_)
+    : labels(labels_), format(format_), used(0)
+{
+    label_bytes = labels.size() <= 128 ? 1 : labels.size() <= 32768 ? 2 : 4;
+}
+
+PredictionWriter::~PredictionWriter()
+{
+    close();
+}
+
+int PredictionWriter::formatFromPath(const std::string& abs_filepath)
+{
+    auto ends_with = [&abs_filepath](const char* suffix)
+    {
+        size_t n = std::strlen(suffix);
+        return abs_filepath.size() >= n && abs_filepath.compare(abs_filepath.size() - n, n, suffix) == 0;
+    };
+    if (ends_with(".arrow") || ends_with(".arrows"))
+    {
+        return PREDICTION_FORMAT_ARROW;
+    }
+    if (ends_with(".bin"))
+    {
+        return PREDICTION_FORMAT_BINARY;
+    }
+    return PREDICTION_FORMAT_TEXT;
+}
+
+bool PredictionWriter::open(const std::string& abs_filepath)
+{
+    close();
+    out.open(abs_filepath, std::ios::binary);
+    if (!out)
+    {
+        return false;
+    }
+    buffer.resize(PREDICTIONWRITER_BUFFER_SIZE);
+    used = 0;
+
+    if (format == PREDICTION_FORMAT_BINARY)
+    {
+        uint32_t num_classes = static_cast<uint32_t>(labels.size());
+        uint32_t width = static_cast<uint32_t>(label_bytes);
+        append(PREDICTIONWRITER_BINARY_MAGIC, 8);
+        append(&num_classes, sizeof(num_classes));
+        append(&width, sizeof(width));
+        for (int c = 0; c < labels.size(); ++c)
+        {
+            uint32_t len = static_cast<uint32_t>(labels.name(c).size());
+            append(&len, sizeof(len));
+            append(labels.name(c).data(), len);
+        }
+    }
+    else if (format == PREDICTION_FORMAT_ARROW)
+    {
+        batch_labels.reserve(PREDICTIONWRITER_ARROW_BATCH_ROWS);
+        batch_probabilities.reserve(PREDICTIONWRITER_ARROW_BATCH_ROWS);
+        writeArrowHeader();
+    }
+    return true;
+}
+
+void PredictionWriter::write(std::span<const Prediction> predictions)
+{
+    if (!isOpen())
+    {
+        return;
+    }
+
+    if (format == PREDICTION_FORMAT_ARROW)
+    {
+        for (const auto& prediction : predictions)
+        {
+            bool known = prediction.label >= 0 && prediction.label < labels.size();
+            batch_labels.push_back(known ? prediction.label : -1);
+            batch_probabilities.push_back(static_cast<float>(prediction.probability));
+            if (batch_labels.size() == PREDICTIONWRITER_ARROW_BATCH_ROWS)
+            {
+                writeArrowBatch();
+            }
+        }
+        return;
+    }
+
+    if (format == PREDICTION_FORMAT_BINARY)
+    {
+        char row[sizeof(int32_t) + sizeof(float)];
+        for (const auto& prediction : predictions)
+        {
+            // Little endian, so the low bytes of the index are its narrow form.
+            int32_t label = prediction.label >= 0 && prediction.label < labels.size() ? prediction.label : -1;
+            float probability = static_cast<float>(prediction.probability);
+            std::memcpy(row, &label, label_bytes);
+            std::memcpy(row + label_bytes, &probability, sizeof(probability));
+            append(row, label_bytes + sizeof(probability));
+        }
+        return;
+    }
+
+    char number[32];
+    for (const auto& prediction : predictions)
+    {
+        // Six significant digits in general notation is what operator<< prints.
+        const std::string& name = labels.name(prediction.label);
+        char* end = std::to_chars(number, number + sizeof(number), prediction.probability, std::chars_format::general, 6).ptr;
+        *end++ = '\n';
+        if (used + name.size() + 1 + (end - number) > buffer.size())
+        {
+            flush();
+        }
+        append(name.data(), name.size());
+        buffer[used++] = ',';
+        append(number, end - number);
+    }
+}
+
+bool PredictionWriter::close()
+{
+    if (!isOpen())
+    {
+        return true;
+    }
+    if (format == PREDICTION_FORMAT_ARROW)
+    {
+        if (!batch_labels.empty())
+        {
+            writeArrowBatch();
+        }
+        uint32_t end_of_stream[2] = { ARROW_CONTINUATION, 0 };
+        append(end_of_stream, sizeof(end_of_stream));
+    }
+    flush();
+    out.close();
+    bool ok = !out.fail();
+    buffer.clear();
+    buffer.shrink_to_fit();
+    batch_labels.clear();
+    batch_probabilities.clear();
+    return ok;
+}
+
+void PredictionWriter::flush()
+{
+    out.write(buffer.data(), used);
+    used = 0;
+}
+
+void PredictionWriter::append(const void* data, size_t len)
+{
+    if (used + len > buffer.size())
+    {
+        flush();
+        if (len > buffer.size())
+        {
+            out.write(static_cast<const char*>(data), len);
+            return;
+        }
+    }
+    std::memcpy(buffer.data() + used, data, len);
+    used += len;
+}
+
+void PredictionWriter::writeArrowHeader()
+{
+    FlatBufferBuilder fbb;
+    FlatBufferBuilder::Offset children = fbb.createOffsetVector({});
+
+    fbb.startTable();
+    fbb.addField<int32_t>(0, label_bytes * 8);
+    fbb.addField<uint8_t>(1, 1);
+    FlatBufferBuilder::Offset index_type = fbb.endTable();
+    fbb.startTable();
+    fbb.addField<int64_t>(0, 0);
+    fbb.addOffsetField(1, index_type);
+    FlatBufferBuilder::Offset dictionary = fbb.endTable();
+    fbb.startTable();
+    FlatBufferBuilder::Offset utf8 = fbb.endTable();
+    FlatBufferBuilder::Offset label_name = fbb.createString("label");
+    fbb.startTable();
+    fbb.addOffsetField(0, label_name);
+    fbb.addOffsetField(3, utf8);
+    fbb.addOffsetField(4, dictionary);
+    fbb.addOffsetField(5, children);
+    fbb.addField<uint8_t>(1, 1);
+    fbb.addField<uint8_t>(2, ARROW_TYPE_UTF8);
+    FlatBufferBuilder::Offset label_field = fbb.endTable();
+
+    fbb.startTable();
+    fbb.addField<int16_t>(0, ARROW_PRECISION_SINGLE);
+    FlatBufferBuilder::Offset single = fbb.endTable();
+    FlatBufferBuilder::Offset probability_name = fbb.createString("probability");
+    fbb.startTable();
+    fbb.addOffsetField(0, probability_name);
+    fbb.addOffsetField(3, single);
+    fbb.addOffsetField(5, children);
+    fbb.addField<uint8_t>(1, 0);
+    fbb.addField<uint8_t>(2, ARROW_TYPE_FLOATING_POINT);
+    FlatBufferBuilder::Offset probability_field = fbb.endTable();
+
+    FlatBufferBuilder::Offset fields = fbb.createOffsetVector({ label_field, probability_field });
+    fbb.startTable();
+    fbb.addOffsetField(1, fields);
+    fbb.addField<int16_t>(0, 0);
+    FlatBufferBuilder::Offset schema = fbb.endTable();
+    writeArrowMessage(arrowMessage(fbb, ARROW_HEADER_SCHEMA, schema, 0), std::vector<uint8_t>());
+
+    // The dictionary of the label column is the list of class names.
+    ArrowBody body;
+    std::vector<int32_t> offsets(1, 0);
+    std::string names;
+    for (int c = 0; c < labels.size(); ++c)
+    {
+        names += labels.name(c);
+        offsets.push_back(static_cast<int32_t>(names.size()));
+    }
+    body.addNode(labels.size(), 0);
+    body.addBuffer(nullptr, 0);
+    body.addBuffer(offsets.data(), offsets.size() * sizeof(int32_t));
+    body.addBuffer(names.data(), names.size());
+
+    FlatBufferBuilder dictionary_fbb;
+    FlatBufferBuilder::Offset data = arrowRecordBatch(dictionary_fbb, labels.size(), body);
+    dictionary_fbb.startTable();
+    dictionary_fbb.addField<int64_t>(0, 0);
+    dictionary_fbb.addOffsetField(1, data);
+    FlatBufferBuilder::Offset batch = dictionary_fbb.endTable();
+    writeArrowMessage(arrowMessage(dictionary_fbb, ARROW_HEADER_DICTIONARY_BATCH, batch, body.bytes.size()), body.bytes);
+}
+
+void PredictionWriter::writeArrowBatch()
+{
+    const size_t rows = batch_labels.size();
+    ArrowBody body;
+
+    // Unknown labels are nulls, the validity bitmap is left out when there are none.
+    std::vector<uint8_t> validity((rows + 7) / 8, 0);
+    size_t nulls = 0;
+    std::vector<uint8_t> indices(rows * label_bytes);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        int32_t label = batch_labels[i];
+        if (label < 0)
+        {
+            nulls++;
+            label = 0;
+        }
+        else
+        {
+            validity[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+        }
+        std::memcpy(indices.data() + i * label_bytes, &label, label_bytes);
+    }
+    body.addNode(rows, nulls);
+    body.addBuffer(validity.data(), nulls ? validity.size() : 0);
+    body.addBuffer(indices.data(), indices.size());
+    body.addNode(rows, 0);
+    body.addBuffer(nullptr, 0);
+    body.addBuffer(batch_probabilities.data(), rows * sizeof(float));
+
+    FlatBufferBuilder fbb;
+    FlatBufferBuilder::Offset batch = arrowRecordBatch(fbb, rows, body);
+    writeArrowMessage(arrowMessage(fbb, ARROW_HEADER_RECORD_BATCH, batch, body.bytes.size()), body.bytes);
+    batch_labels.clear();
+    batch_probabilities.clear();
+}
+
+void PredictionWriter::writeArrowMessage(const std::vector<uint8_t>& metadata, const std::vector<uint8_t>& body)
+{
+    // Continuation marker and length, then the metadata padded so the body starts 8 byte aligned.
+    static const uint8_t padding[8] = {};
+    uint32_t prefix[2] = { ARROW_CONTINUATION, static_cast<uint32_t>((metadata.size() + 7) & ~static_cast<size_t>(7)) };
+    append(prefix, sizeof(prefix));
+    append(metadata.data(), metadata.size());
+    append(padding, prefix[1] - metadata.size());
+    append(body.data(), body.size());
+}
@@ -0,0 +1,154 @@
+/**
+ * @file PredictionWriter.h
+ * @brief Buffered writer of predictions as text, packed binary or an Arrow IPC stream.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef PREDICTIONWRITER_H__
+#define PREDICTIONWRITER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "LabelDictionary.h"
+
+struct Prediction;
+
+#define PREDICTION_FORMAT_TEXT              0           /**< "label,probability" lines. */
+#define PREDICTION_FORMAT_BINARY            1           /**< Header with the class names, then packed label index + float32 rows. */
+#define PREDICTION_FORMAT_ARROW             2           /**< Arrow IPC stream, see PredictionWriter. */
+
+#define PREDICTIONWRITER_BUFFER_SIZE        (1 << 20)   /**< Bytes collected before a write to the file. */
+#define PREDICTIONWRITER_ARROW_BATCH_ROWS   65536       /**< Rows per Arrow record batch. */
+#define PREDICTIONWRITER_BINARY_MAGIC       "TCPRED01"  /**< First 8 bytes of a binary predictions file. */
+
+/**
+ * @class PredictionWriter
+ * @brief Writes the predictions of a file to another file, in large blocks.
+ *
+ * Rows are formatted into a PREDICTIONWRITER_BUFFER_SIZE buffer, which is
+ * written out when full, numbers with std::to_chars. Three formats:
+ *
+ * - text: one "label,probability" line per prediction. The probability has
+ *   6 significant digits, as the stream operator prints it, so the output is
+ *   the same as before the writer existed.
+ * - binary: the magic PREDICTIONWRITER_BINARY_MAGIC, the number of classes
+ *   and the width of a label index in bytes (uint32 each), every class name
+ *   as a uint32 length and its bytes, then one row per prediction: the label
+ *   index as a signed integer of that width and the probability as float32,
+ *   packed and little endian. The width is 1 for up to 128 classes, 2 for up
+ *   to 32768 and 4 beyond.
+ * - arrow: an Arrow IPC stream (version 5, little endian) with the columns
+ *   label, dictionary encoded with the class names as utf8 values and signed
+ *   indices of the width above, and probability, float32. Rows are written in
+ *   record batches of PREDICTIONWRITER_ARROW_BATCH_ROWS. pyarrow reads it
+ *   with pyarrow.ipc.open_stream, and so does every other Arrow reader.
+ *
+ * An unknown label, index -1, is an empty name in text, -1 in binary and null
+ * in Arrow.
+ */
+class PredictionWriter
+{
+public:
+    /**
+     * @brief Create a writer for the predictions of a model.
+     *
+     * @param labels_ Names of the classes of the model, must outlive the writer.
+     * @param format_ One of PREDICTION_FORMAT_*.
+     */
+    explicit PredictionWriter(const LabelDictionary& labels_, int format_ = PREDICTION_FORMAT_TEXT);
+
+    /**
+     * @brief Close the file if it is still open.
+     */
+    ~PredictionWriter();
+
+    PredictionWriter(const PredictionWriter&) = delete;
+    PredictionWriter& operator=(const PredictionWriter&) = delete;
+
+    /**
+     * @brief Create the output file and write the header of the format.
+     *
+     * @param abs_filepath Absolute file path to write to.
+     * @return False if the file cannot be created.
+     */
+    bool open(const std::string& abs_filepath);
+
+    /**
+     * @brief Whether a file is open.
+     */
+    bool isOpen() const { return out.is_open(); }
+
+    /**
+     * @brief Add predictions to the file.
+     *
+     * @param predictions Predictions in the order of their texts.
+     */
+    void write(std::span<const Prediction> predictions);
+
+    /**
+     * @brief Write out the buffered rows and the end of the format, then close the file.
+     *
+     * @return False if anything could not be written.
+     */
+    bool close();
+
+    /**
+     * @brief Format matching the extension of a file name.
+     *
+     * @param abs_filepath File path.
+     * @return PREDICTION_FORMAT_ARROW for .arrow and .arrows, PREDICTION_FORMAT_BINARY for .bin, PREDICTION_FORMAT_TEXT otherwise.
+     */
+    static int formatFromPath(const std::string& abs_filepath);
+
+private:
+    const LabelDictionary& labels; /**< Class names. */
+    int format; /**< One of PREDICTION_FORMAT_*. */
+    int label_bytes; /**< Width of a label index in the binary and Arrow formats. */
+    std::ofstream out; /**< Output file. */
+    std::vector<char> buffer; /**< Formatted rows not yet written. */
+    size_t used; /**< Bytes of buffer in use. */
+    std::vector<int32_t> batch_labels; /**< Label column of the Arrow batch being collected. */
+    std::vector<float> batch_probabilities; /**< Probability column of the Arrow batch being collected. */
+
+    /**
+     * @brief Write out the buffer.
+     */
+    void flush();
+
+    /**
+     * @brief Append bytes to the buffer, writing it out first if they do not fit.
+     */
+    void append(const void* data, size_t len);
+
+    /**
+     * @brief Write the schema and the dictionary of class names of the Arrow stream.
+     */
+    void writeArrowHeader();
+
+    /**
+     * @brief Write the collected rows as one Arrow record batch.
+     */
+    void writeArrowBatch();
+
+    /**
+     * @brief Write one encapsulated Arrow message, its metadata followed by its body.
+     *
+     * @param metadata Flatbuffer of the Message.
+     * @param body Buffers of the message, each padded to 8 bytes.
+     */
+    void writeArrowMessage(const std::vector<uint8_t>& metadata, const std::vector<uint8_t>& body);
+};
+
+#endif // PREDICTIONWRITER_H__
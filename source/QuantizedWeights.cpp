@@ -0,0 +1,347 @@
+/**
+ * @file QuantizedWeights.cpp
+ * @brief Implementation of the QuantizedWeights class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "QuantizedWeights.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+QuantizedWeights::QuantizedWeights()
+{
+    precision = WEIGHT_PRECISION_F64;
+    count = 0;
+}
+
+bool QuantizedWeights::isValidPrecision(int precision_)
+{
+    return precision_ == WEIGHT_PRECISION_F64 || precision_ == WEIGHT_PRECISION_F32 || precision_ == WEIGHT_PRECISION_U8;
+}
+
+void QuantizedWeights::pack(const std::vector<double>& weights, int precision_)
+{
+    if (!isValidPrecision(precision_))
+    {
+        std::cerr << "WARNING: Unsupported weight precision " << precision_ << ", keeping doubles." << std::endl;
+        precision_ = WEIGHT_PRECISION_F64;
+    }
+
+    precision = precision_;
+    count = weights.size();
+    f64.clear();
+    f32.clear();
+    codes.clear();
+    block_scale.clear();
+    block_offset.clear();
+
+    if (precision == WEIGHT_PRECISION_F64)
+    {
+        f64 = weights;
+    }
+    else if (precision == WEIGHT_PRECISION_F32)
+    {
+        f32.assign(weights.begin(), weights.end());
+    }
+    else
+    {
+        size_t num_blocks = (count + WEIGHT_BLOCK_SIZE - 1) / WEIGHT_BLOCK_SIZE;
+        codes.resize(count);
+        block_scale.resize(num_blocks);
+        block_offset.resize(num_blocks);
+
+        for (size_t b = 0; b < num_blocks; ++b)
+        {
+            size_t begin = b * WEIGHT_BLOCK_SIZE;
+            size_t end = std::min(begin + WEIGHT_BLOCK_SIZE, count);
+            auto range = std::minmax_element(weights.begin() + begin, weights.begin() + end);
+            float lo = static_cast<float>(*range.first);
+            float scale = static_cast<float>((*range.second - *range.first) / 255.0);
+
+            block_offset[b] = lo;
+            block_scale[b] = scale;
+            for (size_t i = begin; i < end; ++i)
+            {
+                double q = scale > 0.0f ? std::round((weights[i] - lo) / scale) : 0.0;
+                codes[i] = static_cast<uint8_t>(std::min(255.0, std::max(0.0, q)));
+            }
+        }
+    }
+}
+
+std::vector<double> QuantizedWeights::unpack() const
+{
+    std::vector<double> weights(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        weights[i] = at(i);
+    }
+    return weights;
+}
+
+double QuantizedWeights::at(size_t i) const
+{
+    if (precision == WEIGHT_PRECISION_F64)
+    {
+        return f64[i];
+    }
+    if (precision == WEIGHT_PRECISION_F32)
+    {
+        return f32[i];
+    }
+    size_t b = i / WEIGHT_BLOCK_SIZE;
+    return block_offset[b] + block_scale[b] * codes[i];
+}
+
+double QuantizedWeights::dot(const double* features, size_t n) const
+{
+    n = std::min(n, count);
+    if (precision == WEIGHT_PRECISION_F64)
+    {
+        return SimdKernels::dot(f64.data(), features, n);
+    }
+    if (precision == WEIGHT_PRECISION_F32)
+    {
+        return SimdKernels::dotF32(features, f32.data(), n);
+    }
+    return SimdKernels::dotU8(features, codes.data(), block_scale.data(), block_offset.data(), n);
+}
+
+double QuantizedWeights::dotSparse(const int* idx, const double* val, size_t nnz) const
+{
+    if (precision == WEIGHT_PRECISION_F64)
+    {
+        return SimdKernels::dotSparse(idx, val, nnz, f64.data());
+    }
+    if (precision == WEIGHT_PRECISION_F32)
+    {
+        return SimdKernels::dotSparseF32(idx, val, nnz, f32.data());
+    }
+    return SimdKernels::dotSparseU8(idx, val, nnz, codes.data(), block_scale.data(), block_offset.data());
+}
+
+/**
+ * @brief Add rows of a weight matrix with a fixed number of columns.
+ *
+ * With the width known at compile time the columns stay in registers and
+ * two rows are kept in flight, which beats a kernel call per row for the
+ * few classes most models have.
+ *
+ * @param weight Returns the weight at a flat index of the matrix.
+ */
+template <size_t Cols, typename Weight>
+static void addRowsFixed(const int* idx, const double* val, size_t nnz, const Weight& weight, double* scores)
+{
+    double sums0[Cols] = {};
+    double sums1[Cols] = {};
+    size_t i = 0;
+    for (; i + 2 <= nnz; i += 2)
+    {
+        size_t row0 = static_cast<size_t>(idx[i]) * Cols;
+        size_t row1 = static_cast<size_t>(idx[i + 1]) * Cols;
+        for (size_t c = 0; c < Cols; ++c)
+        {
+            sums0[c] += val[i] * weight(row0 + c);
+            sums1[c] += val[i + 1] * weight(row1 + c);
+        }
+    }
+    if (i < nnz)
+    {
+        size_t row = static_cast<size_t>(idx[i]) * Cols;
+        for (size_t c = 0; c < Cols; ++c)
+        {
+            sums0[c] += val[i] * weight(row + c);
+        }
+    }
+    for (size_t c = 0; c < Cols; ++c)
+    {
+        scores[c] += sums0[c] + sums1[c];
+    }
+}
+
+/**
+ * @brief Add narrow rows of a weight matrix without going through a kernel.
+ *
+ * @return False if cols is too wide and the kernels should be used.
+ */
+template <typename Weight>
+static bool addRowsInline(const int* idx, const double* val, size_t nnz, size_t cols, const Weight& weight, double* scores)
+{
+    switch (cols)
+    {
+    case 2: addRowsFixed<2>(idx, val, nnz, weight, scores); return true;
+    case 3: addRowsFixed<3>(idx, val, nnz, weight, scores); return true;
+    case 4: addRowsFixed<4>(idx, val, nnz, weight, scores); return true;
+    case 5: addRowsFixed<5>(idx, val, nnz, weight, scores); return true;
+    case 6: addRowsFixed<6>(idx, val, nnz, weight, scores); return true;
+    case 7: addRowsFixed<7>(idx, val, nnz, weight, scores); return true;
+    case 8: addRowsFixed<8>(idx, val, nnz, weight, scores); return true;
+    default: return false;
+    }
+}
+
+void QuantizedWeights::addRowsSparse(const int* idx, const double* val, size_t nnz, size_t cols, double* scores) const
+{
+    if (cols == 0)
+    {
+        return;
+    }
+
+    // A single column is a plain dot product, which has faster kernels.
+    if (cols == 1)
+    {
+        scores[0] += dotSparse(idx, val, nnz);
+        return;
+    }
+
+    // Narrow rows are shorter than the cost of a kernel call, so they are
+    // added here where the compiler can unroll them.
+    bool added;
+    if (precision == WEIGHT_PRECISION_F64)
+    {
+        const double* w = f64.data();
+        added = addRowsInline(idx, val, nnz, cols, [w](size_t k) { return w[k]; }, scores);
+    }
+    else if (precision == WEIGHT_PRECISION_F32)
+    {
+        const float* w = f32.data();
+        added = addRowsInline(idx, val, nnz, cols, [w](size_t k) { return static_cast<double>(w[k]); }, scores);
+    }
+    else
+    {
+        const uint8_t* q = codes.data();
+        const float* scale = block_scale.data();
+        const float* offset = block_offset.data();
+        added = addRowsInline(idx, val, nnz, cols, [q, scale, offset](size_t k)
+        {
+            size_t b = k / WEIGHT_BLOCK_SIZE;
+            return static_cast<double>(offset[b]) + static_cast<double>(scale[b]) * q[k];
+        }, scores);
+    }
+    if (added)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < nnz; ++i)
+    {
+        size_t row = static_cast<size_t>(idx[i]) * cols;
+        if (precision == WEIGHT_PRECISION_F64)
+        {
+            SimdKernels::axpy(val[i], f64.data() + row, scores, cols);
+        }
+        else if (precision == WEIGHT_PRECISION_F32)
+        {
+            SimdKernels::axpyF32(val[i], f32.data() + row, scores, cols);
+        }
+        else
+        {
+            for (size_t c = 0; c < cols; ++c)
+            {
+                size_t b = (row + c) / WEIGHT_BLOCK_SIZE;
+                scores[c] += val[i] * (block_offset[b] + block_scale[b] * codes[row + c]);
+            }
+        }
+    }
+}
+
+void QuantizedWeights::addRows(const double* features, size_t n, size_t cols, double* scores) const
+{
+    if (cols == 0)
+    {
+        return;
+    }
+
+    n = std::min(n, count / cols);
+    if (cols == 1)
+    {
+        scores[0] += dot(features, n);
+        return;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (features[i] != 0.0)
+        {
+            int idx = static_cast<int>(i);
+            addRowsSparse(&idx, features + i, 1, cols, scores);
+        }
+    }
+}
+
+size_t QuantizedWeights::bytes() const
+{
+    return f64.size() * sizeof(double) + f32.size() * sizeof(float) + codes.size() +
+           (block_scale.size() + block_offset.size()) * sizeof(float);
+}
+
+void QuantizedWeights::save(std::ofstream& outFile) const
+{
+    outFile.write(reinterpret_cast<const char*>(&precision), sizeof(precision));
+    outFile.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+    if (precision == WEIGHT_PRECISION_F64)
+    {
+        outFile.write(reinterpret_cast<const char*>(f64.data()), count * sizeof(double));
+    }
+    else if (precision == WEIGHT_PRECISION_F32)
+    {
+        outFile.write(reinterpret_cast<const char*>(f32.data()), count * sizeof(float));
+    }
+    else
+    {
+        size_t num_blocks = block_scale.size();
+        outFile.write(reinterpret_cast<const char*>(codes.data()), count);
+        outFile.write(reinterpret_cast<const char*>(block_scale.data()), num_blocks * sizeof(float));
+        outFile.write(reinterpret_cast<const char*>(block_offset.data()), num_blocks * sizeof(float));
+    }
+}
+
+void QuantizedWeights::load(std::ifstream& inFile)
+{
+    precision = 0;
+    count = 0;
+    inFile.read(reinterpret_cast<char*>(&precision), sizeof(precision));
+    inFile.read(reinterpret_cast<char*>(&count), sizeof(count));
+    f64.clear();
+    f32.clear();
+    codes.clear();
+    block_scale.clear();
+    block_offset.clear();
+
+    if (precision == WEIGHT_PRECISION_F64)
+    {
+        f64.resize(count);
+        inFile.read(reinterpret_cast<char*>(f64.data()), count * sizeof(double));
+    }
+    else if (precision == WEIGHT_PRECISION_F32)
+    {
+        f32.resize(count);
+        inFile.read(reinterpret_cast<char*>(f32.data()), count * sizeof(float));
+    }
+    else if (precision == WEIGHT_PRECISION_U8)
+    {
+        size_t num_blocks = (count + WEIGHT_BLOCK_SIZE - 1) / WEIGHT_BLOCK_SIZE;
+        codes.resize(count);
+        block_scale.resize(num_blocks);
+        block_offset.resize(num_blocks);
+        inFile.read(reinterpret_cast<char*>(codes.data()), count);
+        inFile.read(reinterpret_cast<char*>(block_scale.data()), num_blocks * sizeof(float));
+        inFile.read(reinterpret_cast<char*>(block_offset.data()), num_blocks * sizeof(float));
+    }
+    else
+    {
+        std::cerr << "ERROR: Unknown weight precision " << precision << " in model file." << std::endl;
+        precision = WEIGHT_PRECISION_F64;
+        count = 0;
+    }
+}
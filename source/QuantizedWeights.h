@@ -0,0 +1,171 @@
+/**
+ * @file QuantizedWeights.h
+ * @brief Weight vector stored as float64, float32 or 8-bit block quantised values.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef QUANTIZEDWEIGHTS_H__
+#define QUANTIZEDWEIGHTS_H__
+
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "SimdKernels.h"
+
+#define WEIGHT_PRECISION_F64    64
+#define WEIGHT_PRECISION_F32    32
+#define WEIGHT_PRECISION_U8     8
+#define WEIGHT_BLOCK_SIZE       SIMDKERNELS_QUANT_BLOCK
+
+/**
+ * @class QuantizedWeights
+ * @brief Read-only weight vector used on the scoring path of linear models.
+ *
+ * Training always happens in double precision. Once a model is trained the
+ * weights are packed into one of three precisions:
+ * - 64: plain doubles, bit-identical to the trained model.
+ * - 32: floats, half the size, relative error of at most 2^-24 per weight.
+ * - 8: one byte per weight plus a float scale and offset per block of
+ *   WEIGHT_BLOCK_SIZE weights, about 1/7 of the size. Every block is mapped
+ *   affinely onto [0, 255]:
+ *   \f[ w_i \approx \text{offset}_b + \text{scale}_b \cdot q_i,\quad
+ *       \text{scale}_b = \frac{\max_b - \min_b}{255} \f]
+ *   so the error per weight is at most scale_b / 2.
+ *
+ * Dot products are computed directly on the packed representation by the
+ * SimdKernels, the weights are never expanded back to doubles.
+ */
+class QuantizedWeights
+{
+public:
+    /**
+     * @brief Default constructor, an empty float64 vector.
+     */
+    QuantizedWeights();
+
+    /**
+     * @brief Pack a vector of weights.
+     *
+     * @param weights Weights in double precision.
+     * @param precision_ One of WEIGHT_PRECISION_F64, _F32 or _U8.
+     */
+    void pack(const std::vector<double>& weights, int precision_);
+
+    /**
+     * @brief Expand the packed weights back to doubles.
+     *
+     * @return Dequantised weights.
+     */
+    std::vector<double> unpack() const;
+
+    /**
+     * @brief Dot product with a dense feature vector.
+     *
+     * @param features Dense features.
+     * @param n Number of features, at most size().
+     * @return Sum of features[i] * w[i].
+     */
+    double dot(const double* features, size_t n) const;
+
+    /**
+     * @brief Dot product with a sparse feature vector.
+     *
+     * @param idx Indices of the non-zero features.
+     * @param val Values of the non-zero features.
+     * @param nnz Number of non-zero features.
+     * @return Sum of val[i] * w[idx[i]].
+     */
+    double dotSparse(const int* idx, const double* val, size_t nnz) const;
+
+    /**
+     * @brief Add the rows of a sparse feature vector to a score per class.
+     *
+     * The weights are read as a row-major matrix with one row per feature and
+     * cols columns, one per class, so the row of a feature is contiguous and
+     * one pass over the features scores every class:
+     * scores[c] += sum of val[i] * w[idx[i] * cols + c].
+     *
+     * @param idx Indices of the non-zero features.
+     * @param val Values of the non-zero features.
+     * @param nnz Number of non-zero features.
+     * @param cols Number of columns of the matrix.
+     * @param scores Receives the sums, cols long.
+     */
+    void addRowsSparse(const int* idx, const double* val, size_t nnz, size_t cols, double* scores) const;
+
+    /**
+     * @brief Add the rows of a dense feature vector to a score per class, see addRowsSparse.
+     *
+     * @param features Dense features.
+     * @param n Number of features, at most size() / cols.
+     * @param cols Number of columns of the matrix.
+     * @param scores Receives the sums, cols long.
+     */
+    void addRows(const double* features, size_t n, size_t cols, double* scores) const;
+
+    /**
+     * @brief Dequantised value of a single weight.
+     *
+     * @param i Index of the weight.
+     * @return Weight i.
+     */
+    double at(size_t i) const;
+
+    /**
+     * @brief Number of weights.
+     */
+    size_t size() const { return count; }
+
+    /**
+     * @brief Precision the weights are stored in.
+     */
+    int getPrecision() const { return precision; }
+
+    /**
+     * @brief Bytes taken by the packed weights.
+     */
+    size_t bytes() const;
+
+    /**
+     * @brief Check whether a value is a supported precision.
+     *
+     * @param precision_ Number of bits per weight.
+     * @return True for 64, 32 and 8.
+     */
+    static bool isValidPrecision(int precision_);
+
+    /**
+     * @brief Save the packed weights to a file.
+     *
+     * @param outFile Output file stream.
+     */
+    void save(std::ofstream& outFile) const;
+
+    /**
+     * @brief Load packed weights from a file.
+     *
+     * @param inFile Input file stream.
+     */
+    void load(std::ifstream& inFile);
+
+private:
+    int precision; /**< Bits per weight. */
+    size_t count; /**< Number of weights. */
+    std::vector<double> f64; /**< Weights when precision is 64. */
+    std::vector<float> f32; /**< Weights when precision is 32. */
+    std::vector<uint8_t> codes; /**< 8-bit codes when precision is 8. */
+    std::vector<float> block_scale; /**< Scale of every block of codes. */
+    std::vector<float> block_offset; /**< Offset (minimum) of every block of codes. */
+};
+
+#endif // QUANTIZEDWEIGHTS_H__
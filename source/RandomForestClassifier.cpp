@@ -14,15 +14,16 @@ Revision History:
 #include <iostream>
 #include <algorithm>
 
-RandomForestClassifier::RandomForestClassifier(BaseVectorizer* pvec)
-    : num_trees(num_trees), max_depth(max_depth)
+#include "ThreadPool.h"
+
+RandomForestClassifier::RandomForestClassifier(std::shared_ptr<BaseVectorizer> pvec)
+    : num_trees(50), max_depth(5), seed(RANDOM_DEFAULT_SEED), bootstrap(true), split_max_features(0.0)
 {
     pVec = pvec;
 }
 
 RandomForestClassifier::~RandomForestClassifier()
 {
-    delete pVec;
 }
 
 void RandomForestClassifier::setHyperparameters(std::string hyperparameters)
@@ -30,143 +31,132 @@ void RandomForestClassifier::setHyperparameters(std::string hyperparameters)
     std::string token;
     std::istringstream tokenStream(hyperparameters);
 
-    // "num_trees=50,max_depth=5"
+    // "num_trees=50,max_depth=5,seed=0,bootstrap=1,split_max_features=0"
     num_trees = 50;
     max_depth = 5;
+    seed = RANDOM_DEFAULT_SEED;
+    bootstrap = true;
+    split_max_features = 0.0;
 
     while (std::getline(tokenStream, token, ',')) {
         std::istringstream pairStream(token);
         std::string key;
         double value;
 
+        if (pVec->setOption(token)) {
+            continue;
+        }
         if (std::getline(pairStream, key, '=') && pairStream >> value) {
             cout << key << " = " << value << endl;
-            if (key == "minfrequency") {
-                minfrequency = value;
+            // Split options are the forest's own, max_features already caps the vocabulary.
+            if (key == "split_max_features") {
+                split_max_features = value;
+                continue;
             }
+            pVec->setHyperparameter(key, value);
             if (key == "num_trees") {
                 num_trees = value;
             }
             else if (key == "max_depth") {
                 max_depth = value;
             }
+            else if (key == "seed") {
+                seed = static_cast<uint64_t>(value);
+            }
+            else if (key == "bootstrap") {
+                bootstrap = value != 0;
+            }
         }
     }
 }
 
 void RandomForestClassifier::fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels)
 {
-    if (minfrequency > 0)
-    {
-        pVec->scanForSparseHistogram(abs_filepath_to_features, minfrequency);
-    }
     pVec->fit(abs_filepath_to_features, abs_filepath_to_labels);
-    std::vector<std::shared_ptr<Sentence>> sentences = pVec->sentences;
-    
-    for (int i = 0; i < num_trees; ++i)
-    {
-        auto tree = std::make_shared<DecisionTree>(max_depth);
-        tree->fit(sentences);
-        trees.push_back(tree);
-    }
+    fitSentences(pVec->sentences);
 }
 
-Prediction RandomForestClassifier::predict(std::string sentence, bool preprocess)
+void RandomForestClassifier::fitSentences(const std::vector<std::shared_ptr<Sentence>>& sentences)
 {
-    GlobalData vars;
-    Prediction result;
+    // The trees are independent, each is grown by whichever thread takes it.
+    // Tree i draws its sample and features from stream i of the seed, so
+    // the forest does not depend on the number of threads.
+    trees.assign(std::max(num_trees, 0), nullptr);
+    ThreadPool::shared().parallelFor(trees.size(), 1, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            RandomStream rng(seed, i);
+            auto tree = std::make_shared<DecisionTree>(max_depth);
+            if (bootstrap && !sentences.empty())
+            {
+                std::vector<std::shared_ptr<Sentence>> sample(sentences.size());
+                for (auto& sentence : sample)
+                {
+                    sentence = sentences[rng.below(sentences.size())];
+                }
+                tree->fit(sample, classCount(), pVec->getFeatureCount(), split_max_features, rng);
+            }
+            else
+            {
+                tree->fit(sentences, classCount(), pVec->getFeatureCount(), split_max_features, rng);
+            }
+            trees[i] = tree;
+        }
+    });
+}
 
-    std::vector<std::string> processed_input = pVec->buildSentenceVector(sentence, preprocess);
-    std::vector<double> feature_vector = pVec->getSentenceFeatures(processed_input);
+int RandomForestClassifier::classCount() const
+{
+    return std::max(pVec->getClassLabels().size(), 1);
+}
 
-    std::vector<int> votes(3, 0); // Assuming 3 classes: POS, NEG, NEU
+Prediction RandomForestClassifier::predictFeatures(const FeatureVector& features, PredictContext& ctx) const
+{
+    int num_classes = classCount();
+    std::pmr::vector<int> votes(num_classes, 0, ctx.resource());
     for (const auto& tree : trees)
     {
-        int prediction = tree->predict(feature_vector).label;
+        int prediction = tree->predict(features.data()).label;
         votes[prediction]++;
     }
 
-    std::vector<double> probabilities(3, 0.0);
-    for (size_t i = 0; i < votes.size(); ++i)
-    {
-        probabilities[i] = static_cast<double>(votes[i]) / trees.size();
-    }
-
-    int max_index = std::distance(votes.begin(), std::max_element(votes.begin(), votes.end()));
-
-    result.probability = probabilities[1];
-
-    switch (max_index)
-    {
-    case 0:
-        result.label = vars.NEG;
-        break;
-    case 1:
-        result.label = vars.POS;
-        break;
-    case 2:
-        result.label = vars.NEU;
-        break;
-    default:
-        break;
-    }
-
-    return result;
+    return tally(votes.data(), num_classes);
 }
 
-void RandomForestClassifier::predict(std::string abs_filepath_to_features, std::string abs_filepath_to_labels, bool preprocess)
+void RandomForestClassifier::predictSparseBatch(const SparseBatch& batch, std::span<Prediction> results, PredictContext& ctx) const
 {
-    std::ifstream in(abs_filepath_to_features);
-    std::ofstream out(abs_filepath_to_labels);
-    std::string feature_input;
+    int num_classes = classCount();
+    std::pmr::vector<int> votes(TREE_BLOCK_ROWS * num_classes, ctx.resource());
 
-    if (!in)
+    // Every tree is walked by a whole block of rows while its nodes are in cache.
+    for (size_t begin = 0; begin < batch.rows(); begin += TREE_BLOCK_ROWS)
     {
-        std::cerr << "ERROR: Cannot open features file.\n";
-        return;
-    }
-
-    if (!out)
-    {
-        std::cerr << "ERROR: Cannot open labels file.\n";
-        return;
+        size_t end = std::min(begin + TREE_BLOCK_ROWS, batch.rows());
+        std::fill(votes.begin(), votes.end(), 0);
+
+        for (const auto& tree : trees)
+        {
+            for (size_t r = begin; r < end; ++r)
+            {
+                votes[(r - begin) * num_classes + tree->predict(batch.row(r)).label]++;
+            }
+        }
+        for (size_t r = begin; r < end; ++r)
+        {
+            results[r] = tally(votes.data() + (r - begin) * num_classes, num_classes);
+        }
     }
+}
 
-    #ifdef BENCHMARK
-    double sumduration = 0.0;
-    double sumstrlen = 0.0;
-    size_t num_rows = 0;
-    #endif
-
-    while (getline(in, feature_input))
-    {
-        #ifdef BENCHMARK
-        auto start = std::chrono::high_resolution_clock::now();
-        #endif
-
-        Prediction result = predict(feature_input, preprocess);
-
-        #ifdef BENCHMARK
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> duration = end - start;
-        double milliseconds = duration.count();
-        sumduration += milliseconds;
-        sumstrlen += feature_input.length();
-        num_rows++;
-        #endif
-
-        out << result.label << "," << result.probability << std::endl;
-    }
+Prediction RandomForestClassifier::tally(const int* votes, int num_classes) const
+{
+    Prediction result;
 
-    #ifdef BENCHMARK
-    double avgduration = sumduration / num_rows;
-    cout << "Average Time per Text = " << avgduration << " ms" << endl;
-    double avgstrlen = sumstrlen / num_rows;
-    cout << "Average Length of Text (chars) = " << avgstrlen << endl;
-    #endif
+    result.label = std::distance(votes, std::max_element(votes, votes + num_classes));
+    result.probability = static_cast<double>(votes[result.label]) / trees.size();
 
-    in.close();
-    out.close();
+    return result;
 }
 
 void RandomForestClassifier::save(const std::string& filename) const
@@ -196,20 +186,22 @@ void RandomForestClassifier::load(const std::string& filename)
     if (!inFile.is_open())
     {
         std::cerr << "Failed to open file for reading." << std::endl;
+        loaded = false;
         return;
     }
 
     pVec->load(inFile);
 
-    size_t num_trees;
+    size_t num_trees = 0;
     inFile.read(reinterpret_cast<char*>(&num_trees), sizeof(num_trees));
     trees.resize(num_trees);
-    for (size_t i = 0; i < num_trees; ++i)
+    for (size_t i = 0; i < num_trees && inFile; ++i)
     {
         auto tree = std::make_shared<DecisionTree>();
         tree->load(inFile);
         trees[i] = tree;
     }
 
+    loaded = !inFile.fail();
     inFile.close();
 }
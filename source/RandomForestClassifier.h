@@ -35,9 +35,9 @@ class RandomForestClassifier : public BaseClassifier
 public:
     /**
      * @brief Constructor for RandomForestClassifier.
-     * @param pvec Pointer to a BaseVectorizer object for feature extraction.
+     * @param pvec Vectorizer for feature extraction, shared with the caller.
      */
-    RandomForestClassifier(BaseVectorizer* pvec);
+    RandomForestClassifier(std::shared_ptr<BaseVectorizer> pvec);
     ~RandomForestClassifier();
     
     /**
@@ -53,18 +53,10 @@ public:
     void fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels) override;
 
     /**
-     * @brief Predict labels for test data.
-     * @param abs_filepath_to_features Absolute file path to the file containing features.
-     * @param abs_filepath_to_labels Absolute file path to the file to save predicted labels.
-     */
-    void predict(std::string abs_filepath_to_features, std::string abs_filepath_to_labels, bool preprocess = true) override;
-
-    /**
-     * @brief Predict label for a single input sentence.
-     * @param sentence Input sentence to predict label for.
-     * @return Prediction object containing predicted label.
+     * @brief Train on sentences vectorised by pVec, see BaseClassifier::fitSentences.
+     * @param sentences Training sentences.
      */
-    Prediction predict(std::string sentence, bool preprocess = true) override;
+    void fitSentences(const std::vector<std::shared_ptr<Sentence>>& sentences) override;
 
     /**
      * @brief Save the model to a file.
@@ -78,10 +70,44 @@ public:
      */
     void load(const std::string& filename) override;
 
+protected:
+    /**
+     * @brief Label a feature vector by a majority vote of the trees.
+     * @param features Feature vector of the sentence.
+     * @param ctx Context providing the scratch memory.
+     * @return Prediction object containing predicted label.
+     */
+    Prediction predictFeatures(const FeatureVector& features, PredictContext& ctx) const override;
+
+    /**
+     * @brief Vote on a batch, sending blocks of rows down one tree at a time.
+     * @param batch Feature vectors of the batch.
+     * @param results Receives one Prediction per row.
+     * @param ctx Context providing the scratch memory.
+     */
+    void predictSparseBatch(const SparseBatch& batch, std::span<Prediction> results, PredictContext& ctx) const override;
+
 private:
     int num_trees; /**< Number of decision trees in the random forest. */
     int max_depth; /**< Maximum depth of each decision tree. */
+    uint64_t seed; /**< Seed of the per-tree streams. */
+    bool bootstrap; /**< Train every tree on a bootstrap sample of the sentences. */
+    double split_max_features; /**< Features tried per split: 0 for all, a share below 1 or a count. */
     std::vector<std::shared_ptr<DecisionTree>> trees; /**< Vector of decision trees in the random forest. */
+
+    /**
+     * @brief Number of classes the trees vote for.
+     * @return Number of labels of the vectorizer, at least 1.
+     */
+    int classCount() const;
+
+    /**
+     * @brief Turn the votes of the trees into a prediction.
+     * @param votes Votes for every class.
+     * @param num_classes Number of classes.
+     * @return Prediction with the share of votes of the winning class as probability.
+     */
+    Prediction tally(const int* votes, int num_classes) const;
 };
 
 #endif // RANDOMFORESTCLASSIFIER_H__
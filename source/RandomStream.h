@@ -0,0 +1,129 @@
+/**
+ * @file RandomStream.h
+ * @brief Counter-based random numbers for reproducible parallel training.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef RANDOMSTREAM_H__
+#define RANDOMSTREAM_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#define RANDOM_DEFAULT_SEED         0                       /**< Seed used when no seed= hyperparameter is given. */
+#define RANDOM_GAMMA                0x9e3779b97f4a7c15ULL   /**< Weyl increment of SplitMix64. */
+#define RANDOM_STREAM_SALT          0xbf58476d1ce4e5b9ULL
+#define RANDOM_SUBSTREAM_SALT       0x94d049bb133111ebULL
+
+/**
+ * @class RandomStream
+ * @brief SplitMix64 stream whose n-th number depends only on the seed, the stream ids and n.
+ *
+ * The seed and up to two stream ids, for example a tree index or an epoch
+ * and the first sentence trained on, are mixed into a key. The n-th number
+ * is the SplitMix64 finaliser applied to key + n * RANDOM_GAMMA. No state
+ * is shared between streams, so a tree or an epoch draws the same numbers
+ * whichever thread runs it and in whichever order: a model trained with a
+ * given seed= is bit for bit the same for any number of threads.
+ */
+class RandomStream
+{
+public:
+    /**
+     * @brief Open a stream.
+     *
+     * @param seed Seed of the training run, the seed= hyperparameter.
+     * @param stream First stream id.
+     * @param substream Second stream id.
+     */
+    explicit RandomStream(uint64_t seed = RANDOM_DEFAULT_SEED, uint64_t stream = 0, uint64_t substream = 0)
+        : counter(0)
+    {
+        key = mix(seed + RANDOM_GAMMA);
+        key = mix(key ^ (stream + RANDOM_GAMMA) * RANDOM_STREAM_SALT);
+        key = mix(key ^ (substream + RANDOM_GAMMA) * RANDOM_SUBSTREAM_SALT);
+    }
+
+    /**
+     * @brief Number at a position of the stream, without moving it.
+     *
+     * @param n Position.
+     * @return 64 random bits.
+     */
+    uint64_t at(uint64_t n) const
+    {
+        return mix(key + (n + 1) * RANDOM_GAMMA);
+    }
+
+    /**
+     * @brief Next number of the stream.
+     *
+     * @return 64 random bits.
+     */
+    uint64_t next()
+    {
+        return at(counter++);
+    }
+
+    /**
+     * @brief Next number as a double in [0, 1).
+     */
+    double uniform()
+    {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+
+    /**
+     * @brief Next number as an index in [0, n).
+     *
+     * @param n Number of values, greater than zero.
+     * @return Index below n.
+     */
+    size_t below(size_t n)
+    {
+        size_t index = static_cast<size_t>(uniform() * static_cast<double>(n));
+        return index < n ? index : n - 1;
+    }
+
+    /**
+     * @brief Put the elements of a vector in random order (Fisher-Yates).
+     *
+     * @param values Elements to shuffle.
+     */
+    template <typename T>
+    void shuffle(std::vector<T>& values)
+    {
+        for (size_t i = values.size(); i > 1; --i)
+        {
+            std::swap(values[i - 1], values[below(i)]);
+        }
+    }
+
+    /**
+     * @brief Finaliser of SplitMix64.
+     *
+     * @param z Value to mix.
+     * @return Mixed value.
+     */
+    static uint64_t mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    uint64_t key; /**< Seed and stream ids mixed together. */
+    uint64_t counter; /**< Position of the next number. */
+};
+
+#endif // RANDOMSTREAM_H__
@@ -12,26 +12,22 @@ Revision History:
 
 #include <fstream>
 #include <iostream>
-#include "GlobalData.h"
+#include <algorithm>
+#include <numeric>
+#include "SimdKernels.h"
 
-SVCClassifier::SVCClassifier(BaseVectorizer* pvec)
+SVCClassifier::SVCClassifier(std::shared_ptr<BaseVectorizer> pvec)
 {
     pVec = pvec;
+    seed = RANDOM_DEFAULT_SEED;
+    shuffle = true;
+    weight_precision = WEIGHT_PRECISION_F64;
+    num_classes = 0;
+    bias = 0.0;
 }
 
 SVCClassifier::~SVCClassifier()
 {
-    delete pVec;
-}
-
-double SVCClassifier::predict_margin(const std::vector<double>& features) const
-{
-    double margin = bias;
-    for (size_t i = 0; i < features.size(); ++i)
-    {
-        margin += weights[i] * features[i];
-    }
-    return margin;
 }
 
 void SVCClassifier::setHyperparameters(std::string hyperparameters)
@@ -39,23 +35,27 @@ void SVCClassifier::setHyperparameters(std::string hyperparameters)
     std::string token;
     std::istringstream tokenStream(hyperparameters);
 
-    // "bias=0.0,epochs=15,learning_rate=0.01,l1_regularization_param=0.005,l2_regularization_param=0.0"
+    // "bias=0.0,epochs=15,learning_rate=0.01,l1_regularization_param=0.005,l2_regularization_param=0.0,seed=0,shuffle=1,weight_precision=64"
     bias = 0.0;
     epochs = 15;
     learning_rate = 0.01;
     l1_regularization_param = 0.005;
     l2_regularization_param = 0.0;
+    seed = RANDOM_DEFAULT_SEED;
+    shuffle = true;
+    weight_precision = WEIGHT_PRECISION_F64;
 
     while (std::getline(tokenStream, token, ',')) {
         std::istringstream pairStream(token);
         std::string key;
         double value;
 
+        if (pVec->setOption(token)) {
+            continue;
+        }
         if (std::getline(pairStream, key, '=') && pairStream >> value) {
             cout << key << " = " << value << endl;
-            if (key == "minfrequency") {
-                minfrequency = value;
-            }
+            pVec->setHyperparameter(key, value);
             if (key == "bias") {
                 bias = value;
             }
@@ -71,138 +71,234 @@ void SVCClassifier::setHyperparameters(std::string hyperparameters)
             else if (key == "l2_regularization_param") {
                 l2_regularization_param = value;
             }
+            else if (key == "seed") {
+                seed = static_cast<uint64_t>(value);
+            }
+            else if (key == "shuffle") {
+                shuffle = value != 0;
+            }
+            else if (key == "weight_precision") {
+                weight_precision = value;
+                if (!QuantizedWeights::isValidPrecision(weight_precision)) {
+                    cout << "WARNING: weight_precision must be 64, 32 or 8, using 64" << endl;
+                    weight_precision = WEIGHT_PRECISION_F64;
+                }
+            }
         }
     }
 }
 
 void SVCClassifier::fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels)
 {
-    if (minfrequency > 0)
+    pVec->fit(abs_filepath_to_features, abs_filepath_to_labels);
+    fitSentences(pVec->sentences);
+}
+
+void SVCClassifier::fitSentences(const std::vector<std::shared_ptr<Sentence>>& sentences)
+{
+    num_classes = pVec->getClassLabels().size();
+    size_t cols = columnsFor(num_classes);
+    weights.assign(pVec->getFeatureCount() * cols, 0.0);
+    biases.assign(cols, bias);
+
+    train(sentences, 0);
+}
+
+void SVCClassifier::partial_fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels)
+{
+    size_t first_sentence = pVec->getSentenceCount();
+    pVec->partial_fit(abs_filepath_to_features, abs_filepath_to_labels);
+
+    // A loaded model only has its packed weights.
+    if (weights.size() != packed_weights.size())
     {
-        pVec->scanForSparseHistogram(abs_filepath_to_features, minfrequency);
+        weights = packed_weights.unpack();
     }
-    pVec->fit(abs_filepath_to_features, abs_filepath_to_labels);
+    resizeWeights();
+
+    train(pVec->sentences, first_sentence);
+}
 
-    size_t num_features = pVec->word_array.size();
-    weights.assign(num_features, 0.0);
+void SVCClassifier::prune(double threshold, int top_k)
+{
+    // A loaded model only has its packed weights.
+    if (weights.size() != packed_weights.size())
+    {
+        weights = packed_weights.unpack();
+    }
+
+    size_t cols = columnsFor(num_classes);
+    std::vector<int> old_to_new = selectFeatures(weights, pVec->getFeatureCount(), cols, threshold, top_k);
+    if (!pVec->remapFeatures(old_to_new))
+    {
+        return;
+    }
+    compactRows(weights, cols, old_to_new);
+    packed_weights.pack(weights, weight_precision);
+}
+
+void SVCClassifier::resizeWeights()
+{
+    size_t old_cols = columnsFor(num_classes);
+    size_t old_rows = old_cols ? weights.size() / old_cols : 0;
+    num_classes = pVec->getClassLabels().size();
+    size_t cols = columnsFor(num_classes);
+    size_t rows = pVec->getFeatureCount();
+
+    if (cols == old_cols)
+    {
+        weights.resize(rows * cols, 0.0);
+        return;
+    }
 
-    std::vector<std::shared_ptr<Sentence>> sentences = pVec->sentences;
-    std::vector<int> labels(sentences.size());
+    // A binary column separates class 1 from class 0, so it is the class 1
+    // column of one-vs-rest and its negation the class 0 column.
+    bool split_binary = (old_cols == 1);
+    size_t shift = split_binary ? 1 : 0;
+    std::vector<double> grown(rows * cols, 0.0);
+    for (size_t j = 0; j < std::min(rows, old_rows); ++j)
+    {
+        for (size_t k = 0; k < old_cols; ++k)
+        {
+            grown[j * cols + k + shift] = weights[j * old_cols + k];
+        }
+        if (split_binary)
+        {
+            grown[j * cols] = -weights[j];
+        }
+    }
+    weights.swap(grown);
 
-    std::ifstream label_file(abs_filepath_to_labels);
-    std::string label;
-    for (size_t i = 0; i < labels.size(); ++i)
+    std::vector<double> old_biases = biases;
+    biases.assign(cols, 0.0);
+    std::copy(old_biases.begin(), old_biases.end(), biases.begin() + shift);
+    if (split_binary)
     {
-        label_file >> labels[i];
-        // Convert labels to +1 or -1 for SVM
-        labels[i] = labels[i] == 1 ? 1 : -1;
+        biases[0] = -old_biases[0];
     }
-    label_file.close();
+}
 
-    for (int epoch = 0; epoch < epochs; ++epoch)
+void SVCClassifier::train(const std::vector<std::shared_ptr<Sentence>>& sentences, size_t first_sentence)
+{
+    size_t cols = columnsFor(num_classes);
+    std::vector<double> margins(cols);
+    std::vector<double> targets(cols);
+    std::vector<size_t> order(sentences.size() - first_sentence);
+
+    for (int epoch = 0; epoch < epochs && cols > 0; ++epoch)
     {
-        for (size_t i = 0; i < sentences.size(); ++i)
+        // Every epoch draws its order from a stream of its own.
+        std::iota(order.begin(), order.end(), first_sentence);
+        if (shuffle)
+        {
+            RandomStream(seed, epoch, first_sentence).shuffle(order);
+        }
+        for (size_t i : order)
         {
             std::vector<double> features;
             const auto& sentence_map = sentences[i]->sentence_map;
             features = pVec->getFrequencies(sentence_map);
-            double y_true = labels[i];
-            double margin = predict_margin(features);
+            int label = sentences[i]->label;
 
-            if (y_true * margin < 1)
+            margins = biases;
+            if (cols == 1)
+            {
+                margins[0] += SimdKernels::dot(weights.data(), features.data(), features.size());
+            }
+            else
             {
                 for (size_t j = 0; j < features.size(); ++j)
                 {
-                    weights[j] += learning_rate * (y_true * features[j] - l1_regularization_param * (weights[j] > 0 ? 1 : -1) - 2 * l2_regularization_param * weights[j]);
+                    if (features[j] != 0.0)
+                    {
+                        SimdKernels::axpy(features[j], weights.data() + j * cols, margins.data(), cols);
+                    }
                 }
-                bias += learning_rate * y_true;
             }
-            else
+
+            for (size_t k = 0; k < cols; ++k)
             {
-                for (size_t j = 0; j < features.size(); ++j)
+                // Labels are +1 or -1 for SVM, column k is class k vs rest
+                // or, for a single column, class 1 vs class 0.
+                int positive = (cols == 1) ? 1 : static_cast<int>(k);
+                targets[k] = (label == positive) ? 1.0 : -1.0;
+            }
+
+            updateFeatureRows(features.size(), cols, [&](size_t begin, size_t end)
+            {
+                for (size_t k = 0; k < cols; ++k)
+                {
+                    double y_true = targets[k];
+                    if (y_true * margins[k] < 1)
+                    {
+                        for (size_t j = begin; j < end; ++j)
+                        {
+                            double& w = weights[j * cols + k];
+                            w += learning_rate * (y_true * features[j] - l1_regularization_param * (w > 0 ? 1 : -1) - 2 * l2_regularization_param * w);
+                        }
+                    }
+                    else
+                    {
+                        for (size_t j = begin; j < end; ++j)
+                        {
+                            double& w = weights[j * cols + k];
+                            w += learning_rate * (-l1_regularization_param * (w > 0 ? 1 : -1) - 2 * l2_regularization_param * w);
+                        }
+                    }
+                }
+            });
+
+            for (size_t k = 0; k < cols; ++k)
+            {
+                if (targets[k] * margins[k] < 1)
                 {
-                    weights[j] += learning_rate * (-l1_regularization_param * (weights[j] > 0 ? 1 : -1) - 2 * l2_regularization_param * weights[j]);
+                    biases[k] += learning_rate * targets[k];
                 }
             }
         }
     }
+
+    packed_weights.pack(weights, weight_precision);
 }
 
-Prediction SVCClassifier::predict(std::string sentence, bool preprocess)
+Prediction SVCClassifier::decide(const double* margins, double* scores) const
 {
-    GlobalData vars;
-    Prediction result;
-    std::vector<string> processed_input = pVec->buildSentenceVector(sentence, preprocess);
-    std::vector<double> feature_vector = pVec->getSentenceFeatures(processed_input);
-    double margin = predict_margin(feature_vector);
-    
-    result.probability = 1.0 / (1.0 + std::exp(-margin));
-
-    if (margin > 0)
+    if (num_classes < 2)
     {
-        result.label = vars.POS;
+        return { 0, 1.0 };
     }
-    else
+
+    // A single column scores class 1 against class 0, which scores zero.
+    if (columnsFor(num_classes) == 1)
     {
-        result.label = vars.NEG;
+        scores[0] = 0.0;
+        scores[1] = margins[0];
+        return softmax(scores, num_classes);
     }
-
-    return result;
+    return softmax(margins, num_classes);
 }
 
-void SVCClassifier::predict(std::string abs_filepath_to_features, std::string abs_filepath_to_labels, bool preprocess)
+Prediction SVCClassifier::predictFeatures(const FeatureVector& features, PredictContext& ctx) const
 {
-    std::ifstream in(abs_filepath_to_features);
-    std::ofstream out(abs_filepath_to_labels);
-    std::string feature_input;
+    FeatureVector margins(biases.begin(), biases.end(), ctx.resource());
+    FeatureVector scores(num_classes, ctx.resource());
+    packed_weights.addRows(features.data(), features.size(), margins.size(), margins.data());
 
-    if (!in)
-    {
-        std::cerr << "ERROR: Cannot open features file.\n";
-        return;
-    }
-
-    if (!out)
-    {
-        std::cerr << "ERROR: Cannot open labels file.\n";
-        return;
-    }
+    return decide(margins.data(), scores.data());
+}
 
-    #ifdef BENCHMARK
-    double sumduration = 0.0;
-    double sumstrlen = 0.0;
-    size_t num_rows = 0;
-    #endif
+void SVCClassifier::predictSparseBatch(const SparseBatch& batch, std::span<Prediction> results, PredictContext& ctx) const
+{
+    FeatureVector margins(biases.size(), ctx.resource());
+    FeatureVector scores(num_classes, ctx.resource());
 
-    while (getline(in, feature_input))
+    for (size_t r = 0; r < batch.rows(); ++r)
     {
-        #ifdef BENCHMARK
-        auto start = std::chrono::high_resolution_clock::now();
-        #endif
-
-        Prediction result = predict(feature_input, preprocess);
-
-        #ifdef BENCHMARK
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> duration = end - start;
-        double milliseconds = duration.count();
-        sumduration += milliseconds;
-        sumstrlen += feature_input.length();
-        num_rows++;
-        #endif
-
-        out << result.label << "," << result.probability << std::endl;
+        SparseRow row = batch.row(r);
+        std::copy(biases.begin(), biases.end(), margins.begin());
+        packed_weights.addRowsSparse(row.idx, row.val, row.nnz, margins.size(), margins.data());
+        results[r] = decide(margins.data(), scores.data());
     }
-
-    #ifdef BENCHMARK
-    double avgduration = sumduration / num_rows;
-    cout << "Average Time per Text = " << avgduration << " ms" << endl;
-    double avgstrlen = sumstrlen / num_rows;
-    cout << "Average Length of Text (chars) = " << avgstrlen << endl;
-    #endif
-
-    in.close();
-    out.close();
 }
 
 void SVCClassifier::save(const std::string& filename) const
@@ -216,10 +312,9 @@ void SVCClassifier::save(const std::string& filename) const
 
     pVec->save(outFile);
 
-    size_t weight_size = weights.size();
-    outFile.write(reinterpret_cast<const char*>(&weight_size), sizeof(weight_size));
-    outFile.write(reinterpret_cast<const char*>(weights.data()), weight_size * sizeof(double));
-    outFile.write(reinterpret_cast<const char*>(&bias), sizeof(bias));
+    packed_weights.save(outFile);
+    outFile.write(reinterpret_cast<const char*>(&num_classes), sizeof(num_classes));
+    outFile.write(reinterpret_cast<const char*>(biases.data()), biases.size() * sizeof(double));
 
     outFile.close();
 }
@@ -230,16 +325,19 @@ void SVCClassifier::load(const std::string& filename)
     if (!inFile.is_open())
     {
         std::cerr << "Failed to open file for reading." << std::endl;
+        loaded = false;
         return;
     }
 
     pVec->load(inFile);
 
-    size_t weight_size;
-    inFile.read(reinterpret_cast<char*>(&weight_size), sizeof(weight_size));
-    weights.resize(weight_size);
-    inFile.read(reinterpret_cast<char*>(weights.data()), weight_size * sizeof(double));
-    inFile.read(reinterpret_cast<char*>(&bias), sizeof(bias));
+    packed_weights.load(inFile);
+    weight_precision = packed_weights.getPrecision();
+    num_classes = 0;
+    inFile.read(reinterpret_cast<char*>(&num_classes), sizeof(num_classes));
+    biases.resize(columnsFor(num_classes));
+    inFile.read(reinterpret_cast<char*>(biases.data()), biases.size() * sizeof(double));
 
+    loaded = !inFile.fail();
     inFile.close();
 }
@@ -14,6 +14,8 @@ Revision History:
 #include <vector>
 #include <random> 
 #include "BaseClassifier.h"
+#include "QuantizedWeights.h"
+#include "RandomStream.h"
 
 /**
  * @file LinearSVCClassifier.h
@@ -26,15 +28,20 @@ Revision History:
  *
  * This class inherits from BaseClassifier and provides functionality for training
  * and using a linear SVC for text classification tasks.
+ *
+ * Two classes share a single weight column that separates class 1 from
+ * class 0. More classes are trained one-vs-rest with a column per class, kept
+ * as one features x classes matrix so that every margin is computed in one
+ * pass over the features. The class with the largest margin wins.
  */
 class SVCClassifier: public BaseClassifier
 {
 public:
     /**
      * @brief Constructor for SVCClassifier.
-     * @param pvec Pointer to the BaseVectorizer object to be used for vectorization.
+     * @param pvec Vectorizer to be used for vectorization, shared with the caller.
      */
-    SVCClassifier(BaseVectorizer* pvec);
+    SVCClassifier(std::shared_ptr<BaseVectorizer> pvec);
     
     /**
      * @brief Destructor for SVCClassifier.
@@ -53,20 +60,36 @@ public:
      * @param abs_filepath_to_labels Absolute file path to the file containing labels.
      */
     void fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels) override;
-    
+
     /**
-     * @brief Predict labels for features in a file.
-     * @param abs_filepath_to_features Absolute file path to the file containing features.
-     * @param abs_filepath_to_labels Absolute file path to the file to store predicted labels.
+     * @brief Train on sentences vectorised by pVec, see BaseClassifier::fitSentences.
+     * @param sentences Training sentences.
      */
-    void predict(std::string abs_filepath_to_features, std::string abs_filepath_to_labels, bool preprocess = true) override;
-    
+    void fitSentences(const std::vector<std::shared_ptr<Sentence>>& sentences) override;
+
     /**
-     * @brief Predict label for a single sentence.
-     * @param sentence Input sentence to predict label for.
-     * @return Prediction object containing the predicted label.
+     * @brief Continue training from the current weights on new sentences only.
+     *
+     * Weights of new features start at zero. A loaded model continues from
+     * its packed weights, which are exact for weight_precision=64.
+     *
+     * @param abs_filepath_to_features Absolute file path to the file containing the new features.
+     * @param abs_filepath_to_labels Absolute file path to the file containing the new labels.
      */
-    Prediction predict(std::string sentence, bool preprocess = true) override;
+    void partial_fit(std::string abs_filepath_to_features, std::string abs_filepath_to_labels) override;
+
+    /**
+     * @brief Drop features with small weights from the vocabulary and the weight matrix.
+     *
+     * A feature counts by the largest |w| over all columns. A loaded model is
+     * pruned from its packed weights and packed again with the same precision.
+     *
+     * @param threshold Largest |w| a feature must exceed to be kept.
+     * @param top_k Maximum number of features kept, 0 for no limit.
+     */
+    void prune(double threshold, int top_k) override;
+    
+    
     
     /**
      * @brief Save the trained model to a file.
@@ -80,20 +103,66 @@ public:
      */
     void load(const std::string& filename) override;
 
+protected:
+    /**
+     * @brief Score a feature vector with the packed weights.
+     * @param features Feature vector of the sentence.
+     * @param ctx Context providing the scratch memory.
+     * @return Prediction object containing predicted label.
+     */
+    Prediction predictFeatures(const FeatureVector& features, PredictContext& ctx) const override;
+
+    /**
+     * @brief Score a batch with one sparse matrix-vector product.
+     * @param batch Feature vectors of the batch.
+     * @param results Receives one Prediction per row.
+     * @param ctx Context providing the scratch memory.
+     */
+    void predictSparseBatch(const SparseBatch& batch, std::span<Prediction> results, PredictContext& ctx) const override;
+
 private:
-    std::vector<double> weights; /**< Model weights. */
-    double bias; /**< Model bias. */
+    std::vector<double> weights; /**< Model weights, features x columns, only kept while training. */
+    QuantizedWeights packed_weights; /**< Model weights used for scoring. */
+    int weight_precision; /**< Bits per weight when the model is packed (64, 32 or 8). */
+    int num_classes; /**< Number of classes. */
+    std::vector<double> biases; /**< Bias of every column. */
+    double bias; /**< Initial model bias. */
     int epochs; /**< Number of epochs for training. */
     double learning_rate; /**< Learning rate for training. */
     double l1_regularization_param; /**< L1 regularization parameter. */
     double l2_regularization_param; /**< L2 regularization parameter. */
+    uint64_t seed; /**< Seed of the per-epoch shuffles. */
+    bool shuffle; /**< Visit the sentences in a new random order every epoch. */
+
+    /**
+     * @brief Number of weight columns for a number of classes.
+     * @param classes Number of classes.
+     * @return 1 for two classes, one per class otherwise.
+     */
+    static size_t columnsFor(int classes) { return classes == 2 ? 1 : (classes > 2 ? classes : 0); }
+
+    /**
+     * @brief Grow the weights to the features and classes of the vectorizer.
+     *
+     * When a binary model gets a third class, its column becomes the
+     * class 1 vs rest column and its negation the class 0 vs rest column.
+     */
+    void resizeWeights();
+
+    /**
+     * @brief Run the training epochs over sentences from first_sentence on.
+     * @param sentences Sentences vectorised by pVec.
+     * @param first_sentence Index of the first sentence to train on.
+     */
+    void train(const std::vector<std::shared_ptr<Sentence>>& sentences, size_t first_sentence);
 
     /**
-     * @brief Compute the margin for prediction.
-     * @param features Vector of features for prediction.
-     * @return Margin value for prediction.
+     * @brief Turn the margins of all columns into a prediction.
+     * @param margins Margin of every column.
+     * @param scores Scratch space for num_classes scores.
+     * @return Prediction with the class of the largest margin.
      */
-    double predict_margin(const std::vector<double>& features) const;
+    Prediction decide(const double* margins, double* scores) const;
 };
 
 #endif // LINEARSVCCLASSIFIER_H__
@@ -0,0 +1,973 @@
+/**
+ * @file SimdKernels.cpp
+ * @brief Scalar, SSE2, AVX2 and AVX-512 implementations of the vector kernels.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "SimdKernels.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMDKERNELS_X86
+#include <immintrin.h>
+#endif
+
+#define SIMD_LEVEL_SCALAR   0
+#define SIMD_LEVEL_SSE2     1
+#define SIMD_LEVEL_AVX2     2
+#define SIMD_LEVEL_AVX512   3
+
+/**
+ * @brief Function table of one implementation level.
+ */
+struct KernelTable
+{
+    double (*dot)(const double*, const double*, size_t);
+    double (*dotSparse)(const int*, const double*, size_t, const double*);
+    double (*squaredDistance)(const double*, const double*, size_t);
+    double (*dotF32)(const double*, const float*, size_t);
+    double (*dotSparseF32)(const int*, const double*, size_t, const float*);
+    double (*dotU8)(const double*, const uint8_t*, const float*, const float*, size_t);
+    void (*axpy)(double, const double*, double*, size_t);
+    void (*axpyF32)(double, const float*, double*, size_t);
+    size_t (*lowerAscii)(char*, size_t);
+    size_t (*normalizeAscii)(char*, size_t);
+    size_t (*findByte)(const char*, size_t, char);
+    const char* name;
+};
+
+// ===========================================================|
+// ======================SCALAR===============================|
+// ===========================================================|
+
+static double dotScalar(const double* a, const double* b, size_t n)
+{
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; ++i)
+    {
+        s0 += a[i] * b[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+static double dotSparseScalar(const int* idx, const double* val, size_t nnz, const double* dense)
+{
+    double s0 = 0.0, s1 = 0.0;
+    size_t i = 0;
+    for (; i + 2 <= nnz; i += 2)
+    {
+        s0 += val[i] * dense[idx[i]];
+        s1 += val[i + 1] * dense[idx[i + 1]];
+    }
+    for (; i < nnz; ++i)
+    {
+        s0 += val[i] * dense[idx[i]];
+    }
+    return s0 + s1;
+}
+
+static double squaredDistanceScalar(const double* a, const double* b, size_t n)
+{
+    double s0 = 0.0, s1 = 0.0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        double d0 = a[i] - b[i];
+        double d1 = a[i + 1] - b[i + 1];
+        s0 += d0 * d0;
+        s1 += d1 * d1;
+    }
+    for (; i < n; ++i)
+    {
+        double d = a[i] - b[i];
+        s0 += d * d;
+    }
+    return s0 + s1;
+}
+
+static double dotF32Scalar(const double* x, const float* w, size_t n)
+{
+    double s0 = 0.0, s1 = 0.0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        s0 += x[i] * w[i];
+        s1 += x[i + 1] * w[i + 1];
+    }
+    for (; i < n; ++i)
+    {
+        s0 += x[i] * w[i];
+    }
+    return s0 + s1;
+}
+
+static double dotSparseF32Scalar(const int* idx, const double* val, size_t nnz, const float* w)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < nnz; ++i)
+    {
+        sum += val[i] * w[idx[i]];
+    }
+    return sum;
+}
+
+static void axpyScalar(double a, const double* x, double* y, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        y[i] += a * x[i];
+    }
+}
+
+static void axpyF32Scalar(double a, const float* x, double* y, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        y[i] += a * x[i];
+    }
+}
+
+/**
+ * @brief One (possibly partial) block of dotU8, shared by every level for the tail.
+ */
+static double dotU8Block(const double* x, const uint8_t* q, float scale, float offset, size_t len)
+{
+    double sum_x = 0.0, sum_xq = 0.0;
+    for (size_t i = 0; i < len; ++i)
+    {
+        sum_x += x[i];
+        sum_xq += x[i] * q[i];
+    }
+    return offset * sum_x + scale * sum_xq;
+}
+
+static double dotU8Scalar(const double* x, const uint8_t* q, const float* scale, const float* offset, size_t n)
+{
+    double sum = 0.0;
+    for (size_t base = 0, b = 0; base < n; base += SIMDKERNELS_QUANT_BLOCK, ++b)
+    {
+        size_t len = n - base < SIMDKERNELS_QUANT_BLOCK ? n - base : SIMDKERNELS_QUANT_BLOCK;
+        sum += dotU8Block(x + base, q + base, scale[b], offset[b], len);
+    }
+    return sum;
+}
+
+/**
+ * @brief Byte translation tables of the text kernels, also used for their tails.
+ */
+struct ByteMaps
+{
+    unsigned char lower[256];       /**< A-Z to a-z, identity otherwise. */
+    unsigned char normalize[256];   /**< See SimdKernels::normalizeAscii. */
+};
+
+static const ByteMaps& byteMaps()
+{
+    static const ByteMaps maps = []()
+    {
+        ByteMaps m;
+        for (int c = 0; c < 256; ++c)
+        {
+            unsigned char lower = (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c + 32) : static_cast<unsigned char>(c);
+            // Printable ASCII is exactly alnum, punct and ' '; \t \v \f \r are the other spaces.
+            bool keep = (c >= 0x20 && c <= 0x7e) || c == '\t' || (c >= 0x0b && c <= 0x0d);
+            m.lower[c] = lower;
+            m.normalize[c] = keep ? lower : ' ';
+        }
+        return m;
+    }();
+    return maps;
+}
+
+static size_t translateScalar(char* text, size_t len, const unsigned char* map)
+{
+    size_t i = 0;
+    for (; i < len && static_cast<unsigned char>(text[i]) < 0x80; ++i)
+    {
+        text[i] = static_cast<char>(map[static_cast<unsigned char>(text[i])]);
+    }
+    return i;
+}
+
+static size_t lowerAsciiScalar(char* text, size_t len)
+{
+    return translateScalar(text, len, byteMaps().lower);
+}
+
+static size_t normalizeAsciiScalar(char* text, size_t len)
+{
+    return translateScalar(text, len, byteMaps().normalize);
+}
+
+static size_t findByteScalar(const char* text, size_t len, char byte)
+{
+    const void* found = std::memchr(text, byte, len);
+    return found ? static_cast<size_t>(static_cast<const char*>(found) - text) : len;
+}
+
+#ifdef SIMDKERNELS_X86
+
+// ===========================================================|
+// ======================SSE2=================================|
+// ===========================================================|
+
+__attribute__((target("sse2")))
+static double horizontalSum128(__m128d v)
+{
+    __m128d hi = _mm_unpackhi_pd(v, v);
+    return _mm_cvtsd_f64(_mm_add_sd(v, hi));
+}
+
+__attribute__((target("sse2")))
+static double dotSse2(const double* a, const double* b, size_t n)
+{
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    double sum = horizontalSum128(_mm_add_pd(acc0, acc1));
+    for (; i < n; ++i)
+    {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+__attribute__((target("sse2")))
+static double dotSparseSse2(const int* idx, const double* val, size_t nnz, const double* dense)
+{
+    // No gather before AVX2, pairs are assembled from two scalar loads.
+    __m128d acc = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= nnz; i += 2)
+    {
+        __m128d d = _mm_set_pd(dense[idx[i + 1]], dense[idx[i]]);
+        acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(val + i), d));
+    }
+    double sum = horizontalSum128(acc);
+    for (; i < nnz; ++i)
+    {
+        sum += val[i] * dense[idx[i]];
+    }
+    return sum;
+}
+
+__attribute__((target("sse2")))
+static double squaredDistanceSse2(const double* a, const double* b, size_t n)
+{
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128d d0 = _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i));
+        __m128d d1 = _mm_sub_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(d0, d0));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(d1, d1));
+    }
+    double sum = horizontalSum128(_mm_add_pd(acc0, acc1));
+    for (; i < n; ++i)
+    {
+        double d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+__attribute__((target("sse2")))
+static double dotF32Sse2(const double* x, const float* w, size_t n)
+{
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 wf = _mm_loadu_ps(w + i);
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_cvtps_pd(wf)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_cvtps_pd(_mm_movehl_ps(wf, wf))));
+    }
+    double sum = horizontalSum128(_mm_add_pd(acc0, acc1));
+    for (; i < n; ++i)
+    {
+        sum += x[i] * w[i];
+    }
+    return sum;
+}
+
+__attribute__((target("sse2")))
+static void axpySse2(double a, const double* x, double* y, size_t n)
+{
+    __m128d va = _mm_set1_pd(a);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(va, _mm_loadu_pd(x + i))));
+    }
+    for (; i < n; ++i)
+    {
+        y[i] += a * x[i];
+    }
+}
+
+__attribute__((target("sse2")))
+static void axpyF32Sse2(double a, const float* x, double* y, size_t n)
+{
+    __m128d va = _mm_set1_pd(a);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128d vx = _mm_cvtps_pd(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(x + i))));
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(va, vx)));
+    }
+    for (; i < n; ++i)
+    {
+        y[i] += a * x[i];
+    }
+}
+
+__attribute__((target("sse2")))
+static __m128i lowerAscii128(__m128i c)
+{
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+    return _mm_add_epi8(c, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+__attribute__((target("sse2")))
+static size_t lowerAsciiSse2(char* text, size_t len)
+{
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i* p = reinterpret_cast<__m128i*>(text + i);
+        __m128i c = _mm_loadu_si128(p);
+        if (_mm_movemask_epi8(c))
+        {
+            break;
+        }
+        _mm_storeu_si128(p, lowerAscii128(c));
+    }
+    return i + translateScalar(text + i, len - i, byteMaps().lower);
+}
+
+__attribute__((target("sse2")))
+static size_t normalizeAsciiSse2(char* text, size_t len)
+{
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i* p = reinterpret_cast<__m128i*>(text + i);
+        __m128i c = _mm_loadu_si128(p);
+        if (_mm_movemask_epi8(c))
+        {
+            break;
+        }
+        __m128i printable = _mm_cmpgt_epi8(c, _mm_set1_epi8(0x1f));
+        printable = _mm_andnot_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(0x7f)), printable);
+        __m128i space = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('\t')),
+                                     _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('\n')), _mm_cmplt_epi8(c, _mm_set1_epi8(0x0e))));
+        __m128i keep = _mm_or_si128(printable, space);
+        c = _mm_or_si128(_mm_and_si128(keep, c), _mm_andnot_si128(keep, _mm_set1_epi8(' ')));
+        _mm_storeu_si128(p, lowerAscii128(c));
+    }
+    return i + translateScalar(text + i, len - i, byteMaps().normalize);
+}
+
+__attribute__((target("sse2")))
+static size_t findByteSse2(const char* text, size_t len, char byte)
+{
+    const __m128i needle = _mm_set1_epi8(byte);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i)), needle));
+        if (mask)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + findByteScalar(text + i, len - i, byte);
+}
+
+// ===========================================================|
+// ======================AVX2=================================|
+// ===========================================================|
+
+__attribute__((target("avx2,fma")))
+static double horizontalSum256(__m256d v)
+{
+    __m128d lo = _mm256_castpd256_pd128(v);
+    __m128d hi = _mm256_extractf128_pd(v, 1);
+    lo = _mm_add_pd(lo, hi);
+    __m128d hi64 = _mm_unpackhi_pd(lo, lo);
+    return _mm_cvtsd_f64(_mm_add_sd(lo, hi64));
+}
+
+__attribute__((target("avx2,fma")))
+static double dotAvx2(const double* a, const double* b, size_t n)
+{
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+        acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8), acc2);
+        acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12), acc3);
+    }
+    for (; i + 4 <= n; i += 4)
+    {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+    }
+    double sum = horizontalSum256(_mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3)));
+    for (; i < n; ++i)
+    {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static double dotSparseAvx2(const int* idx, const double* val, size_t nnz, const double* dense)
+{
+    // Masked gathers with a zero source: GCC 12 gives the plain ones an undefined one and warns.
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= nnz; i += 8)
+    {
+        __m128i vi0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + i));
+        __m128i vi1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + i + 4));
+        __m256d d0 = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), dense, vi0, all, 8);
+        __m256d d1 = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), dense, vi1, all, 8);
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(val + i), d0, acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(val + i + 4), d1, acc1);
+    }
+    double sum = horizontalSum256(_mm256_add_pd(acc0, acc1));
+    for (; i < nnz; ++i)
+    {
+        sum += val[i] * dense[idx[i]];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static double squaredDistanceAvx2(const double* a, const double* b, size_t n)
+{
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+        __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4));
+        acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm256_fmadd_pd(d1, d1, acc1);
+    }
+    double sum = horizontalSum256(_mm256_add_pd(acc0, acc1));
+    for (; i < n; ++i)
+    {
+        double d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static double dotF32Avx2(const double* x, const float* w, size_t n)
+{
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_cvtps_pd(_mm_loadu_ps(w + i)), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_cvtps_pd(_mm_loadu_ps(w + i + 4)), acc1);
+    }
+    double sum = horizontalSum256(_mm256_add_pd(acc0, acc1));
+    for (; i < n; ++i)
+    {
+        sum += x[i] * w[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static double dotSparseF32Avx2(const int* idx, const double* val, size_t nnz, const float* w)
+{
+    __m256d acc = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= nnz; i += 4)
+    {
+        __m128i vi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + i));
+        __m128 wf = _mm_i32gather_ps(w, vi, 4);
+        acc = _mm256_fmadd_pd(_mm256_loadu_pd(val + i), _mm256_cvtps_pd(wf), acc);
+    }
+    double sum = horizontalSum256(acc);
+    for (; i < nnz; ++i)
+    {
+        sum += val[i] * w[idx[i]];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static double dotU8Avx2(const double* x, const uint8_t* q, const float* scale, const float* offset, size_t n)
+{
+    double sum = 0.0;
+    size_t base = 0, b = 0;
+    for (; base + SIMDKERNELS_QUANT_BLOCK <= n; base += SIMDKERNELS_QUANT_BLOCK, ++b)
+    {
+        __m256d sum_x = _mm256_setzero_pd();
+        __m256d sum_xq = _mm256_setzero_pd();
+        for (size_t j = base; j < base + SIMDKERNELS_QUANT_BLOCK; j += 4)
+        {
+            int32_t packed;
+            std::memcpy(&packed, q + j, sizeof(packed));
+            __m256d qd = _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed)));
+            __m256d xv = _mm256_loadu_pd(x + j);
+            sum_x = _mm256_add_pd(sum_x, xv);
+            sum_xq = _mm256_fmadd_pd(xv, qd, sum_xq);
+        }
+        sum += offset[b] * horizontalSum256(sum_x) + scale[b] * horizontalSum256(sum_xq);
+    }
+    if (base < n)
+    {
+        sum += dotU8Block(x + base, q + base, scale[b], offset[b], n - base);
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static void axpyAvx2(double a, const double* x, double* y, size_t n)
+{
+    __m256d va = _mm256_set1_pd(a);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+    }
+    for (; i < n; ++i)
+    {
+        y[i] += a * x[i];
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void axpyF32Avx2(double a, const float* x, double* y, size_t n)
+{
+    __m256d va = _mm256_set1_pd(a);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_cvtps_pd(_mm_loadu_ps(x + i)), _mm256_loadu_pd(y + i)));
+    }
+    for (; i < n; ++i)
+    {
+        y[i] += a * x[i];
+    }
+}
+
+__attribute__((target("avx2")))
+static __m256i lowerAscii256(__m256i c)
+{
+    __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), c));
+    return _mm256_add_epi8(c, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+__attribute__((target("avx2")))
+static size_t lowerAsciiAvx2(char* text, size_t len)
+{
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i* p = reinterpret_cast<__m256i*>(text + i);
+        __m256i c = _mm256_loadu_si256(p);
+        if (_mm256_movemask_epi8(c))
+        {
+            break;
+        }
+        _mm256_storeu_si256(p, lowerAscii256(c));
+    }
+    return i + translateScalar(text + i, len - i, byteMaps().lower);
+}
+
+__attribute__((target("avx2")))
+static size_t normalizeAsciiAvx2(char* text, size_t len)
+{
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i* p = reinterpret_cast<__m256i*>(text + i);
+        __m256i c = _mm256_loadu_si256(p);
+        if (_mm256_movemask_epi8(c))
+        {
+            break;
+        }
+        __m256i printable = _mm256_andnot_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(0x7f)),
+                                                _mm256_cmpgt_epi8(c, _mm256_set1_epi8(0x1f)));
+        __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\t')),
+                                        _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('\n')), _mm256_cmpgt_epi8(_mm256_set1_epi8(0x0e), c)));
+        __m256i keep = _mm256_or_si256(printable, space);
+        c = _mm256_blendv_epi8(_mm256_set1_epi8(' '), c, keep);
+        _mm256_storeu_si256(p, lowerAscii256(c));
+    }
+    return i + translateScalar(text + i, len - i, byteMaps().normalize);
+}
+
+__attribute__((target("avx2")))
+static size_t findByteAvx2(const char* text, size_t len, char byte)
+{
+    const __m256i needle = _mm256_set1_epi8(byte);
+    size_t i = 0;
+    // Two vectors per iteration, lines are usually longer than 32 bytes.
+    for (; i + 64 <= len; i += 64)
+    {
+        __m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i)), needle);
+        __m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + 32)), needle);
+        if (_mm256_movemask_epi8(_mm256_or_si256(a, b)))
+        {
+            uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(a)) | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(b))) << 32;
+            return i + __builtin_ctzll(mask);
+        }
+    }
+    for (; i + 32 <= len; i += 32)
+    {
+        int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i)), needle));
+        if (mask)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + findByteScalar(text + i, len - i, byte);
+}
+
+// ===========================================================|
+// ======================AVX-512==============================|
+// ===========================================================|
+
+/**
+ * @brief Sum of the lanes, added in the order of _mm512_reduce_add_pd.
+ *
+ * The halves are taken with masked extracts from a zero source, GCC 12
+ * implements _mm512_reduce_add_pd with an undefined one and warns about it.
+ */
+__attribute__((target("avx512f")))
+static double horizontalSum512(__m512d v)
+{
+    __m256d lo = _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, v, 0);
+    __m256d hi = _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, v, 1);
+    return horizontalSum256(_mm256_add_pd(hi, lo));
+}
+
+__attribute__((target("avx512f")))
+static double dotAvx512(const double* a, const double* b, size_t n)
+{
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), acc1);
+    }
+    if (i + 8 <= n)
+    {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), acc0);
+        i += 8;
+    }
+    if (i < n)
+    {
+        __mmask8 tail = static_cast<__mmask8>((1u << (n - i)) - 1);
+        acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(tail, a + i), _mm512_maskz_loadu_pd(tail, b + i), acc1);
+    }
+    return horizontalSum512(_mm512_add_pd(acc0, acc1));
+}
+
+__attribute__((target("avx512f")))
+static double dotSparseAvx512(const int* idx, const double* val, size_t nnz, const double* dense)
+{
+    __m512d acc = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= nnz; i += 8)
+    {
+        __m256i vi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + i));
+        __m512d d = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, vi, dense, 8);
+        acc = _mm512_fmadd_pd(_mm512_loadu_pd(val + i), d, acc);
+    }
+    double sum = horizontalSum512(acc);
+    for (; i < nnz; ++i)
+    {
+        sum += val[i] * dense[idx[i]];
+    }
+    return sum;
+}
+
+__attribute__((target("avx512f")))
+static double squaredDistanceAvx512(const double* a, const double* b, size_t n)
+{
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i));
+        __m512d d1 = _mm512_sub_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8));
+        acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm512_fmadd_pd(d1, d1, acc1);
+    }
+    if (i + 8 <= n)
+    {
+        __m512d d = _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i));
+        acc0 = _mm512_fmadd_pd(d, d, acc0);
+        i += 8;
+    }
+    if (i < n)
+    {
+        __mmask8 tail = static_cast<__mmask8>((1u << (n - i)) - 1);
+        __m512d d = _mm512_sub_pd(_mm512_maskz_loadu_pd(tail, a + i), _mm512_maskz_loadu_pd(tail, b + i));
+        acc1 = _mm512_fmadd_pd(d, d, acc1);
+    }
+    return horizontalSum512(_mm512_add_pd(acc0, acc1));
+}
+
+__attribute__((target("avx512f")))
+static double dotF32Avx512(const double* x, const float* w, size_t n)
+{
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        // Masked conversions with a zero source, see horizontalSum512.
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_mask_cvtps_pd(_mm512_setzero_pd(), 0xFF, _mm256_loadu_ps(w + i)), acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_mask_cvtps_pd(_mm512_setzero_pd(), 0xFF, _mm256_loadu_ps(w + i + 8)), acc1);
+    }
+    double sum = horizontalSum512(_mm512_add_pd(acc0, acc1));
+    for (; i < n; ++i)
+    {
+        sum += x[i] * w[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx512f,avx2")))
+static double dotU8Avx512(const double* x, const uint8_t* q, const float* scale, const float* offset, size_t n)
+{
+    double sum = 0.0;
+    size_t base = 0, b = 0;
+    for (; base + SIMDKERNELS_QUANT_BLOCK <= n; base += SIMDKERNELS_QUANT_BLOCK, ++b)
+    {
+        __m512d sum_x = _mm512_setzero_pd();
+        __m512d sum_xq = _mm512_setzero_pd();
+        for (size_t j = base; j < base + SIMDKERNELS_QUANT_BLOCK; j += 8)
+        {
+            __m128i q8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(q + j));
+            __m512d qd = _mm512_mask_cvtepi32_pd(_mm512_setzero_pd(), 0xFF, _mm256_cvtepu8_epi32(q8));
+            __m512d xv = _mm512_loadu_pd(x + j);
+            sum_x = _mm512_add_pd(sum_x, xv);
+            sum_xq = _mm512_fmadd_pd(xv, qd, sum_xq);
+        }
+        sum += offset[b] * horizontalSum512(sum_x) + scale[b] * horizontalSum512(sum_xq);
+    }
+    if (base < n)
+    {
+        sum += dotU8Block(x + base, q + base, scale[b], offset[b], n - base);
+    }
+    return sum;
+}
+
+#endif // SIMDKERNELS_X86
+
+// ===========================================================|
+// ======================DISPATCH=============================|
+// ===========================================================|
+
+/**
+ * @brief Highest level supported by the CPU, capped by TEXTCLASSIFIER_SIMD.
+ */
+static int detectLevel()
+{
+    int level = SIMD_LEVEL_SCALAR;
+
+#ifdef SIMDKERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+    {
+        level = SIMD_LEVEL_SSE2;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        level = SIMD_LEVEL_AVX2;
+    }
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        level = SIMD_LEVEL_AVX512;
+    }
+#endif
+
+    const char* cap = std::getenv("TEXTCLASSIFIER_SIMD");
+    if (cap)
+    {
+        int max_level = SIMD_LEVEL_AVX512;
+        if (!std::strcmp(cap, "scalar")) max_level = SIMD_LEVEL_SCALAR;
+        else if (!std::strcmp(cap, "sse2")) max_level = SIMD_LEVEL_SSE2;
+        else if (!std::strcmp(cap, "avx2")) max_level = SIMD_LEVEL_AVX2;
+        level = level < max_level ? level : max_level;
+    }
+    return level;
+}
+
+static const KernelTable& kernels()
+{
+    static const KernelTable table = []() -> KernelTable
+    {
+        switch (detectLevel())
+        {
+#ifdef SIMDKERNELS_X86
+        case SIMD_LEVEL_AVX512:
+            return { dotAvx512, dotSparseAvx512, squaredDistanceAvx512,
+                     dotF32Avx512, dotSparseF32Avx2, dotU8Avx512,
+                     axpyAvx2, axpyF32Avx2,
+                     lowerAsciiAvx2, normalizeAsciiAvx2, findByteAvx2, "avx512" };
+        case SIMD_LEVEL_AVX2:
+            return { dotAvx2, dotSparseAvx2, squaredDistanceAvx2,
+                     dotF32Avx2, dotSparseF32Avx2, dotU8Avx2,
+                     axpyAvx2, axpyF32Avx2,
+                     lowerAsciiAvx2, normalizeAsciiAvx2, findByteAvx2, "avx2" };
+        case SIMD_LEVEL_SSE2:
+            return { dotSse2, dotSparseSse2, squaredDistanceSse2,
+                     dotF32Sse2, dotSparseF32Scalar, dotU8Scalar,
+                     axpySse2, axpyF32Sse2,
+                     lowerAsciiSse2, normalizeAsciiSse2, findByteSse2, "sse2" };
+#endif
+        default:
+            return { dotScalar, dotSparseScalar, squaredDistanceScalar,
+                     dotF32Scalar, dotSparseF32Scalar, dotU8Scalar,
+                     axpyScalar, axpyF32Scalar,
+                     lowerAsciiScalar, normalizeAsciiScalar, findByteScalar, "scalar" };
+        }
+    }();
+    return table;
+}
+
+double SimdKernels::dot(const double* a, const double* b, size_t n)
+{
+    return kernels().dot(a, b, n);
+}
+
+double SimdKernels::dotSparse(const int* idx, const double* val, size_t nnz, const double* dense)
+{
+    return kernels().dotSparse(idx, val, nnz, dense);
+}
+
+double SimdKernels::dotSparseSparse(const int* idx_a, const double* val_a, size_t nnz_a,
+                                    const int* idx_b, const double* val_b, size_t nnz_b)
+{
+    // A merge of two sorted index lists is branch bound, vector units do not help here.
+    double sum = 0.0;
+    size_t i = 0, j = 0;
+    while (i < nnz_a && j < nnz_b)
+    {
+        if (idx_a[i] == idx_b[j])
+        {
+            sum += val_a[i++] * val_b[j++];
+        }
+        else if (idx_a[i] < idx_b[j])
+        {
+            ++i;
+        }
+        else
+        {
+            ++j;
+        }
+    }
+    return sum;
+}
+
+double SimdKernels::squaredDistance(const double* a, const double* b, size_t n)
+{
+    return kernels().squaredDistance(a, b, n);
+}
+
+double SimdKernels::dotF32(const double* x, const float* w, size_t n)
+{
+    return kernels().dotF32(x, w, n);
+}
+
+double SimdKernels::dotSparseF32(const int* idx, const double* val, size_t nnz, const float* w)
+{
+    return kernels().dotSparseF32(idx, val, nnz, w);
+}
+
+double SimdKernels::dotU8(const double* x, const uint8_t* q, const float* scale, const float* offset, size_t n)
+{
+    return kernels().dotU8(x, q, scale, offset, n);
+}
+
+double SimdKernels::dotSparseU8(const int* idx, const double* val, size_t nnz,
+                                const uint8_t* q, const float* scale, const float* offset)
+{
+    // Bytes cannot be gathered, the scale and offset lookups dominate anyway.
+    double sum = 0.0;
+    for (size_t i = 0; i < nnz; ++i)
+    {
+        size_t b = static_cast<size_t>(idx[i]) / SIMDKERNELS_QUANT_BLOCK;
+        sum += val[i] * (offset[b] + scale[b] * q[idx[i]]);
+    }
+    return sum;
+}
+
+void SimdKernels::axpy(double a, const double* x, double* y, size_t n)
+{
+    kernels().axpy(a, x, y, n);
+}
+
+void SimdKernels::axpyF32(double a, const float* x, double* y, size_t n)
+{
+    kernels().axpyF32(a, x, y, n);
+}
+
+size_t SimdKernels::lowerAscii(char* text, size_t len)
+{
+    return kernels().lowerAscii(text, len);
+}
+
+size_t SimdKernels::normalizeAscii(char* text, size_t len)
+{
+    return kernels().normalizeAscii(text, len);
+}
+
+size_t SimdKernels::findByte(const char* text, size_t len, char byte)
+{
+    return kernels().findByte(text, len, byte);
+}
+
+const char* SimdKernels::name()
+{
+    return kernels().name;
+}
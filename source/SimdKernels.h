@@ -0,0 +1,200 @@
+/**
+ * @file SimdKernels.h
+ * @brief Dot product and distance kernels with runtime CPU dispatch.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef SIMDKERNELS_H__
+#define SIMDKERNELS_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#define SIMDKERNELS_QUANT_BLOCK     64  /**< Weights per scale/offset pair of 8-bit weights. */
+
+/**
+ * @class SimdKernels
+ * @brief Small library of vector kernels used on the scoring paths.
+ *
+ * Every kernel has a scalar, SSE2, AVX2 (with FMA) and AVX-512 implementation.
+ * The widest one the CPU supports is picked by CPUID the first time a kernel
+ * is called, so a single binary runs well on any x86-64 machine. Setting the
+ * environment variable TEXTCLASSIFIER_SIMD to scalar, sse2, avx2 or avx512
+ * caps the selection, which is handy to compare results across levels.
+ *
+ * Sparse vectors are given as parallel arrays of indices and values. The
+ * sparse-sparse kernel expects both index arrays sorted in ascending order.
+ *
+ * Results of different levels may differ in the last bits because the sums
+ * are accumulated in a different order. The text kernels give identical
+ * results on every level.
+ */
+class SimdKernels
+{
+public:
+    /**
+     * @brief Dense-dense dot product.
+     *
+     * @param a First vector.
+     * @param b Second vector.
+     * @param n Length of both vectors.
+     * @return Sum of a[i] * b[i].
+     */
+    static double dot(const double* a, const double* b, size_t n);
+
+    /**
+     * @brief Sparse-dense dot product.
+     *
+     * @param idx Indices of the non-zero entries of the sparse vector.
+     * @param val Values of the non-zero entries of the sparse vector.
+     * @param nnz Number of non-zero entries.
+     * @param dense Dense vector, long enough for every index.
+     * @return Sum of val[i] * dense[idx[i]].
+     */
+    static double dotSparse(const int* idx, const double* val, size_t nnz, const double* dense);
+
+    /**
+     * @brief Sparse-sparse dot product of two vectors with sorted indices.
+     *
+     * @param idx_a Sorted indices of the first vector.
+     * @param val_a Values of the first vector.
+     * @param nnz_a Number of non-zero entries of the first vector.
+     * @param idx_b Sorted indices of the second vector.
+     * @param val_b Values of the second vector.
+     * @param nnz_b Number of non-zero entries of the second vector.
+     * @return Dot product of both vectors.
+     */
+    static double dotSparseSparse(const int* idx_a, const double* val_a, size_t nnz_a,
+                                  const int* idx_b, const double* val_b, size_t nnz_b);
+
+    /**
+     * @brief Squared Euclidean distance of two dense vectors.
+     *
+     * @param a First vector.
+     * @param b Second vector.
+     * @param n Length of both vectors.
+     * @return Sum of (a[i] - b[i])^2.
+     */
+    static double squaredDistance(const double* a, const double* b, size_t n);
+
+    /**
+     * @brief Dot product of dense features with float32 weights.
+     *
+     * @param x Dense feature vector.
+     * @param w Weights stored as float.
+     * @param n Length of both vectors.
+     * @return Sum of x[i] * w[i].
+     */
+    static double dotF32(const double* x, const float* w, size_t n);
+
+    /**
+     * @brief Dot product of sparse features with float32 weights.
+     *
+     * @param idx Indices of the non-zero features.
+     * @param val Values of the non-zero features.
+     * @param nnz Number of non-zero features.
+     * @param w Weights stored as float.
+     * @return Sum of val[i] * w[idx[i]].
+     */
+    static double dotSparseF32(const int* idx, const double* val, size_t nnz, const float* w);
+
+    /**
+     * @brief Dot product of dense features with 8-bit block quantised weights.
+     *
+     * Weight i is offset[b] + scale[b] * q[i] with b = i / SIMDKERNELS_QUANT_BLOCK,
+     * so each block is reduced to two sums before the affine map is applied.
+     *
+     * @param x Dense feature vector.
+     * @param q 8-bit codes of the weights.
+     * @param scale Per block scale.
+     * @param offset Per block offset.
+     * @param n Length of both vectors.
+     * @return Sum of x[i] * w[i].
+     */
+    static double dotU8(const double* x, const uint8_t* q, const float* scale, const float* offset, size_t n);
+
+    /**
+     * @brief Dot product of sparse features with 8-bit block quantised weights.
+     *
+     * @param idx Indices of the non-zero features.
+     * @param val Values of the non-zero features.
+     * @param nnz Number of non-zero features.
+     * @param q 8-bit codes of the weights.
+     * @param scale Per block scale.
+     * @param offset Per block offset.
+     * @return Sum of val[i] * w[idx[i]].
+     */
+    static double dotSparseU8(const int* idx, const double* val, size_t nnz,
+                              const uint8_t* q, const float* scale, const float* offset);
+
+    /**
+     * @brief Add a scaled vector to another, y += a * x.
+     *
+     * Adds one row of a features x classes weight matrix to the class scores.
+     *
+     * @param a Scale.
+     * @param x Vector to add.
+     * @param y Vector added to.
+     * @param n Length of both vectors.
+     */
+    static void axpy(double a, const double* x, double* y, size_t n);
+
+    /**
+     * @brief Add a scaled float32 vector to a double vector, y += a * x.
+     *
+     * @param a Scale.
+     * @param x Vector to add, stored as float.
+     * @param y Vector added to.
+     * @param n Length of both vectors.
+     */
+    static void axpyF32(double a, const float* x, double* y, size_t n);
+
+    /**
+     * @brief Lower case ASCII letters in place, up to the first byte >= 0x80.
+     *
+     * @param text Bytes to convert.
+     * @param len Number of bytes.
+     * @return Number of bytes converted, the length of the leading ASCII run.
+     */
+    static size_t lowerAscii(char* text, size_t len);
+
+    /**
+     * @brief Normalise ASCII text in place for tokenisation, up to the first byte >= 0x80.
+     *
+     * Newlines and bytes that are neither alphanumeric, white space nor
+     * punctuation in the C locale become spaces, upper case letters become
+     * lower case. This is the same as testing every byte with isalnum, isspace
+     * and ispunct and calling tolower, without the locale lookups.
+     *
+     * @param text Bytes to convert.
+     * @param len Number of bytes.
+     * @return Number of bytes converted, the length of the leading ASCII run.
+     */
+    static size_t normalizeAscii(char* text, size_t len);
+
+    /**
+     * @brief Position of the first occurrence of a byte, used to find line ends.
+     *
+     * @param text Bytes to search.
+     * @param len Number of bytes.
+     * @param byte Byte to find.
+     * @return Offset of the byte, len if it does not occur.
+     */
+    static size_t findByte(const char* text, size_t len, char byte);
+
+    /**
+     * @brief Name of the selected implementation.
+     *
+     * @return One of "scalar", "sse2", "avx2" or "avx512".
+     */
+    static const char* name();
+};
+
+#endif // SIMDKERNELS_H__
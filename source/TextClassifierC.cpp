@@ -0,0 +1,154 @@
+/**
+ * @file TextClassifierC.cpp
+ * @brief Implementation of the C interface on top of TextClassifierFactory.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include <cstring>
+#include <fstream>
+#include <exception>
+
+#include "TextClassifierC.h"
+#include "ModelRegistry.h"
+
+/**
+ * @brief Definition of the opaque handle.
+ */
+struct tc_model
+{
+    ModelRegistry registry;                 /**< Current model, replaced by tc_model_reload. */
+
+    tc_model(int vectorizer_id, int classifier_id) : registry(vectorizer_id, classifier_id) {}
+};
+
+/**
+ * @brief Version of this interface.
+ */
+int tc_abi_version(void)
+{
+    return TC_ABI_VERSION;
+}
+
+/**
+ * @brief Load a model written by the mltextclassifier f command.
+ */
+tc_model* tc_model_load(const char* model_path, int vectorizer_id, int classifier_id)
+{
+    if (model_path == nullptr)
+    {
+        return nullptr;
+    }
+
+    tc_model* model = new tc_model(vectorizer_id, classifier_id);
+    if (!model->registry.load(model_path))
+    {
+        delete model;
+        return nullptr;
+    }
+    return model;
+}
+
+/**
+ * @brief Replace the model of a handle with a new model file.
+ */
+int tc_model_reload(tc_model* model, const char* model_path)
+{
+    if (model == nullptr || model_path == nullptr)
+    {
+        return TC_ERROR_ARGUMENT;
+    }
+    return model->registry.load(model_path) ? TC_OK : TC_ERROR_LOAD;
+}
+
+/**
+ * @brief Release a model returned by tc_model_load.
+ */
+void tc_model_free(tc_model* model)
+{
+    delete model;
+}
+
+/**
+ * @brief Classify one text.
+ */
+int tc_predict(tc_model* model, const char* text, size_t len, int preprocess, tc_prediction* out)
+{
+    return tc_predict_batch(model, &text, &len, 1, preprocess, out);
+}
+
+/**
+ * @brief Classify many texts in one call.
+ */
+int tc_predict_batch(tc_model* model, const char* const* texts, const size_t* lens, size_t n,
+                     int preprocess, tc_prediction* out)
+{
+    if (model == nullptr || out == nullptr || (n > 0 && texts == nullptr))
+    {
+        return TC_ERROR_ARGUMENT;
+    }
+
+    std::string_view views[PREDICT_BATCH_SIZE];
+    Prediction results[PREDICT_BATCH_SIZE];
+
+    // The whole call scores with one model, even if it is reloaded meanwhile.
+    ModelRegistry::Model clsfr = model->registry.current();
+
+    try
+    {
+        for (size_t start = 0; start < n; start += PREDICT_BATCH_SIZE)
+        {
+            size_t count = std::min<size_t>(PREDICT_BATCH_SIZE, n - start);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const char* text = texts[start + i];
+                if (text == nullptr)
+                {
+                    views[i] = std::string_view();
+                }
+                else
+                {
+                    views[i] = std::string_view(text, lens ? lens[start + i] : std::strlen(text));
+                }
+            }
+
+            clsfr->predictBatch(std::span<const std::string_view>(views, count),
+                                       std::span<Prediction>(results, count), preprocess != 0);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                out[start + i].label = results[i].label;
+                out[start + i].probability = results[i].probability;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: Prediction failed: " << e.what() << "\n";
+        return TC_ERROR_INTERNAL;
+    }
+    return TC_OK;
+}
+
+/**
+ * @brief Name of a class as it appeared in the training labels.
+ */
+const char* tc_label_name(const tc_model* model, int label)
+{
+    if (model == nullptr)
+    {
+        return nullptr;
+    }
+    ModelRegistry::Model clsfr = model->registry.current();
+    if (label < 0 || label >= clsfr->pVec->getClassLabels().size())
+    {
+        return nullptr;
+    }
+    return clsfr->labelName(label).c_str();
+}
@@ -0,0 +1,140 @@
+/**
+ * @file TextClassifierC.h
+ * @brief C interface to load a trained model and classify text in-process.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef TEXTCLASSIFIERC_H__
+#define TEXTCLASSIFIERC_H__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define TC_API __declspec(dllexport)
+#else
+#define TC_API __attribute__((visibility("default")))
+#endif
+
+#define TC_ABI_VERSION          2       /**< Bumped whenever a signature or struct below changes. */
+
+#define TC_OK                   0       /**< Call succeeded. */
+#define TC_ERROR_ARGUMENT       -1      /**< A required pointer was NULL. */
+#define TC_ERROR_INTERNAL       -2      /**< The classifier failed while scoring. */
+#define TC_ERROR_LOAD           -3      /**< The model file could not be loaded or failed validation. */
+
+/**
+ * @brief Opaque handle to a loaded model.
+ *
+ * Any number of threads may call tc_predict, tc_predict_batch and
+ * tc_label_name on one handle at the same time, and tc_model_reload may run
+ * meanwhile. Only tc_model_free must wait until every other call returned.
+ */
+typedef struct tc_model tc_model;
+
+/**
+ * @struct tc_prediction
+ * @brief Result of classifying one text.
+ */
+typedef struct tc_prediction
+{
+    int label;              /**< Class index of the predicted label, see tc_label_name. */
+    double probability;     /**< Probability of the predicted label. */
+} tc_prediction;
+
+/**
+ * @brief Version of this interface, compare against TC_ABI_VERSION at load time.
+ *
+ * @return TC_ABI_VERSION of the library.
+ */
+TC_API int tc_abi_version(void);
+
+/**
+ * @brief Load a model written by the mltextclassifier f command.
+ *
+ * The model file does not record which vectorizer and classifier produced
+ * it, so the same ids as on the command line must be given.
+ *
+ * @param model_path Path to the model file.
+ * @param vectorizer_id Vectorizer id, see ID_VECTORIZER_*.
+ * @param classifier_id Classifier id, see ID_CLASSIFIER_*.
+ * @return Handle to the model, or NULL if the ids are invalid or the file cannot be read.
+ */
+TC_API tc_model* tc_model_load(const char* model_path, int vectorizer_id, int classifier_id);
+
+/**
+ * @brief Replace the model of a handle with a new model file.
+ *
+ * The file is loaded and validated on the calling thread while other threads
+ * keep predicting with the current model. Calls that started before the swap
+ * finish on the old model. If the new file cannot be used, the current model
+ * stays in place.
+ *
+ * @param model Handle returned by tc_model_load.
+ * @param model_path Path to the new model file, same vectorizer and classifier ids.
+ * @return TC_OK, TC_ERROR_ARGUMENT or TC_ERROR_LOAD.
+ */
+TC_API int tc_model_reload(tc_model* model, const char* model_path);
+
+/**
+ * @brief Release a model returned by tc_model_load. NULL is ignored.
+ *
+ * @param model Model to release.
+ */
+TC_API void tc_model_free(tc_model* model);
+
+/**
+ * @brief Classify one text.
+ *
+ * @param model Loaded model.
+ * @param text UTF-8 text, need not be NUL terminated.
+ * @param len Length of text in bytes.
+ * @param preprocess Non-zero to lower case the text and blank out unexpected bytes first.
+ * @param out Receives the prediction.
+ * @return TC_OK or one of the TC_ERROR_* codes.
+ */
+TC_API int tc_predict(tc_model* model, const char* text, size_t len, int preprocess, tc_prediction* out);
+
+/**
+ * @brief Classify many texts in one call.
+ *
+ * Texts are scored PREDICT_BATCH_SIZE at a time through the batch path of
+ * the classifier, which is much cheaper per text than calling tc_predict
+ * in a loop.
+ *
+ * @param model Loaded model.
+ * @param texts Array of n UTF-8 texts.
+ * @param lens Array of n lengths in bytes, or NULL if every text is NUL terminated.
+ * @param n Number of texts.
+ * @param preprocess Non-zero to lower case the texts and blank out unexpected bytes first.
+ * @param out Array of n predictions to fill.
+ * @return TC_OK or one of the TC_ERROR_* codes.
+ */
+TC_API int tc_predict_batch(tc_model* model, const char* const* texts, const size_t* lens, size_t n,
+                            int preprocess, tc_prediction* out);
+
+/**
+ * @brief Name of a class as it appeared in the training labels.
+ *
+ * @param model Loaded model.
+ * @param label Class index, e.g. tc_prediction::label.
+ * @return NUL terminated label owned by the model, valid until the model is
+ *         reloaded or released, or NULL if the index is out of range.
+ */
+TC_API const char* tc_label_name(const tc_model* model, int label);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEXTCLASSIFIERC_H__
@@ -21,16 +21,20 @@ TextClassifierFactory::~TextClassifierFactory()
 TextClassifierFactory::Product TextClassifierFactory::getTextClassifier(int vectorizer_id, int classifier_id)
 {
 	shared_ptr<BaseClassifier> pclsfr = nullptr;
-	BaseVectorizer *pVec = NULL;
+	shared_ptr<BaseVectorizer> pVec = nullptr;
 
 	switch (vectorizer_id)
     {
         case ID_VECTORIZER_COUNT:
-            pVec = new CountVectorizer();
+            pVec = make_shared<CountVectorizer>();
             break;
 
         case ID_VECTORIZER_TFIDF:
-            pVec = new TfidfVectorizer();
+            pVec = make_shared<TfidfVectorizer>();
+            break;
+
+        case ID_VECTORIZER_HASHING:
+            pVec = make_shared<HashingVectorizer>();
             break;
 
         default:
@@ -68,7 +72,6 @@ TextClassifierFactory::Product TextClassifierFactory::getTextClassifier(int vect
 			break;
 
 		default:
-			delete pVec;
 			return nullptr;
 	}
 
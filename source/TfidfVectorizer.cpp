@@ -42,41 +42,59 @@ TfidfVectorizer::~TfidfVectorizer()
 
 void TfidfVectorizer::fit(string abs_filepath_to_features, string abs_filepath_to_labels)
 {
-    ifstream in;
-    string feature_output;
-    string label_output;
-    vector<string> features;
-    vector<bool> labels;
+    if (isCorpusFile(abs_filepath_to_features))
+    {
+        loadCorpus(abs_filepath_to_features);
+        return;
+    }
 
-    in.open(abs_filepath_to_features);
+    LineReader in;
+    LineReader labels_in;
+    string pipe_text;
+    string_view feature_output;
+    string_view label_output;
+    vector<string_view> lines;
+    vector<int> labels;
 
-    if (!in)
+    if (!in.open(abs_filepath_to_features))
     {
         cout << "ERROR: Cannot open features file.\n";
         return;
     }
 
-    while (getline(in, feature_output))
+    // The features are read twice, a pipe is kept in memory to be read again.
+    if (!in.isMapped())
     {
-        features.push_back(feature_output);
+        while (in.next(feature_output))
+        {
+            pipe_text.append(feature_output);
+            pipe_text.push_back('\n');
+        }
+        in.assign(pipe_text);
     }
-    in.close();
 
-    in.open(abs_filepath_to_labels);
+    // Document frequencies for min_df and max_features are counted in a first pass.
+    unsigned int feature_size = 0;
+    beginVocabularyCount();
+    while (in.next(feature_output))
+    {
+        countDocument(feature_output);
+        feature_size++;
+    }
+    endVocabularyCount();
 
-    if (!in)
+    if (!labels_in.open(abs_filepath_to_labels))
     {
         cout << "ERROR: Cannot open labels file.\n";
         return;
     }
 
-    while (getline(in, label_output))
+    while (labels_in.next(label_output))
     {
-        labels.push_back((bool)stoi(label_output));
+        labels.push_back(class_labels.add(label_output));
     }
-    in.close();
+    labels_in.close();
 
-    unsigned int feature_size = features.size();
     if (feature_size != labels.size())
     {
         cout << "ERROR: Feature dimension is different from label dimension\n";
@@ -84,33 +102,97 @@ void TfidfVectorizer::fit(string abs_filepath_to_features, string abs_filepath_t
     }
 
     cout << "fitting TfidfVectorizer..." << endl;
-    int perc, prevperc;
+    int perc = -1, prevperc;
+    size_t first_sentence = sentences.size();
+    unsigned int i = 0;
 
-    for (unsigned int i = 0; i < feature_size; i++)
+    // The text is cut at line ends into blocks that are tokenised in parallel
+    // straight from the mapping, the vocabulary grows in order.
+    for (string_view block : LineReader::split(in.data(), (feature_size + FIT_BLOCK_SENTENCES - 1) / FIT_BLOCK_SENTENCES))
     {
-        addSentence(features[i], labels[i]);
+        LineReader block_in;
+        block_in.assign(block);
+        lines.clear();
+        while (block_in.next(feature_output))
+        {
+            lines.push_back(feature_output);
+        }
 
-        prevperc = perc;
-        perc = int(float(i) / feature_size * 100);
-        if (prevperc != perc)
+        vector<vector<string>> tokens = buildSentenceVectors(lines);
+        for (size_t j = 0; j < tokens.size(); j++, i++)
         {
-            cout << perc << " % done" << endl;
+            addSentenceTokens(std::move(tokens[j]), labels[i]);
+
+            prevperc = perc;
+            perc = int(float(i) / feature_size * 100);
+            if (prevperc != perc)
+            {
+                cout << perc << " % done" << endl;
+            }
         }
     }
+    in.close();
     cout << endl;
 
+    applyVocabularyLimits();
+    sortLabels();
+
     // Calculate IDF values
-    for (const auto& word_idx : word_to_idx)
+    updateIdf(first_sentence);
+}
+
+void TfidfVectorizer::partial_fit(string abs_filepath_to_features, string abs_filepath_to_labels)
+{
+    size_t first_sentence = sentences.size();
+    BaseVectorizer::partial_fit(abs_filepath_to_features, abs_filepath_to_labels);
+    updateIdf(first_sentence);
+}
+
+bool TfidfVectorizer::remapFeatures(const std::vector<int>& old_to_new)
+{
+    if (!BaseVectorizer::remapFeatures(old_to_new))
+    {
+        return false;
+    }
+
+    unordered_map<int, double> kept_idf;
+    vector<int> kept_freqs(word_array.size(), 0);
+    for (size_t i = 0; i < old_to_new.size(); ++i)
     {
-        int doc_count = 0;
-        for (const auto& sentence : sentences)
+        if (old_to_new[i] < 0)
         {
-            if (sentence->sentence_map.count(word_idx.second))
-            {
-                doc_count++;
-            }
+            continue;
+        }
+        auto it = idf_values.find(i);
+        if (it != idf_values.end())
+        {
+            kept_idf[old_to_new[i]] = it->second;
+        }
+        if (i < doc_freqs.size())
+        {
+            kept_freqs[old_to_new[i]] = doc_freqs[i];
+        }
+    }
+    idf_values.swap(kept_idf);
+    doc_freqs.swap(kept_freqs);
+    return true;
+}
+
+void TfidfVectorizer::updateIdf(size_t first_sentence)
+{
+    // Document frequencies in one pass, n-grams make the vocabulary too large to rescan per word
+    doc_freqs.resize(word_array.size(), 0);
+    for (size_t i = first_sentence; i < sentences.size(); ++i)
+    {
+        for (const auto& entry : sentences[i]->sentence_map)
+        {
+            doc_freqs[entry.first]++;
         }
-        idf_values[word_idx.second] = log1p(double(sentences.size()) / (1 + doc_count));
+    }
+    doc_count += sentences.size() - first_sentence;
+    for (int idx = 0; idx < (int)word_array.size(); ++idx)
+    {
+        idf_values[idx] = log1p(double(doc_count) / (1 + doc_freqs[idx]));
     }
 }
 
@@ -161,29 +243,33 @@ int TfidfVectorizer::is_wordInSentence(Sentence sentence_, unsigned int idx)
 
 void TfidfVectorizer::pushSentenceToWordArray(vector<string> new_sentence_vector)
 {
-    for (const string& word : new_sentence_vector)
+    forEachFeature(new_sentence_vector, [&](uint64_t hash, const FeatureSpan& span)
     {
-        if (!ContainsWord(word) && !histogram.count(word))
+        if (!vocab_filter.admits(hash))
         {
-            word_array.push_back(word);
-            word_to_idx[word] = word_array.size() - 1;
+            return;
         }
-    }
+        if (!hash_to_idx.count(hash))
+        {
+            word_array.push_back(featureName(new_sentence_vector, span));
+            hash_to_idx[hash] = word_array.size() - 1;
+        }
+    });
 }
 
-shared_ptr<Sentence> TfidfVectorizer::createSentenceObject(vector<string> new_sentence_vector, bool label_)
+shared_ptr<Sentence> TfidfVectorizer::createSentenceObject(vector<string> new_sentence_vector, int label_)
 {
     shared_ptr<Sentence> new_sentence(new Sentence);
     unordered_map<int, int> term_freqs;
 
-    for (const auto& word : new_sentence_vector)
+    forEachFeature(new_sentence_vector, [&](uint64_t hash, const FeatureSpan& span)
     {
-        if (histogram.count(word))
+        auto it = hash_to_idx.find(hash);
+        if (it == hash_to_idx.end())
         {
-            continue;
+            return;
         }
-
-        int idx = word_to_idx[word];
+        int idx = it->second;
         if (term_freqs.count(idx))
         {
             term_freqs[idx]++;
@@ -192,7 +278,7 @@ shared_ptr<Sentence> TfidfVectorizer::createSentenceObject(vector<string> new_se
         {
             term_freqs[idx] = 1;
         }
-    }
+    });
 
     for (const auto& entry : term_freqs)
     {
@@ -203,10 +289,19 @@ shared_ptr<Sentence> TfidfVectorizer::createSentenceObject(vector<string> new_se
     return new_sentence;
 }
 
-void TfidfVectorizer::addSentence(string new_sentence, bool label_)
+void TfidfVectorizer::addSentence(string new_sentence, int label_)
+{
+    addSentenceTokens(buildSentenceVector(new_sentence), label_);
+}
+
+/**
+ * @brief Add a tokenised sentence to the vocabulary and the corpus.
+ *
+ * @param processedString Tokens of the sentence, see buildSentenceVector.
+ * @param label_ Class index of the sentence.
+ */
+void TfidfVectorizer::addSentenceTokens(vector<string> processedString, int label_)
 {
-    vector<string> processedString;
-    processedString = buildSentenceVector(new_sentence);
     pushSentenceToWordArray(processedString);
     shared_ptr<Sentence> sentObj = createSentenceObject(processedString, label_);
     sentences.push_back(sentObj);
@@ -214,7 +309,7 @@ void TfidfVectorizer::addSentence(string new_sentence, bool label_)
 
 bool TfidfVectorizer::ContainsWord(const string& word_to_check)
 {
-    return word_to_idx.count(word_to_check) > 0;
+    return hash_to_idx.count(hashString(word_to_check)) > 0;
 }
 
 std::vector<double> TfidfVectorizer::getFrequencies(std::unordered_map<int, double> term_freqs) const
@@ -233,19 +328,19 @@ std::vector<double> TfidfVectorizer::getFrequencies(std::unordered_map<int, doub
     return sentence_features;
 }
 
-std::vector<double> TfidfVectorizer::getSentenceFeatures(std::vector<std::string> sentence_words) const
+void TfidfVectorizer::getSentenceFeatures(const TokenList& sentence_words, PredictContext& ctx, FeatureVector& sentence_features) const
 {
-    std::vector<double> sentence_features(word_array.size(), 0.0);
-    unordered_map<int, int> term_freqs;
+    sentence_features.assign(word_array.size(), 0.0);
+    std::pmr::unordered_map<int, int> term_freqs(ctx.resource());
 
-    for (const std::string& word : sentence_words)
+    forEachFeature(sentence_words, [&](uint64_t hash, const FeatureSpan& span)
     {
-        if (word_to_idx.count(word) > 0)
+        auto it = hash_to_idx.find(hash);
+        if (it != hash_to_idx.end())
         {
-            int idx = word_to_idx.at(word);
-            term_freqs[idx]++;
+            term_freqs[it->second]++;
         }
-    }
+    });
 
     for (const auto& entry : term_freqs)
     {
@@ -255,7 +350,26 @@ std::vector<double> TfidfVectorizer::getSentenceFeatures(std::vector<std::string
         double idf = idf_values.at(term_idx);
         sentence_features[term_idx] = tf * idf;
     }
-    return sentence_features;
+}
+
+void TfidfVectorizer::appendSparseFeatures(std::string_view text, PredictContext& ctx, SparseBatch& batch) const
+{
+    forEachTextFeature(text, [&](uint64_t hash, const FeatureSpan& span)
+    {
+        auto it = hash_to_idx.find(hash);
+        if (it != hash_to_idx.end())
+        {
+            batch.col_idx.push_back(it->second);
+            batch.values.push_back(1.0);
+        }
+    });
+    closeSparseRow(batch, ctx);
+
+    // Entries now hold the term frequencies of the row.
+    for (size_t i = batch.row_ptr[batch.rows() - 1]; i < batch.row_ptr.back(); ++i)
+    {
+        batch.values[i] *= idf_values.at(batch.col_idx[i]);
+    }
 }
 
 void TfidfVectorizer::save(std::ofstream& outFile) const
@@ -298,27 +412,42 @@ void TfidfVectorizer::save(std::ofstream& outFile) const
     outFile.write(reinterpret_cast<const char*>(&binary), sizeof(binary));
     outFile.write(reinterpret_cast<const char*>(&case_sensitive), sizeof(case_sensitive));
     outFile.write(reinterpret_cast<const char*>(&include_stopwords), sizeof(include_stopwords));
+
+    saveFeatureConfig(outFile);
+
+    size_t hash_size = hash_to_idx.size();
+    outFile.write(reinterpret_cast<const char*>(&hash_size), sizeof(hash_size));
+    for (const auto& entry : hash_to_idx)
+    {
+        outFile.write(reinterpret_cast<const char*>(&entry.first), sizeof(entry.first));
+        outFile.write(reinterpret_cast<const char*>(&entry.second), sizeof(entry.second));
+    }
+
+    // Kept so that partial_fit can update the IDF values.
+    outFile.write(reinterpret_cast<const char*>(&doc_count), sizeof(doc_count));
+    size_t doc_freqs_size = doc_freqs.size();
+    outFile.write(reinterpret_cast<const char*>(&doc_freqs_size), sizeof(doc_freqs_size));
+    outFile.write(reinterpret_cast<const char*>(doc_freqs.data()), doc_freqs_size * sizeof(int));
 }
 
 void TfidfVectorizer::load(std::ifstream& inFile)
 {
     word_array.clear();
-    word_to_idx.clear();
+    hash_to_idx.clear();
     sentences.clear();
     idf_values.clear();
 
     inFile.read(reinterpret_cast<char*>(&vers_info), sizeof(vers_info));
 
-    size_t word_array_size;
+    size_t word_array_size = 0;
     inFile.read(reinterpret_cast<char*>(&word_array_size), sizeof(word_array_size));
     word_array.resize(word_array_size);
-    for (size_t i = 0; i < word_array_size; ++i)
+    for (size_t i = 0; i < word_array_size && inFile; ++i)
     {
-        size_t word_size;
+        size_t word_size = 0;
         inFile.read(reinterpret_cast<char*>(&word_size), sizeof(word_size));
         word_array[i].resize(word_size);
         inFile.read(&word_array[i][0], word_size);
-        word_to_idx[word_array[i]] = i;
     }
 
     /*
@@ -343,9 +472,9 @@ void TfidfVectorizer::load(std::ifstream& inFile)
     }
     */
 
-    size_t idf_size;
+    size_t idf_size = 0;
     inFile.read(reinterpret_cast<char*>(&idf_size), sizeof(idf_size));
-    for (size_t i = 0; i < idf_size; ++i)
+    for (size_t i = 0; i < idf_size && inFile; ++i)
     {
         int key;
         double value;
@@ -357,4 +486,23 @@ void TfidfVectorizer::load(std::ifstream& inFile)
     inFile.read(reinterpret_cast<char*>(&binary), sizeof(binary));
     inFile.read(reinterpret_cast<char*>(&case_sensitive), sizeof(case_sensitive));
     inFile.read(reinterpret_cast<char*>(&include_stopwords), sizeof(include_stopwords));
+
+    loadFeatureConfig(inFile);
+
+    size_t hash_size = 0;
+    inFile.read(reinterpret_cast<char*>(&hash_size), sizeof(hash_size));
+    for (size_t i = 0; i < hash_size && inFile; ++i)
+    {
+        uint64_t key;
+        int value;
+        inFile.read(reinterpret_cast<char*>(&key), sizeof(key));
+        inFile.read(reinterpret_cast<char*>(&value), sizeof(value));
+        hash_to_idx[key] = value;
+    }
+
+    inFile.read(reinterpret_cast<char*>(&doc_count), sizeof(doc_count));
+    size_t doc_freqs_size = 0;
+    inFile.read(reinterpret_cast<char*>(&doc_freqs_size), sizeof(doc_freqs_size));
+    doc_freqs.resize(doc_freqs_size);
+    inFile.read(reinterpret_cast<char*>(doc_freqs.data()), doc_freqs_size * sizeof(int));
 }
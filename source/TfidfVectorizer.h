@@ -20,7 +20,6 @@ Revision History:
 #include <fstream>
 #include <sstream>
 
-#include "GlobalData.h"
 #include "BaseVectorizer.h"
 
 /**
@@ -76,6 +75,20 @@ public:
      */
     void fit(string abs_filepath_to_features, string abs_filepath_to_labels) override;
 
+    /**
+     * @brief Add more sentences and update the document frequencies and IDF values.
+     * @param abs_filepath_to_features Absolute filepath to the new features file.
+     * @param abs_filepath_to_labels Absolute filepath to the new labels file.
+     */
+    void partial_fit(string abs_filepath_to_features, string abs_filepath_to_labels) override;
+
+    /**
+     * @brief Drop features and renumber the rest, along with their IDF values and document frequencies.
+     * @param old_to_new New index of every feature, -1 to drop it.
+     * @return False if old_to_new does not match the vocabulary.
+     */
+    bool remapFeatures(const std::vector<int>& old_to_new) override;
+
     /**
      * @brief Print the shape of the data.
      */
@@ -103,17 +116,25 @@ public:
     /**
      * @brief Create a sentence object.
      * @param new_sentence_vector The sentence vector.
-     * @param label_ The label of the sentence.
+     * @param label_ Class index of the sentence.
      * @return Shared pointer to the created sentence object.
      */
-    shared_ptr<Sentence> createSentenceObject(vector<string> new_sentence_vector, bool label_);
+    shared_ptr<Sentence> createSentenceObject(vector<string> new_sentence_vector, int label_);
+
+    /**
+     * @brief Add a tokenised sentence to the word array and the sentences.
+     *
+     * @param processedString Tokens of the sentence, see buildSentenceVector.
+     * @param label_ Class index of the sentence.
+     */
+    void addSentenceTokens(vector<string> processedString, int label_);
 
     /**
      * @brief Add a sentence to the vectorizer.
      * @param new_sentence The sentence to add.
-     * @param label_ The label of the sentence.
+     * @param label_ Class index of the sentence.
      */
-    void addSentence(string new_sentence, bool label_) override;
+    void addSentence(string new_sentence, int label_) override;
 
     /**
      * @brief Check if a word is present in the vectorizer.
@@ -151,9 +172,19 @@ public:
     /**
      * @brief Get the TF-IDF features for a sentence.
      * @param sentence_words The words in the sentence.
-     * @return The TF-IDF features for the sentence.
+     * @param ctx Context providing the scratch memory.
+     * @param sentence_features Receives the TF-IDF features for the sentence.
+     */
+    void getSentenceFeatures(const TokenList& sentence_words, PredictContext& ctx, FeatureVector& sentence_features) const override;
+
+    /**
+     * @brief Append the features of a sentence as a row of a sparse batch.
+     *
+     * @param text The normalised sentence.
+     * @param ctx Context providing the scratch memory.
+     * @param batch Batch to append the row to.
      */
-    std::vector<double> getSentenceFeatures(std::vector<std::string> sentence_words) const override;
+    void appendSparseFeatures(std::string_view text, PredictContext& ctx, SparseBatch& batch) const override;
 
     std::vector<double> getFrequencies(std::unordered_map<int, double> term_freqs) const override;
 
@@ -171,6 +202,14 @@ public:
 
 private:
     unordered_map<int, double> idf_values;  ///< Store IDF values
+    vector<int> doc_freqs;                  ///< Number of documents containing each feature
+    size_t doc_count = 0;                   ///< Number of documents seen so far
+
+    /**
+     * @brief Count the documents of new sentences and recompute every IDF value.
+     * @param first_sentence Index of the first sentence not counted yet.
+     */
+    void updateIdf(size_t first_sentence);
 };
 
 #endif // TFIDFVECTORIZER_H__
@@ -0,0 +1,278 @@
+/**
+ * @file ThreadPool.cpp
+ * @brief Implementation of the ThreadPool class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+    /**
+     * @struct SharedSettings
+     * @brief Size and pinning of the shared pool.
+     */
+    struct SharedSettings
+    {
+        unsigned int num_threads = 0; /**< 0 for one per core. */
+        bool pin_threads = false; /**< Pin the workers. */
+        bool configured = false; /**< Set by configureShared, the environment is not read then. */
+        bool started = false; /**< The shared pool exists, settings cannot change anymore. */
+    };
+
+    std::mutex shared_mutex;
+    SharedSettings shared_settings;
+
+    /**
+     * @brief Settings of the shared pool, which is started with them.
+     */
+    SharedSettings startShared()
+    {
+        std::lock_guard<std::mutex> lock(shared_mutex);
+        if (!shared_settings.configured)
+        {
+            if (const char* threads = std::getenv("TEXTCLASSIFIER_THREADS"))
+            {
+                shared_settings.num_threads = static_cast<unsigned int>(std::strtoul(threads, nullptr, 10));
+            }
+            if (const char* pin = std::getenv("TEXTCLASSIFIER_PIN_THREADS"))
+            {
+                shared_settings.pin_threads = std::atoi(pin) != 0;
+            }
+        }
+        shared_settings.started = true;
+        return shared_settings;
+    }
+
+    inline uint64_t packRange(uint32_t front, uint32_t back)
+    {
+        return static_cast<uint64_t>(back) << 32 | front;
+    }
+
+    inline uint32_t rangeFront(uint64_t range)
+    {
+        return static_cast<uint32_t>(range);
+    }
+
+    inline uint32_t rangeBack(uint64_t range)
+    {
+        return static_cast<uint32_t>(range >> 32);
+    }
+}
+
+ThreadPool::ThreadPool(unsigned int num_threads, bool pin_threads)
+    : generation(0), busy(0), stopping(false), fn(nullptr), arg(nullptr), total(0), chunk(1)
+{
+    if (num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    slots = std::make_unique<Slot[]>(num_threads);
+
+    // Worker i goes to the i-th CPU the process may run on, wrapping around.
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (pin_threads && sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+            {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+
+    for (unsigned int i = 1; i < num_threads; ++i)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+#ifdef __linux__
+        if (!cpus.empty())
+        {
+            cpu_set_t cpu;
+            CPU_ZERO(&cpu);
+            CPU_SET(cpus[i % cpus.size()], &cpu);
+            pthread_setaffinity_np(workers.back().native_handle(), sizeof(cpu), &cpu);
+        }
+#endif
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared()
+{
+    static const SharedSettings settings = startShared();
+    static ThreadPool pool(settings.num_threads, settings.pin_threads);
+    return pool;
+}
+
+bool ThreadPool::configureShared(unsigned int num_threads, bool pin_threads)
+{
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    if (shared_settings.started)
+    {
+        return false;
+    }
+    shared_settings.num_threads = num_threads;
+    shared_settings.pin_threads = pin_threads;
+    shared_settings.configured = true;
+    return true;
+}
+
+void ThreadPool::run(size_t n, size_t grain, ChunkFn fn_, void* arg_)
+{
+    grain = std::max<size_t>(grain, 1);
+    std::unique_lock<std::mutex> running(run_mutex, std::try_to_lock);
+    if (!running.owns_lock() || workers.empty() || n <= grain)
+    {
+        fn_(arg_, 0, n);
+        return;
+    }
+
+    // Chunk indices must fit the 32 bit halves of a slot.
+    const size_t max_chunks = std::numeric_limits<uint32_t>::max();
+    if ((n - 1) / grain + 1 > max_chunks)
+    {
+        grain = (n - 1) / max_chunks + 1;
+    }
+    const size_t chunks = (n - 1) / grain + 1;
+    const size_t participants = size();
+
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        fn = fn_;
+        arg = arg_;
+        total = n;
+        chunk = grain;
+        for (size_t i = 0; i < participants; ++i)
+        {
+            uint32_t front = static_cast<uint32_t>(chunks * i / participants);
+            uint32_t back = static_cast<uint32_t>(chunks * (i + 1) / participants);
+            slots[i].range.store(packRange(front, back), std::memory_order_relaxed);
+        }
+        busy = static_cast<unsigned int>(workers.size());
+        ++generation;
+    }
+    wake.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(state_mutex);
+    done.wait(lock, [this] { return busy == 0; });
+}
+
+bool ThreadPool::takeFront(unsigned int self, uint32_t& chunk_index)
+{
+    std::atomic<uint64_t>& range = slots[self].range;
+    uint64_t current = range.load(std::memory_order_acquire);
+    for (;;)
+    {
+        uint32_t front = rangeFront(current);
+        uint32_t back = rangeBack(current);
+        if (front >= back)
+        {
+            return false;
+        }
+        if (range.compare_exchange_weak(current, packRange(front + 1, back), std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            chunk_index = front;
+            return true;
+        }
+    }
+}
+
+bool ThreadPool::steal(unsigned int self, uint32_t& chunk_index)
+{
+    // A slot only ever holds chunks nobody has taken, and a taken chunk is
+    // never given back, so a range seen twice is the same range: no ABA.
+    const unsigned int participants = size();
+    for (unsigned int offset = 1; offset < participants; ++offset)
+    {
+        std::atomic<uint64_t>& victim = slots[(self + offset) % participants].range;
+        uint64_t current = victim.load(std::memory_order_acquire);
+        for (;;)
+        {
+            uint32_t front = rangeFront(current);
+            uint32_t back = rangeBack(current);
+            if (front >= back)
+            {
+                break;
+            }
+            uint32_t middle = front + (back - front) / 2;
+            if (victim.compare_exchange_weak(current, packRange(front, middle), std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                // Own slot is empty, nobody else writes to it until it is refilled here.
+                chunk_index = middle;
+                slots[self].range.store(packRange(middle + 1, back), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work(unsigned int self)
+{
+    uint32_t chunk_index;
+    while (takeFront(self, chunk_index) || steal(self, chunk_index))
+    {
+        size_t begin = static_cast<size_t>(chunk_index) * chunk;
+        fn(arg, begin, std::min(begin + chunk, total));
+    }
+}
+
+void ThreadPool::workerLoop(unsigned int self)
+{
+    unsigned long seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping)
+            {
+                return;
+            }
+            seen = generation;
+        }
+
+        work(self);
+
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (--busy == 0)
+        {
+            done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,170 @@
+/**
+ * @file ThreadPool.h
+ * @brief Fixed set of worker threads running data parallel loops.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef THREADPOOL_H__
+#define THREADPOOL_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Worker threads that split the iterations of a loop between them by work stealing.
+ *
+ * parallelFor cuts the index range into chunks of grain iterations and deals
+ * them out evenly: every thread, the calling one included, gets a contiguous
+ * range of chunks in a slot of its own. A thread takes chunks from the front
+ * of its range; once it is empty it steals the back half of the range of
+ * another thread and carries on with that. Threads mostly touch their own
+ * slot, so uneven chunks balance out without a shared counter being hit for
+ * every chunk. The call returns once every chunk is done. Nothing is
+ * allocated per call, so it can be used on the predict path.
+ *
+ * One loop runs at a time. A call made while another loop is running, for
+ * example from inside a loop body, runs on the calling thread alone.
+ *
+ * Workers can be pinned to the CPUs the process may run on, one each in
+ * order. Scratch memory of a worker, such as its PredictContext, is thread
+ * local and first touched by the worker itself, so with pinning it is
+ * allocated on the NUMA node of the worker's CPU.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @brief Start the workers.
+     *
+     * @param num_threads Threads working on a loop including the caller, 0 for one per core.
+     * @param pin_threads Pin every worker to a CPU of its own.
+     */
+    explicit ThreadPool(unsigned int num_threads = 0, bool pin_threads = false);
+
+    /**
+     * @brief Stop and join the workers.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Pool shared by the whole library, started on first use.
+     *
+     * Its size and pinning come from configureShared or, failing that, from
+     * the environment variables TEXTCLASSIFIER_THREADS (number of threads)
+     * and TEXTCLASSIFIER_PIN_THREADS (1 to pin). By default it has one
+     * thread per core and does not pin.
+     *
+     * @return Process wide pool.
+     */
+    static ThreadPool& shared();
+
+    /**
+     * @brief Set the size and pinning of the shared pool.
+     *
+     * @param num_threads Threads working on a loop including the caller, 0 for one per core.
+     * @param pin_threads Pin every worker to a CPU of its own.
+     * @return False if the shared pool is already running, nothing changes then.
+     */
+    static bool configureShared(unsigned int num_threads, bool pin_threads);
+
+    /**
+     * @brief Number of threads working on a loop, including the caller.
+     *
+     * @return Worker count plus one.
+     */
+    unsigned int size() const { return static_cast<unsigned int>(workers.size()) + 1; }
+
+    /**
+     * @brief Run body(begin, end) over [0, n) in chunks of grain iterations.
+     *
+     * The body must not throw.
+     *
+     * @param n Number of iterations.
+     * @param grain Iterations per chunk.
+     * @param body Callable taking the bounds of a chunk.
+     */
+    template <typename Body>
+    void parallelFor(size_t n, size_t grain, const Body& body)
+    {
+        auto call = [](void* arg, size_t begin, size_t end)
+        {
+            (*static_cast<const Body*>(arg))(begin, end);
+        };
+        run(n, grain, call, const_cast<Body*>(&body));
+    }
+
+private:
+    typedef void (*ChunkFn)(void*, size_t, size_t);
+
+    /**
+     * @struct Slot
+     * @brief Chunks left to a thread, [front, back) packed into one word so both ends move atomically.
+     */
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> range{0}; /**< front in the low 32 bits, back in the high 32 bits. */
+    };
+
+    std::vector<std::thread> workers;   /**< Worker threads. */
+    std::unique_ptr<Slot[]> slots;      /**< One per thread, the caller's first. */
+    std::mutex run_mutex;               /**< Held by the thread running a loop. */
+    std::mutex state_mutex;             /**< Guards the fields below. */
+    std::condition_variable wake;       /**< Signals a new loop or shutdown to the workers. */
+    std::condition_variable done;       /**< Signals the last worker leaving a loop. */
+    unsigned long generation;           /**< Incremented for every loop. */
+    unsigned int busy;                  /**< Workers still inside the current loop. */
+    bool stopping;                      /**< Set by the destructor. */
+
+    ChunkFn fn;                         /**< Body of the current loop. */
+    void* arg;                          /**< Argument of fn. */
+    size_t total;                       /**< Iterations of the current loop. */
+    size_t chunk;                       /**< Iterations per chunk. */
+
+    /**
+     * @brief Run a loop, see parallelFor.
+     */
+    void run(size_t n, size_t grain, ChunkFn fn_, void* arg_);
+
+    /**
+     * @brief Run chunks of the current loop until none is left anywhere.
+     *
+     * @param self Slot of the calling thread.
+     */
+    void work(unsigned int self);
+
+    /**
+     * @brief Take the first chunk of a thread's own range.
+     */
+    bool takeFront(unsigned int self, uint32_t& chunk_index);
+
+    /**
+     * @brief Move the back half of another thread's range to an empty slot and take its first chunk.
+     */
+    bool steal(unsigned int self, uint32_t& chunk_index);
+
+    /**
+     * @brief Main function of a worker thread.
+     *
+     * @param self Slot of the worker.
+     */
+    void workerLoop(unsigned int self);
+};
+
+#endif // THREADPOOL_H__
@@ -0,0 +1,253 @@
+/**
+ * @file TokenFilter.cpp
+ * @brief Implementation of the TokenFilter class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "TokenFilter.h"
+#include "FeatureHash.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+
+TokenFilter::TokenFilter()
+    : seed(0), slot_mask(0), bucket_mask(0), max_length(0)
+{
+    setStopWords({
+        "The", "the", "a", "A", "an", "An",
+        "This", "this", "That", "that", "is",
+        "Is", "my", "My", ".", ":", ",", ";", "\'", ")", "(",
+        "..."
+    });
+    setPunctuation("!?/");
+}
+
+void TokenFilter::setStopWords(const std::vector<std::string>& words_)
+{
+    words = words_;
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    compile();
+}
+
+void TokenFilter::setPunctuation(std::string_view chars)
+{
+    std::memset(punctuation, 0, sizeof(punctuation));
+    for (char c : chars)
+    {
+        unsigned char u = static_cast<unsigned char>(c);
+        punctuation[u >> 6] |= 1ULL << (u & 63);
+    }
+}
+
+bool TokenFilter::loadStopWords(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        std::cerr << "ERROR: Cannot open stop words file " << path << ".\n";
+        return false;
+    }
+
+    std::vector<std::string> list;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (!line.empty() && line[0] != '#')
+        {
+            list.push_back(line);
+        }
+    }
+    setStopWords(list);
+    return true;
+}
+
+bool TokenFilter::loadPunctuation(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        std::cerr << "ERROR: Cannot open punctuation file " << path << ".\n";
+        return false;
+    }
+
+    std::string chars;
+    char c;
+    while (in.get(c))
+    {
+        if (!std::isspace(static_cast<unsigned char>(c)))
+        {
+            chars.push_back(c);
+        }
+    }
+    setPunctuation(chars);
+    return true;
+}
+
+uint64_t TokenFilter::hashWord(std::string_view word) const
+{
+    uint64_t h = FEATUREHASH_FNV_OFFSET ^ seed;
+    for (char c : word)
+    {
+        h ^= static_cast<unsigned char>(c);
+        h *= FEATUREHASH_FNV_PRIME;
+    }
+    return mixHash(h);
+}
+
+bool TokenFilter::isStopWord(std::string_view word) const
+{
+    if (word.size() > max_length || words.empty())
+    {
+        return false;
+    }
+    uint64_t h = hashWord(word);
+    const Slot& slot = slots[slotOf(h, displacement[(h >> 40) & bucket_mask])];
+    return slot.tag == static_cast<uint32_t>(h >> 32) && slot.word >= 0 && words[slot.word] == word;
+}
+
+/**
+ * @brief Hash and displace construction.
+ *
+ * Buckets are placed largest first. For each one the smallest displacement
+ * that moves all its words to free slots is kept. With twice as many slots
+ * as words this almost always succeeds with the first seed.
+ */
+void TokenFilter::compile()
+{
+    displacement.clear();
+    slots.clear();
+    max_length = 0;
+    if (words.empty())
+    {
+        return;
+    }
+    for (const auto& w : words)
+    {
+        max_length = std::max(max_length, w.size());
+    }
+
+    size_t num_slots = 1;
+    while (num_slots < 2 * words.size())
+    {
+        num_slots <<= 1;
+    }
+    size_t num_buckets = 1;
+    while (num_buckets * TOKENFILTER_BUCKET_SIZE < words.size())
+    {
+        num_buckets <<= 1;
+    }
+    slot_mask = static_cast<uint32_t>(num_slots - 1);
+    bucket_mask = static_cast<uint32_t>(num_buckets - 1);
+
+    for (uint64_t attempt = 0; attempt < TOKENFILTER_MAX_SEEDS; ++attempt)
+    {
+        seed = mixHash(attempt + 1);
+
+        std::vector<std::vector<size_t>> buckets(num_buckets);
+        std::vector<uint64_t> hashes(words.size());
+        for (size_t i = 0; i < words.size(); ++i)
+        {
+            hashes[i] = hashWord(words[i]);
+            buckets[(hashes[i] >> 40) & bucket_mask].push_back(i);
+        }
+
+        std::vector<size_t> order(num_buckets);
+        for (size_t b = 0; b < num_buckets; ++b)
+        {
+            order[b] = b;
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+        displacement.assign(num_buckets, 0);
+        slots.assign(num_slots, Slot{ -1, 0 });
+        bool placed_all = true;
+
+        for (size_t b : order)
+        {
+            const auto& bucket = buckets[b];
+            bool placed = bucket.empty();
+            for (uint32_t d = 0; !placed && d < num_slots; ++d)
+            {
+                placed = true;
+                for (size_t k = 0; k < bucket.size() && placed; ++k)
+                {
+                    uint32_t s = slotOf(hashes[bucket[k]], d);
+                    placed = slots[s].word < 0;
+                    for (size_t j = 0; j < k && placed; ++j)
+                    {
+                        placed = slotOf(hashes[bucket[j]], d) != s;
+                    }
+                }
+                if (placed)
+                {
+                    displacement[b] = d;
+                    for (size_t i : bucket)
+                    {
+                        slots[slotOf(hashes[i], d)] = Slot{ static_cast<int32_t>(i), static_cast<uint32_t>(hashes[i] >> 32) };
+                    }
+                }
+            }
+            if (!placed)
+            {
+                placed_all = false;
+                break;
+            }
+        }
+        if (placed_all)
+        {
+            return;
+        }
+    }
+
+    // Not reachable with twice as many slots as words, keep lookups safe anyway.
+    std::cerr << "ERROR: Cannot build the stop word hash, stop words are disabled.\n";
+    words.clear();
+    displacement.clear();
+    slots.clear();
+    max_length = 0;
+}
+
+void TokenFilter::save(std::ofstream& outFile) const
+{
+    outFile.write(reinterpret_cast<const char*>(punctuation), sizeof(punctuation));
+    uint32_t count = static_cast<uint32_t>(words.size());
+    outFile.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const auto& w : words)
+    {
+        uint32_t len = static_cast<uint32_t>(w.size());
+        outFile.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        outFile.write(w.data(), len);
+    }
+}
+
+void TokenFilter::load(std::ifstream& inFile)
+{
+    inFile.read(reinterpret_cast<char*>(punctuation), sizeof(punctuation));
+    uint32_t count = 0;
+    inFile.read(reinterpret_cast<char*>(&count), sizeof(count));
+    std::vector<std::string> list;
+    for (uint32_t i = 0; i < count && inFile; ++i)
+    {
+        uint32_t len = 0;
+        inFile.read(reinterpret_cast<char*>(&len), sizeof(len));
+        std::string w(len, '\0');
+        inFile.read(&w[0], len);
+        list.push_back(w);
+    }
+    setStopWords(list);
+}
@@ -0,0 +1,166 @@
+/**
+ * @file TokenFilter.h
+ * @brief Stop word and punctuation sets compiled for one probe per lookup.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef TOKENFILTER_H__
+#define TOKENFILTER_H__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+
+#define TOKENFILTER_BUCKET_SIZE     4       /**< Average stop words per bucket of the perfect hash. */
+#define TOKENFILTER_MAX_SEEDS       64      /**< Seeds tried before giving up on a perfect hash. */
+
+/**
+ * @class TokenFilter
+ * @brief Punctuation bitmap and perfect hash set of stop words.
+ *
+ * Punctuation characters are kept in a 256-bit bitmap, so testing a byte is
+ * a shift and a mask. Stop words are compiled into a hash-and-displace
+ * perfect hash: a word's hash picks a bucket, the bucket's displacement
+ * picks the slot, and no two stop words share a slot. A lookup therefore
+ * hashes the token once and compares it with at most one stop word.
+ *
+ * Both sets can be replaced from files and are saved with the model, so
+ * prediction uses the same filter as training.
+ */
+class TokenFilter
+{
+public:
+    /**
+     * @brief Constructor with the built-in stop words and punctuation.
+     */
+    TokenFilter();
+
+    /**
+     * @brief Replace the stop words.
+     *
+     * Words are matched against tokens after normalisation, so a case
+     * insensitive vectorizer needs them in lower case.
+     *
+     * @param words New stop words, duplicates are ignored.
+     */
+    void setStopWords(const std::vector<std::string>& words);
+
+    /**
+     * @brief Replace the punctuation characters.
+     *
+     * @param chars Every byte of the string becomes a punctuation character.
+     */
+    void setPunctuation(std::string_view chars);
+
+    /**
+     * @brief Read the stop words from a file, one word per line.
+     *
+     * Empty lines and lines starting with '#' are skipped.
+     *
+     * @param path Path to the file.
+     * @return False if the file cannot be read, the stop words are then unchanged.
+     */
+    bool loadStopWords(const std::string& path);
+
+    /**
+     * @brief Read the punctuation characters from a file.
+     *
+     * Every byte of the file other than white space is a punctuation character.
+     *
+     * @param path Path to the file.
+     * @return False if the file cannot be read, the punctuation is then unchanged.
+     */
+    bool loadPunctuation(const std::string& path);
+
+    /**
+     * @brief Whether a byte is a punctuation character.
+     *
+     * @param c Byte to test.
+     * @return True if c is in the punctuation set.
+     */
+    bool isPunctuation(char c) const
+    {
+        unsigned char u = static_cast<unsigned char>(c);
+        return (punctuation[u >> 6] >> (u & 63)) & 1;
+    }
+
+    /**
+     * @brief Whether a token is a stop word.
+     *
+     * @param word Token to test.
+     * @return True if word is in the stop word set.
+     */
+    bool isStopWord(std::string_view word) const;
+
+    /**
+     * @brief Number of stop words.
+     *
+     * @return Size of the stop word set.
+     */
+    size_t stopWordCount() const { return words.size(); }
+
+    /**
+     * @brief Write both sets to a model file.
+     *
+     * @param outFile Output file stream.
+     */
+    void save(std::ofstream& outFile) const;
+
+    /**
+     * @brief Read both sets written by save and recompile the perfect hash.
+     *
+     * @param inFile Input file stream.
+     */
+    void load(std::ifstream& inFile);
+
+private:
+    std::vector<std::string> words;     /**< Stop words, sorted and unique. */
+    uint64_t punctuation[4];            /**< Bit c is set for every punctuation byte c. */
+
+    /**
+     * @brief Slot of the perfect hash.
+     */
+    struct Slot
+    {
+        int32_t word;                   /**< Index into words, -1 for an empty slot. */
+        uint32_t tag;                   /**< High bits of the word's hash, rejects most misses. */
+    };
+
+    uint64_t seed;                      /**< Seed of the perfect hash. */
+    uint32_t slot_mask;                 /**< Number of slots minus one, a power of two. */
+    uint32_t bucket_mask;               /**< Number of buckets minus one, a power of two. */
+    size_t max_length;                  /**< Longest stop word, longer tokens skip the probe. */
+    std::vector<uint32_t> displacement; /**< Displacement of every bucket. */
+    std::vector<Slot> slots;            /**< Slots of the perfect hash. */
+
+    /**
+     * @brief Build the perfect hash of words.
+     */
+    void compile();
+
+    /**
+     * @brief Slot of a word hash in a bucket with displacement d.
+     */
+    uint32_t slotOf(uint64_t h, uint32_t d) const
+    {
+        uint32_t f1 = static_cast<uint32_t>(h);
+        uint32_t f2 = static_cast<uint32_t>(h >> 20) | 1u;
+        return (f1 + d * f2) & slot_mask;
+    }
+
+    /**
+     * @brief Seeded hash of a word.
+     */
+    uint64_t hashWord(std::string_view word) const;
+};
+
+#endif // TOKENFILTER_H__
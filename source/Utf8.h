@@ -0,0 +1,115 @@
+/**
+ * @file Utf8.h
+ * @brief UTF-8 decoding, encoding and simple case folding.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef UTF8_H__
+#define UTF8_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#define UTF8_ACCEPT     0       /**< Decoder state after a complete code point. */
+#define UTF8_REJECT     12      /**< Decoder state after an invalid byte. */
+
+/**
+ * @class Utf8
+ * @brief Helpers to work on UTF-8 text without leaving the byte buffer.
+ *
+ * Decoding uses the DFA of Bjoern Hoehrmann: every byte is mapped to one of
+ * 12 classes and a 108 entry transition table gives the next state, so
+ * validation and decoding need one table lookup and no branches per byte.
+ * Overlong forms, surrogates and code points above U+10FFFF are rejected.
+ */
+class Utf8
+{
+public:
+    /**
+     * @brief Feed one byte to the decoder.
+     *
+     * Start with state UTF8_ACCEPT. When the returned state is UTF8_ACCEPT
+     * again, codep holds a complete code point; UTF8_REJECT means the
+     * sequence is invalid.
+     *
+     * @param state Decoder state, updated.
+     * @param codep Code point being assembled, updated.
+     * @param byte Next byte of the input.
+     * @return New state.
+     */
+    static uint32_t decode(uint32_t& state, uint32_t& codep, uint8_t byte)
+    {
+        uint32_t type = DFA[byte];
+        codep = (state != UTF8_ACCEPT) ? (byte & 0x3fu) | (codep << 6) : (0xffu >> type) & byte;
+        state = DFA[256 + state + type];
+        return state;
+    }
+
+    /**
+     * @brief Number of bytes needed to encode a code point.
+     *
+     * @param cp Code point.
+     * @return 1 to 4.
+     */
+    static size_t encodedLength(uint32_t cp)
+    {
+        return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+    }
+
+    /**
+     * @brief Write a code point as UTF-8.
+     *
+     * @param cp Code point, at most U+10FFFF.
+     * @param out Receives encodedLength(cp) bytes.
+     * @return Number of bytes written.
+     */
+    static size_t encode(uint32_t cp, char* out);
+
+    /**
+     * @brief Simple case folding of one code point (CaseFolding.txt, status C and S).
+     *
+     * @param cp Code point.
+     * @return Folded code point, cp itself if it has no folding.
+     */
+    static uint32_t foldCase(uint32_t cp);
+
+    /**
+     * @brief Whether a code point is Unicode white space.
+     *
+     * @param cp Code point.
+     * @return True for the White_Space property.
+     */
+    static bool isSpace(uint32_t cp);
+
+    /**
+     * @brief Normalise UTF-8 text in place for tokenisation.
+     *
+     * Every code point is case folded. With preprocess, white space and
+     * bytes that do not form valid UTF-8 become spaces and ASCII control
+     * characters are blanked as in SimdKernels::normalizeAscii; without it
+     * invalid bytes are kept as they are. Runs of ASCII go through the SIMD
+     * kernels, so ASCII text is as fast as before.
+     *
+     * Folding can shorten a code point (K, U+212A, becomes k), so the text
+     * may shrink. U+023A and U+023E keep their case because their lower case
+     * forms need one more byte.
+     *
+     * @param text Text to normalise.
+     * @param len Length of the text in bytes.
+     * @param preprocess Also blank out invalid bytes, white space and control characters.
+     * @return New length of the text.
+     */
+    static size_t normalize(char* text, size_t len, bool preprocess);
+
+private:
+    static const uint8_t DFA[256 + 108];  /**< Byte classes followed by the transition table. */
+};
+
+#endif // UTF8_H__
@@ -0,0 +1,189 @@
+/**
+ * @file VocabularyFilter.cpp
+ * @brief Implementation of the VocabularyFilter class.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#include "VocabularyFilter.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "FeatureHash.h"
+
+VocabularyFilter::VocabularyFilter()
+    : sketch_mask(0), summary_capacity(0), min_count(0), num_documents(0)
+{
+}
+
+void VocabularyFilter::reset(bool use_sketch, int max_features)
+{
+    release();
+    if (use_sketch)
+    {
+        sketch.assign(static_cast<size_t>(VOCABULARYFILTER_SKETCH_DEPTH) << VOCABULARYFILTER_SKETCH_BITS, 0);
+        sketch_mask = (static_cast<size_t>(1) << VOCABULARYFILTER_SKETCH_BITS) - 1;
+    }
+    if (max_features > 0)
+    {
+        summary_capacity = std::max<size_t>(static_cast<size_t>(max_features) * VOCABULARYFILTER_SUMMARY_FACTOR,
+                                            VOCABULARYFILTER_SUMMARY_MIN);
+        summary.reserve(summary_capacity);
+        summary_pos.reserve(summary_capacity);
+    }
+}
+
+void VocabularyFilter::addDocument(const uint64_t* hashes, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!sketch.empty())
+        {
+            addToSketch(hashes[i]);
+        }
+        if (summary_capacity > 0)
+        {
+            addToSummary(hashes[i]);
+        }
+    }
+    num_documents++;
+}
+
+bool VocabularyFilter::admits(uint64_t hash) const
+{
+    if (!sketch.empty() && estimate(hash) < min_count)
+    {
+        return false;
+    }
+    if (summary_capacity > 0 && !summary_pos.count(hash))
+    {
+        return false;
+    }
+    return true;
+}
+
+void VocabularyFilter::release()
+{
+    std::vector<uint16_t>().swap(sketch);
+    std::vector<Counter>().swap(summary);
+    std::unordered_map<uint64_t, size_t>().swap(summary_pos);
+    sketch_mask = 0;
+    summary_capacity = 0;
+    min_count = 0;
+    num_documents = 0;
+}
+
+size_t VocabularyFilter::sketchIndex(uint64_t hash, int row) const
+{
+    // One independent hash per row, derived from the feature hash.
+    uint64_t h = mixHash(hash + static_cast<uint64_t>(row + 1) * FEATUREHASH_ROLL_TOKEN);
+    return (static_cast<size_t>(row) << VOCABULARYFILTER_SKETCH_BITS) + (h & sketch_mask);
+}
+
+uint32_t VocabularyFilter::estimate(uint64_t hash) const
+{
+    uint32_t lowest = std::numeric_limits<uint16_t>::max();
+    for (int row = 0; row < VOCABULARYFILTER_SKETCH_DEPTH; ++row)
+    {
+        lowest = std::min<uint32_t>(lowest, sketch[sketchIndex(hash, row)]);
+    }
+    return lowest;
+}
+
+void VocabularyFilter::addToSketch(uint64_t hash)
+{
+    // Conservative update: the estimate is the smallest counter, so only
+    // counters at that value need to grow. Counters saturate instead of wrapping.
+    uint32_t lowest = estimate(hash);
+    if (lowest == std::numeric_limits<uint16_t>::max())
+    {
+        return;
+    }
+    for (int row = 0; row < VOCABULARYFILTER_SKETCH_DEPTH; ++row)
+    {
+        uint16_t& counter = sketch[sketchIndex(hash, row)];
+        if (counter == lowest)
+        {
+            counter++;
+        }
+    }
+}
+
+void VocabularyFilter::addToSummary(uint64_t hash)
+{
+    auto it = summary_pos.find(hash);
+    if (it != summary_pos.end())
+    {
+        summary[it->second].count++;
+        siftDown(it->second);
+        return;
+    }
+
+    if (summary.size() < summary_capacity)
+    {
+        summary.push_back({ hash, 1 });
+        summary_pos[hash] = summary.size() - 1;
+        siftUp(summary.size() - 1);
+        return;
+    }
+
+    // The newcomer takes over the least frequent candidate and its count,
+    // which keeps every count an upper bound of the true frequency.
+    summary_pos.erase(summary[0].hash);
+    summary[0].hash = hash;
+    summary[0].count++;
+    summary_pos[hash] = 0;
+    siftDown(0);
+}
+
+void VocabularyFilter::siftDown(size_t pos)
+{
+    for (;;)
+    {
+        size_t smallest = pos;
+        size_t left = 2 * pos + 1;
+        size_t right = left + 1;
+        if (left < summary.size() && summary[left].count < summary[smallest].count)
+        {
+            smallest = left;
+        }
+        if (right < summary.size() && summary[right].count < summary[smallest].count)
+        {
+            smallest = right;
+        }
+        if (smallest == pos)
+        {
+            return;
+        }
+        swapCounters(pos, smallest);
+        pos = smallest;
+    }
+}
+
+void VocabularyFilter::siftUp(size_t pos)
+{
+    while (pos > 0)
+    {
+        size_t parent = (pos - 1) / 2;
+        if (summary[parent].count <= summary[pos].count)
+        {
+            return;
+        }
+        swapCounters(pos, parent);
+        pos = parent;
+    }
+}
+
+void VocabularyFilter::swapCounters(size_t a, size_t b)
+{
+    std::swap(summary[a], summary[b]);
+    summary_pos[summary[a].hash] = a;
+    summary_pos[summary[b].hash] = b;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file VocabularyFilter.h
+ * @brief Streaming document frequency counts that decide which features enter a vocabulary.
+ */
+
+/*++
+
+Revision History:
+	Date:	Oct 19, 2026.
+	Desc:	Created.
+
+--*/
+
+#ifndef VOCABULARYFILTER_H__
+#define VOCABULARYFILTER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#define VOCABULARYFILTER_SKETCH_DEPTH       4       /**< Rows of the count-min sketch. */
+#define VOCABULARYFILTER_SKETCH_BITS        20      /**< Each row has 2^bits counters. */
+#define VOCABULARYFILTER_SUMMARY_FACTOR     4       /**< Space-saving keeps this many candidates per max_features. */
+#define VOCABULARYFILTER_SUMMARY_MIN        65536   /**< Space-saving keeps at least this many candidates. */
+
+/**
+ * @class VocabularyFilter
+ * @brief Decides during fit which features are frequent enough to get a vocabulary entry.
+ *
+ * Every document is counted once as it is read, by the hashes of its
+ * distinct features, in two bounded structures:
+ *
+ * - a count-min sketch with conservative update for min_df. Its estimate
+ *   never falls below the true document frequency, so a feature that
+ *   reaches min_df is admitted from its first document on. Rare features,
+ *   usually most of a corpus, never get an entry at all;
+ * - a space-saving summary for max_features, which keeps the features
+ *   with the highest document frequencies, max_features *
+ *   VOCABULARYFILTER_SUMMARY_FACTOR of them but at least
+ *   VOCABULARYFILTER_SUMMARY_MIN. Its counts overestimate by at most
+ *   T / capacity, where T is the number of distinct features summed over
+ *   all documents, and any feature with a larger document frequency is
+ *   guaranteed to be in it. A corpus with fewer distinct features than
+ *   the capacity is counted exactly.
+ *
+ * Both may admit a few features too many. The vectorizer checks the exact
+ * document frequencies of the admitted features once its sentences are built
+ * and drops the rest, see BaseVectorizer::applyVocabularyLimits.
+ */
+class VocabularyFilter
+{
+public:
+    VocabularyFilter();
+
+    /**
+     * @brief Start counting a new corpus.
+     *
+     * @param use_sketch Count document frequencies for a min_df limit.
+     * @param max_features Number of features to keep candidates for, 0 for no limit.
+     */
+    void reset(bool use_sketch, int max_features);
+
+    /**
+     * @brief Whether any limit is being counted.
+     */
+    bool active() const { return !sketch.empty() || summary_capacity > 0; }
+
+    /**
+     * @brief Count one document.
+     *
+     * @param hashes Hashes of the distinct features of the document.
+     * @param n Number of hashes.
+     */
+    void addDocument(const uint64_t* hashes, size_t n);
+
+    /**
+     * @brief Set the document frequency a feature needs, once every document is counted.
+     *
+     * @param min_count_ Smallest document frequency admitted.
+     */
+    void finish(uint32_t min_count_) { min_count = min_count_; }
+
+    /**
+     * @brief Whether a feature may get a vocabulary entry.
+     *
+     * @param hash Feature hash.
+     * @return True if it passes every counted limit, always true when inactive.
+     */
+    bool admits(uint64_t hash) const;
+
+    /**
+     * @brief Number of documents counted since reset.
+     */
+    size_t documents() const { return num_documents; }
+
+    /**
+     * @brief Free the counters, the filter admits everything afterwards.
+     */
+    void release();
+
+private:
+    /**
+     * @struct Counter
+     * @brief Entry of the space-saving summary.
+     */
+    struct Counter
+    {
+        uint64_t hash;      /**< Feature hash. */
+        uint32_t count;     /**< Estimated document frequency, an upper bound. */
+    };
+
+    std::vector<uint16_t> sketch; /**< VOCABULARYFILTER_SKETCH_DEPTH rows of saturating counters. */
+    size_t sketch_mask; /**< Counters per row minus one. */
+    std::vector<Counter> summary; /**< Min-heap of candidates by count. */
+    std::unordered_map<uint64_t, size_t> summary_pos; /**< Heap position of every candidate. */
+    size_t summary_capacity; /**< Maximum number of candidates, 0 when unused. */
+    uint32_t min_count; /**< Document frequency needed to pass the sketch. */
+    size_t num_documents; /**< Documents counted. */
+
+    /**
+     * @brief Counter of a hash in a row of the sketch.
+     */
+    size_t sketchIndex(uint64_t hash, int row) const;
+
+    /**
+     * @brief Smallest counter of a hash over all rows.
+     */
+    uint32_t estimate(uint64_t hash) const;
+
+    /**
+     * @brief Add one document to the sketch, raising only the smallest counters.
+     */
+    void addToSketch(uint64_t hash);
+
+    /**
+     * @brief Add one document to the space-saving summary.
+     */
+    void addToSummary(uint64_t hash);
+
+    /**
+     * @brief Restore the heap order below a position after its count grew.
+     */
+    void siftDown(size_t pos);
+
+    /**
+     * @brief Restore the heap order above a newly added position.
+     */
+    void siftUp(size_t pos);
+
+    /**
+     * @brief Swap two heap positions and update their index entries.
+     */
+    void swapCounters(size_t a, size_t b);
+};
+
+#endif // VOCABULARYFILTER_H__